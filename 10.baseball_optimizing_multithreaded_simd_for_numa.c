@@ -142,6 +142,8 @@
 #include <stdio.h>      // printf
 #include <stdlib.h>     // atoi
 #include <string.h>     // strcmp
+#include <stdint.h>     // uintptr_t
+#include <ctype.h>      // isdigit
 #include <pthread.h>    // threads
 #include <immintrin.h>  // SIMD intrinsics (AVX)
 #include <numa.h>       // NUMA node management
@@ -162,12 +164,23 @@ typedef struct {
 
 // Ensure thread runs on a specific NUMA node
 // NUMA Binding Function (bindThreadToNUMANode)
-// Binds a thread to a specific CPU (NUMA node) to optimize memory locality and reduce memory access latency.
+// Binds a thread to the CPUs of a NUMA node to optimize memory locality and reduce memory access latency.
 void bindThreadToNUMANode(int node) {
+    struct bitmask *nodeCpus = numa_allocate_cpumask();
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
-    CPU_SET(node, &cpuset);
-    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+
+    // CPUs that belong to the node (CPU number != node number)
+    if (numa_node_to_cpus(node, nodeCpus) == 0) {
+        for (unsigned cpu = 0; cpu < nodeCpus->size && cpu < CPU_SETSIZE; cpu++) {
+            if (numa_bitmask_isbitset(nodeCpus, cpu)) CPU_SET(cpu, &cpuset);
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+
+    if (CPU_COUNT(&cpuset) > 0) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
 }
 
 
@@ -180,19 +193,25 @@ void *numaSimdSum(void *arg) {
     bindThreadToNUMANode(data->numa_node); // Bind thread to NUMA node
 
     __m256i sumVec = _mm256_setzero_si256(); // Initialize AVX register to zero
-    int i;
+    int i = data->start;
+    int peel = 0;
+
+    // Peel to a 32-byte boundary: the aligned loads below are only valid there
+    for (; i < data->end && ((uintptr_t)&data->records[i] & 31) != 0; i++) {
+        peel += data->records[i];
+    }
 
     // SIMD loop (process 8 integers per iteration using AVX)
-    for (i = data->start; i + 7 < data->end; i += 8) {
+    for (; i + 7 < data->end; i += 8) {
         __m256i values = _mm256_load_si256((__m256i*)&data->records[i]); // Aligned load (fast)
         sumVec = _mm256_add_epi32(sumVec, values);  // Vectorized addition
     }
 
-    int sumArray[8];
+    int sumArray[8] __attribute__((aligned(32)));
     _mm256_store_si256((__m256i*)sumArray, sumVec); // Store SIMD register result into array
 
     // Reduce vector sum to single integer sum
-    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+    int sum = peel + sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
               sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
 
     // Sum remaining elements (if count not divisible by 8)
@@ -212,9 +231,19 @@ int calPoints(char *ops[], int size) {
     static int records[MAX_OPERATIONS]; // Scores storage
     int index = 0;
 
-    // Simplified: Directly convert all ops to integers (assuming ops are numeric for simplification)
+    // Process every operation ("C", "D" and "+" included) exactly like 1.baseball_game.c
     for (int i = 0; i < size; i++) {
-        records[index++] = atoi(ops[i]);
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
     }
 
     pthread_t threads[NUM_THREADS];
@@ -226,7 +255,7 @@ int calPoints(char *ops[], int size) {
         data[i].records = records;
         data[i].start = i * mid;
         data[i].end = (i == NUM_THREADS - 1) ? index : (i + 1) * mid;
-        data[i].numa_node = i; // Assign thread to NUMA node i
+        data[i].numa_node = i % numa_num_configured_nodes(); // Assign thread to an existing NUMA node
         pthread_create(&threads[i], NULL, numaSimdSum, &data[i]);
     }
 
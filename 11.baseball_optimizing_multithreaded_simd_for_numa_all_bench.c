@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <ctype.h>
 #include <pthread.h>
 #include <immintrin.h>
 #include <numa.h>
@@ -22,10 +24,21 @@ typedef struct {
 
 // Bind thread to specific NUMA node
 void bindThreadToNUMANode(int node) {
+    struct bitmask *nodeCpus = numa_allocate_cpumask();
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
-    CPU_SET(node, &cpuset);
-    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+
+    // CPUs that belong to the node (CPU number != node number)
+    if (numa_node_to_cpus(node, nodeCpus) == 0) {
+        for (unsigned cpu = 0; cpu < nodeCpus->size && cpu < CPU_SETSIZE; cpu++) {
+            if (numa_bitmask_isbitset(nodeCpus, cpu)) CPU_SET(cpu, &cpuset);
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+
+    if (CPU_COUNT(&cpuset) > 0) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
 }
 
 // SIMD optimized sum function for NUMA nodes
@@ -34,17 +47,23 @@ void *numaSimdSum(void *arg) {
     bindThreadToNUMANode(data->numa_node);
 
     __m256i sumVec = _mm256_setzero_si256();
-    int i;
+    int i = data->start;
+    int peel = 0;
 
-    for (i = data->start; i + 7 < data->end; i += 8) {
+    // Peel to a 32-byte boundary: the aligned loads below are only valid there
+    for (; i < data->end && ((uintptr_t)&data->records[i] & 31) != 0; i++) {
+        peel += data->records[i];
+    }
+
+    for (; i + 7 < data->end; i += 8) {
         __m256i values = _mm256_load_si256((__m256i*)&data->records[i]);
         sumVec = _mm256_add_epi32(sumVec, values);
     }
 
-    int sumArray[8];
+    int sumArray[8] __attribute__((aligned(32)));
     _mm256_store_si256((__m256i*)sumArray, sumVec);
 
-    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+    int sum = peel + sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
               sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
 
     for (; i < data->end; i++) {
@@ -61,7 +80,17 @@ int calPoints(char *ops[], int size) {
     int index = 0;
 
     for (int i = 0; i < size; i++) {
-        records[index++] = atoi(ops[i]);
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
     }
 
     pthread_t threads[NUM_THREADS];
@@ -74,7 +103,7 @@ int calPoints(char *ops[], int size) {
         data[i].records = records;
         data[i].start = i * mid;
         data[i].end = (i == NUM_THREADS - 1) ? index : (i + 1) * mid;
-        data[i].numa_node = i; 
+        data[i].numa_node = i % numa_num_configured_nodes();
         pthread_create(&threads[i], NULL, numaSimdSum, &data[i]);
     }
 
@@ -92,12 +121,20 @@ int calPoints(char *ops[], int size) {
 
 // Set CPU Affinity
 void setCPUAffinity(int startCPU, int endCPU) {
-    cpu_set_t cpuset;
+    // startCPU..endCPU index the CPUs this process may run on (affinity, container cpuset),
+    // not absolute CPU numbers: in a cpuset of 32-47, index 0 is CPU 32.
+    cpu_set_t allowed, cpuset;
     CPU_ZERO(&cpuset);
-    for (int i = startCPU; i <= endCPU; i++) {
-        CPU_SET(i, &cpuset);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) return;
+    int n = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        if (n >= startCPU && n <= endCPU) CPU_SET(cpu, &cpuset);
+        n++;
+    }
+    if (CPU_COUNT(&cpuset) > 0) {
+        sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
     }
-    sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
 }
 
 // Print memory usage
@@ -145,7 +182,7 @@ int main() {
     start = clock();
     int result_numa = calPoints(largeOps, MAX_OPERATIONS);
     end = clock();
-    printCPUTime("NUMA-Aware Execution (Node 0 preferred, CPUs 0-4)", start, end);
+    printCPUTime("NUMA-Aware Execution (Node 0 preferred, first 5 allowed CPUs)", start, end);
     printf("Result: %d\n", result_numa);
 
     if (result_numa != result_non_numa) {
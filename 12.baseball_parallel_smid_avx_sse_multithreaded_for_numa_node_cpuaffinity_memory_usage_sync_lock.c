@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <pthread.h>
 #include <immintrin.h>
 #include <numa.h>
@@ -14,23 +15,35 @@
 #define MAX_OPERATIONS 1000000
 #define NUM_THREADS 4
 #define SIMD_THRESHOLD 500
+#define CACHE_LINE 64
 
-pthread_mutex_t sum_mutex; // Mutex for synchronization
-
-// Data structure for thread parameters
+// Data structure for thread parameters. Each thread writes only its own partial_sum, and
+// the main thread reads it after pthread_join, so no lock is needed. One cache line per
+// thread keeps those writes from invalidating a neighbour's line (false sharing).
 typedef struct {
     int *records;
     int start, end;
     int partial_sum;
     int numa_node;
-} ThreadData;
+} __attribute__((aligned(CACHE_LINE))) ThreadData;
 
 // Bind thread to specific NUMA node
 void bindThreadToNUMANode(int node) {
+    struct bitmask *nodeCpus = numa_allocate_cpumask();
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
-    CPU_SET(node, &cpuset);
-    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+
+    // CPUs that belong to the node (CPU number != node number)
+    if (numa_node_to_cpus(node, nodeCpus) == 0) {
+        for (unsigned cpu = 0; cpu < nodeCpus->size && cpu < CPU_SETSIZE; cpu++) {
+            if (numa_bitmask_isbitset(nodeCpus, cpu)) CPU_SET(cpu, &cpuset);
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+
+    if (CPU_COUNT(&cpuset) > 0) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
 }
 
 // SIMD optimized sum for NUMA nodes
@@ -52,9 +65,7 @@ void *numaSimdSum(void *arg) {
     for (int k = 0; k < 8; k++) sum += sumArray[k];
     for (; i < data->end; i++) sum += data->records[i];
 
-    pthread_mutex_lock(&sum_mutex);
     data->partial_sum = sum;
-    pthread_mutex_unlock(&sum_mutex);
 
     pthread_exit(NULL);
 }
@@ -64,7 +75,17 @@ int calPoints(char *ops[], int size, int useMultithreading) {
     static int records[MAX_OPERATIONS];
     int index = 0;
     for (int i = 0; i < size; i++) {
-        records[index++] = atoi(ops[i]);
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
     }
 
     clock_t sync_start, sync_end;
@@ -83,8 +104,6 @@ int calPoints(char *ops[], int size, int useMultithreading) {
     ThreadData data[NUM_THREADS];
     int chunk = index / NUM_THREADS;
 
-    pthread_mutex_init(&sum_mutex, NULL);
-
     sync_start = clock();
 
     for (int i = 0; i < NUM_THREADS; i++) {
@@ -102,7 +121,6 @@ int calPoints(char *ops[], int size, int useMultithreading) {
     }
 
     sync_end = clock();
-    pthread_mutex_destroy(&sum_mutex);
 
     printf("Thread synchronization overhead (multi-threaded): %.3f ms\n", 
            ((double)(sync_end - sync_start) * 1000 / CLOCKS_PER_SEC));
@@ -112,12 +130,20 @@ int calPoints(char *ops[], int size, int useMultithreading) {
 
 // Set CPU Affinity explicitly
 void setCPUAffinity(int startCPU, int endCPU) {
-    cpu_set_t cpuset;
+    // startCPU..endCPU index the CPUs this process may run on (affinity, container cpuset),
+    // not absolute CPU numbers: in a cpuset of 32-47, index 0 is CPU 32.
+    cpu_set_t allowed, cpuset;
     CPU_ZERO(&cpuset);
-    for (int i = startCPU; i <= endCPU; i++) {
-        CPU_SET(i, &cpuset);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) return;
+    int n = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        if (n >= startCPU && n <= endCPU) CPU_SET(cpu, &cpuset);
+        n++;
+    }
+    if (CPU_COUNT(&cpuset) > 0) {
+        sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
     }
-    sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
 }
 
 // Utility: Memory usage reporting
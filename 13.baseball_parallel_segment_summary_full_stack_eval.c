@@ -0,0 +1,369 @@
+/*
+ * Parallel Evaluation of the Full C/D/+ Stack Machine (Per-Chunk Segment Summaries)
+
+   Why Parallelize the Evaluation?
+
+   Every multi-threaded variant so far (3 through 12) only parallelizes the final summation.
+   The loop that turns operations into records stays strictly sequential, and for 1,000,000
+   operations that parse/evaluate loop is most of the wall time. Adding threads to the sum
+   alone cannot pay off.
+
+   The difficulty is that "C", "D" and "+" read or remove the records left behind by
+   earlier operations, so a chunk of operations cannot be evaluated without knowing the
+   stack it inherits. This program removes that dependency with segment summaries.
+
+   Segment Summary of a Chunk
+   --------------------------
+   Each thread evaluates its chunk against a *symbolic* inherited stack:
+
+   - pops:  how many inherited records the chunk removes with "C" once its own records run out.
+   - need:  how deep the inherited stack must be for the summary to be exact
+            (e.g. "D" on an empty chunk-local stack needs at least one inherited record).
+   - pushes: the records that survive at the end of the chunk. Each one is linear in the
+            two inherited records that sit on top after the pops (x1 = top, x2 = below top):
+
+                 value = c + a * x1 + b * x2
+
+   Why only x1 and x2? A chunk can only pop deeper into the inherited stack while its own
+   local stack is empty, and doing so discards everything it pushed before. So every
+   surviving record was created at the final pop depth, where "D" can only see x1 and
+   "+" can only see x1 and x2.
+
+   Combining the Summaries
+   -----------------------
+   1. Summarize (parallel):  each thread parses and symbolically evaluates its chunk.
+   2. Prefix pass (main):    walk the NUM_THREADS summaries in order, computing the stack
+                             depth before every chunk and resolving its concrete x1/x2 from
+                             the earlier chunks. If the real inherited stack is shallower than
+                             `need` (only possible near an empty stack) that chunk is replayed
+                             concretely; the replay is bounded by the chunk length.
+   3. Reduce (parallel):     each thread sums the survivors of its chunk that are not removed
+                             by later chunks: sum(c) + x1 * sum(a) + x2 * sum(b).
+
+   All arithmetic on records uses unsigned int so it wraps exactly like the int records of
+   1.baseball_game.c, which makes the result identical to the reference evaluator.
+
+   Input Explained
+   ---------------
+   - The seven test cases from 2.baseball_game_direct_update_sum_store_converted_values.c.
+   - 1,000,000 operations: "10", "D" repeated 500,000 times (expected 15,000,000).
+   - 1,000,000 random operations (numbers, "C", "D", "+") cross-checked against the
+     sequential reference.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Sequential Evaluation: [time_ms] ms, Result: 15000000
+   Parallel Segment Evaluation: [time_ms] ms, Result: 15000000
+   Random ops cross-check: OK
+
+   gcc -pthread -O3 13.baseball_parallel_segment_summary_full_stack_eval.c -o baseball_segment_eval
+*/
+
+#include <stdio.h>      // printf()
+#include <stdlib.h>     // atoi(), malloc(), free()
+#include <string.h>     // strcmp()
+#include <ctype.h>      // isdigit()
+#include <pthread.h>    // pthreads for parallel evaluation
+#include <time.h>       // clock_gettime() for wall-clock timing
+
+#define MAX_OPERATIONS 1000000  // 1 million operations supported
+#define NUM_THREADS 4           // Number of chunks / worker threads
+#define PARALLEL_THRESHOLD 4096 // Below this many ops the sequential loop is faster
+
+// Segment summary of one chunk of operations, plus the state resolved for it
+// during the prefix pass.
+typedef struct {
+    char **ops;           // Operation stream
+    int start, end;       // Operations [start, end) belong to this chunk
+
+    // Filled in by summarizeChunk (phase 1)
+    int pops;             // Inherited records removed by this chunk
+    int need;             // Minimum inherited depth for which the summary is exact
+    int count;            // Records pushed by this chunk that survive its end
+    unsigned *c, *a, *b;  // Survivor i = c[i] + a[i] * x1 + b[i] * x2
+
+    // Filled in by the prefix pass (phase 2)
+    int base;             // Stack position of the first survivor
+    unsigned x1, x2;      // Inherited top and second-from-top after the pops
+    int keep;             // Survivors not removed by later chunks
+
+    // Filled in by reduceChunk (phase 3)
+    unsigned result;      // Sum of the kept survivors
+} ChunkSummary;
+
+// Reference sequential evaluator (same rules as 1.baseball_game.c).
+int calPointsSequential(char *ops[], int size) {
+    static int records[MAX_OPERATIONS];
+    int index = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0) {
+            if (index > 0) index--;
+        } else if (strcmp(ops[i], "D") == 0) {
+            if (index > 0) {
+                records[index] = (int)(2u * (unsigned)records[index - 1]);
+                index++;
+            }
+        } else if (strcmp(ops[i], "+") == 0) {
+            if (index > 1) {
+                records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+                index++;
+            }
+        }
+    }
+
+    unsigned result = 0;
+    for (int i = 0; i < index; i++) result += (unsigned)records[i];
+    return (int)result;
+}
+
+// Phase 1: symbolically evaluate one chunk against an unknown inherited stack.
+void *summarizeChunk(void *arg) {
+    ChunkSummary *s = (ChunkSummary *)arg;
+    unsigned *c = s->c, *a = s->a, *b = s->b;
+    int n = 0;         // Local (chunk-owned) records currently on the stack
+    int pops = 0;      // Inherited records removed so far
+    int need = 0;      // Inherited depth required so far
+
+    for (int i = s->start; i < s->end; i++) {
+        const char *op = s->ops[i];
+
+        if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) {
+            c[n] = (unsigned)atoi(op); a[n] = 0; b[n] = 0;
+            n++;
+        } else if (strcmp(op, "C") == 0) {
+            if (n > 0) {
+                n--;
+            } else {
+                pops++;                           // Removes an inherited record
+                if (pops > need) need = pops;     // ...which must exist
+            }
+        } else if (strcmp(op, "D") == 0) {
+            if (n > 0) {
+                c[n] = 2u * c[n - 1]; a[n] = 2u * a[n - 1]; b[n] = 2u * b[n - 1];
+            } else {
+                if (pops + 1 > need) need = pops + 1;
+                c[n] = 0; a[n] = 2; b[n] = 0;     // 2 * x1
+            }
+            n++;
+        } else if (strcmp(op, "+") == 0) {
+            if (n > 1) {
+                c[n] = c[n - 1] + c[n - 2]; a[n] = a[n - 1] + a[n - 2]; b[n] = b[n - 1] + b[n - 2];
+            } else if (n == 1) {
+                if (pops + 1 > need) need = pops + 1;
+                c[n] = c[0]; a[n] = a[0] + 1; b[n] = b[0];  // local top + x1
+            } else {
+                if (pops + 2 > need) need = pops + 2;
+                c[n] = 0; a[n] = 1; b[n] = 1;     // x1 + x2
+            }
+            n++;
+        }
+    }
+
+    s->pops = pops;
+    s->need = need;
+    s->count = n;
+    return NULL;
+}
+
+// Concrete value of stack position q, resolved from the chunks before `upto`.
+// The latest chunk whose survivors cover q owns it.
+unsigned valueAt(ChunkSummary *s, int upto, int q) {
+    for (int j = upto - 1; j >= 0; j--) {
+        if (q >= s[j].base && q < s[j].base + s[j].count) {
+            int i = q - s[j].base;
+            return s[j].c[i] + s[j].a[i] * s[j].x1 + s[j].b[i] * s[j].x2;
+        }
+    }
+    return 0; // Unreachable for q below the current depth
+}
+
+// Replays chunk k concretely on top of the real inherited stack when that stack is
+// shallower than the summary requires. Bounded by need + chunk length.
+void replayChunk(ChunkSummary *s, int k, int depth) {
+    ChunkSummary *ck = &s[k];
+    int capacity = depth + (ck->end - ck->start);
+    unsigned *stack = malloc(capacity * sizeof(unsigned));
+    int index = 0;
+
+    for (int q = 0; q < depth; q++) stack[index++] = valueAt(s, k, q);
+
+    for (int i = ck->start; i < ck->end; i++) {
+        const char *op = ck->ops[i];
+        if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) {
+            stack[index++] = (unsigned)atoi(op);
+        } else if (strcmp(op, "C") == 0) {
+            if (index > 0) index--;
+        } else if (strcmp(op, "D") == 0) {
+            if (index > 0) { stack[index] = 2u * stack[index - 1]; index++; }
+        } else if (strcmp(op, "+") == 0) {
+            if (index > 1) { stack[index] = stack[index - 1] + stack[index - 2]; index++; }
+        }
+    }
+
+    // The replayed chunk now owns the whole stack: all inherited records are
+    // "popped" and re-pushed as constants.
+    free(ck->c); free(ck->a); free(ck->b);
+    ck->c = stack;
+    ck->a = calloc(index > 0 ? index : 1, sizeof(unsigned));
+    ck->b = calloc(index > 0 ? index : 1, sizeof(unsigned));
+    ck->pops = depth;
+    ck->need = 0;
+    ck->count = index;
+    ck->x1 = ck->x2 = 0;
+}
+
+// Phase 3: sum the survivors of one chunk that remain on the final stack.
+void *reduceChunk(void *arg) {
+    ChunkSummary *s = (ChunkSummary *)arg;
+    unsigned sumC = 0, sumA = 0, sumB = 0;
+
+    for (int i = 0; i < s->keep; i++) {
+        sumC += s->c[i];
+        sumA += s->a[i];
+        sumB += s->b[i];
+    }
+
+    s->result = sumC + sumA * s->x1 + sumB * s->x2;
+    return NULL;
+}
+
+// Parallel evaluator: summarize chunks, resolve them in order, reduce survivors.
+int calPointsParallel(char *ops[], int size) {
+    pthread_t threads[NUM_THREADS];
+    ChunkSummary s[NUM_THREADS];
+    int chunk = size / NUM_THREADS;
+
+    // Phase 1: per-chunk summaries
+    for (int i = 0; i < NUM_THREADS; i++) {
+        s[i].ops = ops;
+        s[i].start = i * chunk;
+        s[i].end = (i == NUM_THREADS - 1) ? size : (i + 1) * chunk;
+        int len = s[i].end - s[i].start;
+        s[i].c = malloc(len * sizeof(unsigned));
+        s[i].a = malloc(len * sizeof(unsigned));
+        s[i].b = malloc(len * sizeof(unsigned));
+        pthread_create(&threads[i], NULL, summarizeChunk, &s[i]);
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Phase 2: prefix pass over the summaries (stack depth before each chunk,
+    // concrete x1/x2, or a bounded replay when the inherited stack is too shallow).
+    int depth = 0;
+    for (int k = 0; k < NUM_THREADS; k++) {
+        if (depth < s[k].need) {
+            replayChunk(s, k, depth);
+        } else {
+            int top = depth - s[k].pops;
+            s[k].x1 = (top >= 1) ? valueAt(s, k, top - 1) : 0;
+            s[k].x2 = (top >= 2) ? valueAt(s, k, top - 2) : 0;
+        }
+        s[k].base = depth - s[k].pops;
+        depth = s[k].base + s[k].count;
+    }
+
+    // Survivors of chunk k stay only below the final depth and below every
+    // later chunk's base.
+    int limit = depth;
+    for (int k = NUM_THREADS - 1; k >= 0; k--) {
+        int keep = limit - s[k].base;
+        if (keep < 0) keep = 0;
+        if (keep > s[k].count) keep = s[k].count;
+        s[k].keep = keep;
+        if (s[k].base < limit) limit = s[k].base;
+    }
+
+    // Phase 3: parallel reduction of the kept survivors
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, reduceChunk, &s[i]);
+    }
+
+    unsigned totalSum = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        totalSum += s[i].result;
+        free(s[i].c); free(s[i].a); free(s[i].b);
+    }
+
+    return (int)totalSum;
+}
+
+// Small inputs stay on the sequential loop; thread creation would dominate.
+int calPoints(char *ops[], int size, int useMultithreading) {
+    if (!useMultithreading || size < PARALLEL_THRESHOLD) {
+        return calPointsSequential(ops, size);
+    }
+    return calPointsParallel(ops, size);
+}
+
+// Wall-clock time in milliseconds (clock() would add up CPU time of all threads)
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+
+    // Correctness on the small test cases (forced through the parallel path)
+    char *testCases[][8] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int sizes[] = {5, 8, 1, 1, 2, 5, 6};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("Test %lu: %d\n", i + 1, calPointsParallel(testCases[i], sizes[i]));
+    }
+
+    // Generate large input: "10", "D", "10", "D", ...
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+
+    double start = nowMs();
+    int result1 = calPoints(largeOps, MAX_OPERATIONS, 0);
+    double end = nowMs();
+    printf("Sequential Evaluation: %.3f ms, Result: %d\n", end - start, result1);
+
+    start = nowMs();
+    int result2 = calPoints(largeOps, MAX_OPERATIONS, 1);
+    end = nowMs();
+    printf("Parallel Segment Evaluation: %.3f ms, Result: %d\n", end - start, result2);
+
+    if (result1 != result2) {
+        fprintf(stderr, "Mismatch between sequential and parallel results!\n");
+        return EXIT_FAILURE;
+    }
+
+    // Random ops exercise pops across chunk boundaries, D/+ on inherited
+    // records and the shallow-stack replay.
+    static char *pool[] = {"C", "D", "+", "1", "-3", "7", "12", "-40", "100"};
+    srand(42);
+    for (int round = 0; round < 20; round++) {
+        int cWeight = round % 10; // Vary how often "C" drains the stack
+        for (int i = 0; i < MAX_OPERATIONS; i++) {
+            int r = rand() % (9 + cWeight);
+            largeOps[i] = (r >= 9) ? "C" : pool[r];
+        }
+        if (calPointsParallel(largeOps, MAX_OPERATIONS) != calPointsSequential(largeOps, MAX_OPERATIONS)) {
+            fprintf(stderr, "Random ops cross-check failed in round %d!\n", round);
+            return EXIT_FAILURE;
+        }
+    }
+    printf("Random ops cross-check: OK\n");
+
+    return EXIT_SUCCESS;
+}
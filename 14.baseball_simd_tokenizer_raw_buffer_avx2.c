@@ -0,0 +1,243 @@
+/*
+ * SIMD Tokenizer: Scoring a Raw Newline/Comma-Delimited Byte Buffer (AVX2)
+
+   Why Tokenize with SIMD?
+
+   calPoints(char *ops[], int size, ...) needs an array of pointers to separate C strings,
+   so a caller first has to split its input into millions of tiny strings. Evaluation then
+   chases each pointer and runs an isdigit()/strcmp() chain per operation.
+
+   This program scores one contiguous `const char *` buffer directly:
+
+   1. 32 bytes at a time, AVX2 byte compares build bitmasks for delimiters ('\n', ',', '\r'),
+      digits, '-', 'C', 'D' and '+'.
+   2. Token starts are non-delimiter bytes that follow a delimiter:
+          starts = ~delim & ((delim << 1) | carry)
+   3. Starts are sorted into four masks with bit operations only:
+          number = starts & (digit | (minus & digit >> 1))
+          C/D/+  = starts & (byte == 'C'/'D'/'+') & (delim >> 1)   (one-character token)
+      Bit 31 of the shifted masks looks one byte into the next block.
+   4. The set bits of the combined mask are visited in order with ctz, and each token
+      feeds the existing evaluation logic (running sum as in
+      2.baseball_game_direct_update_sum_store_converted_values.c).
+
+   Tokens keep the meaning they have in 1.baseball_game.c: a token is a number if it
+   starts with a digit or with '-' followed by a digit, and "C", "D", "+" must be the
+   whole token. Anything else is ignored.
+
+   Input Explained
+   ---------------
+   - The seven test cases from file 2, written as comma-delimited buffers ("5,2,C,D,+").
+   - 1,000,000 operations as one buffer: "10\nD\n" repeated 500,000 times (2.5 MB).
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Pointer-array calPoints: [time_ms] ms, Result: 15000000
+   SIMD buffer calPoints: [time_ms] ms, Result: 15000000
+
+   gcc -mavx2 -O3 14.baseball_simd_tokenizer_raw_buffer_avx2.c -o baseball_simd_tokenizer
+*/
+
+#include <stdio.h>      // printf()
+#include <stdlib.h>     // atoi(), malloc()
+#include <string.h>     // strcmp(), memcpy()
+#include <ctype.h>      // isdigit() for the pointer-array baseline
+#include <immintrin.h>  // AVX2 intrinsics
+#include <stdint.h>     // uint32_t bitmasks
+#include <time.h>       // clock_gettime()
+
+#define MAX_OPERATIONS 1000000  // 1 million operations supported
+#define BLOCK 32                // Bytes classified per AVX2 step
+
+// Bitmasks describing the tokens that start in one 32-byte block.
+typedef struct {
+    uint32_t number;  // Token starts of numeric tokens
+    uint32_t cancel;  // Token starts of "C"
+    uint32_t dbl;     // Token starts of "D"
+    uint32_t plus;    // Token starts of "+"
+} TokenMasks;
+
+static inline uint32_t cmpMask(__m256i block, char c) {
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(c)));
+}
+
+static inline int isDelimiter(char c) {
+    return c == '\n' || c == ',' || c == '\r';
+}
+
+// Classifies one 32-byte block.
+// prevDelim: 1 if the byte before the block is a delimiter (or the buffer starts here).
+// next:      the byte after the block ('\n' past the end of the buffer).
+static inline TokenMasks classifyBlock(const char *p, uint32_t prevDelim, char next) {
+    __m256i block = _mm256_loadu_si256((const __m256i *)p);
+
+    uint32_t delim = cmpMask(block, '\n') | cmpMask(block, ',') | cmpMask(block, '\r');
+
+    // Digits: '0' <= byte <= '9' as two signed compares (ASCII is positive)
+    __m256i gtSlash = _mm256_cmpgt_epi8(block, _mm256_set1_epi8('0' - 1));
+    __m256i ltColon = _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), block);
+    uint32_t digit = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(gtSlash, ltColon));
+
+    // Masks of "the byte after this one is ..." with one byte of lookahead
+    uint32_t nextIsDelim = (delim >> 1) | ((uint32_t)isDelimiter(next) << 31);
+    uint32_t nextIsDigit = (digit >> 1) | ((uint32_t)(next >= '0' && next <= '9') << 31);
+
+    uint32_t starts = ~delim & ((delim << 1) | prevDelim);
+
+    TokenMasks m;
+    m.number = starts & (digit | (cmpMask(block, '-') & nextIsDigit));
+    m.cancel = starts & cmpMask(block, 'C') & nextIsDelim;
+    m.dbl    = starts & cmpMask(block, 'D') & nextIsDelim;
+    m.plus   = starts & cmpMask(block, '+') & nextIsDelim;
+    return m;
+}
+
+// Parses a decimal token the way atoi() does for the inputs we accept
+// ('-'? digits), stopping at the first non-digit or the end of the buffer.
+static inline int parseNumber(const char *p, const char *end) {
+    int negative = (*p == '-');
+    if (negative) p++;
+    unsigned value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (unsigned)(*p - '0');
+        p++;
+    }
+    return (int)(negative ? 0u - value : value);
+}
+
+// Evaluates the tokens of one block in order (running sum, as in file 2).
+static inline void evaluateBlock(const char *p, const char *end, TokenMasks m,
+                                 int *records, int *index, int *sum) {
+    uint32_t all = m.number | m.cancel | m.dbl | m.plus;
+
+    while (all) {
+        int pos = __builtin_ctz(all);
+        uint32_t bit = 1u << pos;
+        all &= all - 1;
+
+        if (m.number & bit) {
+            int num = parseNumber(p + pos, end);
+            records[(*index)++] = num;
+            *sum += num;
+        } else if ((m.cancel & bit) && *index > 0) {
+            *sum -= records[--(*index)];
+        } else if ((m.dbl & bit) && *index > 0) {
+            int doublePrev = 2 * records[*index - 1];
+            records[(*index)++] = doublePrev;
+            *sum += doublePrev;
+        } else if ((m.plus & bit) && *index > 1) {
+            int sumLastTwo = records[*index - 1] + records[*index - 2];
+            records[(*index)++] = sumLastTwo;
+            *sum += sumLastTwo;
+        }
+    }
+}
+
+// Scores a contiguous buffer of newline/comma-delimited operations.
+int calPointsBuffer(const char *buf, size_t len) {
+    // Every token needs at least one byte plus a delimiter
+    int *records = malloc(((len + 1) / 2 + 1) * sizeof(int));
+    int index = 0, sum = 0;
+    const char *end = buf + len;
+    uint32_t prevDelim = 1;  // Start of buffer behaves like a preceding delimiter
+    size_t i = 0;
+
+    for (; i + BLOCK <= len; i += BLOCK) {
+        char next = (i + BLOCK < len) ? buf[i + BLOCK] : '\n';
+        TokenMasks m = classifyBlock(buf + i, prevDelim, next);
+        evaluateBlock(buf + i, end, m, records, &index, &sum);
+        prevDelim = isDelimiter(buf[i + BLOCK - 1]);
+    }
+
+    // Tail: pad a copy of the last partial block with delimiters
+    if (i < len) {
+        char tail[BLOCK];
+        memset(tail, '\n', BLOCK);
+        memcpy(tail, buf + i, len - i);
+        TokenMasks m = classifyBlock(tail, prevDelim, '\n');
+        evaluateBlock(tail, tail + BLOCK, m, records, &index, &sum);
+    }
+
+    free(records);
+    return sum;
+}
+
+// Baseline: pointer-array calPoints with the isdigit()/strcmp() chain (as in file 2).
+int calPoints(char *ops[], int size) {
+    static int records[MAX_OPERATIONS];
+    int index = 0, sum = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            int num = atoi(ops[i]);
+            records[index++] = num;
+            sum += num;
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            sum -= records[--index];
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            int doublePrev = 2 * records[index - 1];
+            records[index++] = doublePrev;
+            sum += doublePrev;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            int sumLastTwo = records[index - 1] + records[index - 2];
+            records[index++] = sumLastTwo;
+            sum += sumLastTwo;
+        }
+    }
+
+    return sum;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    // Test cases from file 2 as delimited buffers
+    const char *testCases[] = {
+        "5,2,C,D,+",
+        "5,-2,4,C,D,9,+,+",
+        "1",
+        "0",
+        "10\nC\n",
+        "-10\nD\nD\nC\n+",
+        "5,10,+,D,+,C"
+    };
+
+    for (size_t i = 0; i < sizeof(testCases) / sizeof(testCases[0]); i++) {
+        printf("Test %lu: %d\n", i + 1, calPointsBuffer(testCases[i], strlen(testCases[i])));
+    }
+
+    // Large input, once as a pointer array and once as a single buffer
+    static char *largeOps[MAX_OPERATIONS];
+    size_t len = 500000 * 5;  // "10\nD\n"
+    char *buffer = malloc(len);
+
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+        memcpy(buffer + i * 5, "10\nD\n", 5);
+    }
+
+    double start = nowMs();
+    int result1 = calPoints(largeOps, MAX_OPERATIONS);
+    double end = nowMs();
+    printf("Pointer-array calPoints: %.3f ms, Result: %d\n", end - start, result1);
+
+    start = nowMs();
+    int result2 = calPointsBuffer(buffer, len);
+    end = nowMs();
+    printf("SIMD buffer calPoints: %.3f ms, Result: %d\n", end - start, result2);
+
+    free(buffer);
+
+    if (result1 != result2) {
+        fprintf(stderr, "Mismatch between pointer-array and buffer results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
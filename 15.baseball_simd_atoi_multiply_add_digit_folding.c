@@ -0,0 +1,242 @@
+/*
+ * Vectorized Multi-digit Integer Conversion (SSE4.1 Multiply-Add Digit Folding)
+
+   Why Replace atoi()?
+
+   Every variant converts numeric operations with atoi(ops[i]). atoi() is a locale-aware libc
+   call (it goes through strtol()) with a branch per character, and it dominates the profile
+   of 4.baseball_parallel_bench_large_test_cases.c.
+
+   parseIntSimd() converts a signed decimal token of up to 10 digits with a fixed number of
+   instructions, no matter how many digits it has:
+
+   1. Load 16 bytes and subtract '0'. Bytes with (byte - '0') <= 9 (unsigned) are digits;
+      the number of leading digits n comes from one movemask and ctz.
+   2. Right-align the n digits with a single pshufb, so the last digit sits in byte 15 and
+      unused bytes become 0.
+   3. Fold neighbouring digits with multiply-adds:
+          _mm_maddubs_epi16  x {10, 1}     -> 8 values of 2 digits
+          _mm_madd_epi16     x {100, 1}    -> 4 values of 4 digits
+          _mm_packus_epi32 + _mm_madd_epi16 x {10000, 1} -> 2 values of 8 digits
+      value = high * 100000000 + low (64-bit, so 10-digit tokens cannot wrap).
+   4. Overflow detection: if the value does not fit in an int, or the token has more than
+      10 digits, the caller falls back to the scalar atoi() path. Results are therefore
+      identical to the baseline for every input.
+
+   The 16-byte load is only done when it cannot cross a page boundary; tokens near the end
+   of a page take the scalar fallback as well.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (the input of file 4, expected 15,000,000).
+   - "-123456789", "987654321", "C", "7", "+" repeated 200,000 times: long numbers that
+     make atoi() loop over every digit (the int sum wraps around to 821,169,408, the
+     same with both parsers).
+
+   Expected Output
+   ---------------
+   atoi check: OK
+   [10, D] atoi: [time_ms] ms, Result: 15000000
+   [10, D] SIMD parse: [time_ms] ms, Result: 15000000
+   [10, D] SIMD parse multi-threaded: [time_ms] ms, Result: 15000000
+   [long numbers] atoi: [time_ms] ms, Result: 821169408
+   [long numbers] SIMD parse: [time_ms] ms, Result: 821169408
+
+   gcc -msse4.1 -pthread -O3 15.baseball_simd_atoi_multiply_add_digit_folding.c -o baseball_simd_atoi
+   (or -mavx2: the same folding is then VEX-encoded)
+*/
+
+#include <stdio.h>      // printf()
+#include <stdlib.h>     // atoi()
+#include <string.h>     // strcmp()
+#include <ctype.h>      // isdigit()
+#include <stdint.h>     // uintptr_t, uint64_t
+#include <pthread.h>    // pthreads for parallel summation
+#include <smmintrin.h>  // SSE4.1 intrinsics (includes SSSE3 pshufb/pmaddubsw)
+#include <time.h>       // clock_gettime()
+
+#define MAX_OPERATIONS 1000000  // Supports up to 1 million operations
+#define NUM_THREADS 2           // Number of threads for parallel summation
+#define PAGE_SIZE 4096          // Loads must not cross into a possibly unmapped page
+#define MAX_SIMD_DIGITS 10      // Longest token parsed with SIMD (fits int64 folding)
+
+typedef struct {
+    int *records;   // Pointer to the score array
+    int start, end; // Start and end indices for partial sum calculation
+    int result;     // Partial sum result computed by each thread
+} ThreadData;
+
+// pshufb control: loading 16 bytes at offset n right-aligns n digits
+// (bytes with the high bit set are zeroed).
+static const int8_t alignDigits[32] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15
+};
+
+// SIMD conversion of a signed decimal token.
+// Returns 1 and stores the value on success; returns 0 when the caller must use the
+// scalar fallback (page boundary, more than 10 digits, or int overflow).
+static inline int parseIntSimd(const char *s, int *out) {
+    int negative = (s[0] == '-');
+    const char *p = s + negative;
+
+    if (((uintptr_t)p & (PAGE_SIZE - 1)) > PAGE_SIZE - 16) return 0;
+
+    __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+    __m128i digits = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+
+    // Unsigned digits <= 9: min(d, 9) == d
+    __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    unsigned mask = (unsigned)_mm_movemask_epi8(isDigit);
+    int n = __builtin_ctz(~mask);  // Leading digits (~mask has bit 16+ set)
+
+    if (n == 0 || n > MAX_SIMD_DIGITS) return 0;
+
+    // Right-align: byte i takes digit i - (16 - n), leading bytes become 0
+    __m128i control = _mm_loadu_si128((const __m128i *)(alignDigits + n));
+    digits = _mm_shuffle_epi8(digits, control);
+
+    // Multiply-add digit folding
+    __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                                            10, 1, 10, 1, 10, 1, 10, 1));
+    __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    __m128i packed = _mm_packus_epi32(quads, quads);
+    __m128i octets = _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1,
+                                                           10000, 1, 10000, 1));
+
+    uint64_t high = (uint32_t)_mm_cvtsi128_si32(octets);
+    uint64_t low = (uint32_t)_mm_extract_epi32(octets, 1);
+    uint64_t value = high * 100000000ULL + low;
+
+    // Overflow detection: |INT_MIN| = 2147483648
+    if (value > 2147483647ULL + (uint64_t)negative) return 0;
+
+    *out = negative ? (int)(0 - value) : (int)value;
+    return 1;
+}
+
+// Drop-in replacement for atoi() in the hot loop: SIMD first, scalar fallback.
+static inline int parseInt(const char *s) {
+    int value;
+    if (parseIntSimd(s, &value)) return value;
+    return atoi(s);
+}
+
+// Function for thread to compute partial sum
+void *parallelSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    int sum = 0;
+
+    for (int i = data->start; i < data->end; i++) {
+        sum += data->records[i];
+    }
+
+    data->result = sum;
+    pthread_exit(NULL);
+}
+
+// Function to process operations and compute sum
+// useSimdParse selects parseInt() over atoi() for numeric operations.
+int calPoints(char *ops[], int size, int useMultithreading, int useSimdParse) {
+    static int records[MAX_OPERATIONS];
+    int index = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = useSimdParse ? parseInt(ops[i]) : atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+
+    if (!useMultithreading || index < 500) {
+        int sum = 0;
+        for (int i = 0; i < index; i++) sum += records[i];
+        return sum;
+    }
+
+    pthread_t threads[NUM_THREADS];
+    ThreadData data[NUM_THREADS];
+    int mid = index / NUM_THREADS;
+
+    for (int i = 0; i < NUM_THREADS; i++) {
+        data[i].records = records;
+        data[i].start = i * mid;
+        data[i].end = (i == NUM_THREADS - 1) ? index : (i + 1) * mid;
+        pthread_create(&threads[i], NULL, parallelSum, &data[i]);
+    }
+
+    int totalSum = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        totalSum += data[i].result;
+    }
+
+    return totalSum;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Times one calPoints configuration and prints its result.
+int benchmark(const char *label, char *ops[], int size, int useMultithreading, int useSimdParse) {
+    double start = nowMs();
+    int result = calPoints(ops, size, useMultithreading, useSimdParse);
+    double end = nowMs();
+    printf("%s: %.3f ms, Result: %d\n", label, end - start, result);
+    return result;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+
+    // Conversion check against atoi(): every digit count, sign, and overflow
+    const char *samples[] = {
+        "0", "7", "-7", "10", "-2", "42abc", "123456789", "-123456789", "1000000000",
+        "2147483647", "-2147483648", "2147483648", "-2147483649", "9999999999",
+        "12345678901", "00000000000000000042", "-0", "5,", "99\n"
+    };
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        if (parseInt(samples[i]) != atoi(samples[i])) {
+            fprintf(stderr, "parseInt(\"%s\") = %d, atoi = %d\n",
+                    samples[i], parseInt(samples[i]), atoi(samples[i]));
+            return EXIT_FAILURE;
+        }
+    }
+    printf("atoi check: OK\n");
+
+    // Input of file 4: "10", "D", ...
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+
+    int r1 = benchmark("[10, D] atoi", largeOps, MAX_OPERATIONS, 0, 0);
+    int r2 = benchmark("[10, D] SIMD parse", largeOps, MAX_OPERATIONS, 0, 1);
+    int r3 = benchmark("[10, D] SIMD parse multi-threaded", largeOps, MAX_OPERATIONS, 1, 1);
+
+    // Long numbers: atoi() pays one iteration per digit
+    char *pattern[] = {"-123456789", "987654321", "C", "7", "+"};
+    for (int i = 0; i < MAX_OPERATIONS; i++) {
+        largeOps[i] = pattern[i % 5];
+    }
+
+    int r4 = benchmark("[long numbers] atoi", largeOps, MAX_OPERATIONS, 0, 0);
+    int r5 = benchmark("[long numbers] SIMD parse", largeOps, MAX_OPERATIONS, 0, 1);
+
+    if (r1 != r2 || r1 != r3 || r4 != r5) {
+        fprintf(stderr, "Mismatch between atoi and SIMD parse results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
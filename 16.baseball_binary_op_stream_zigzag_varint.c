@@ -0,0 +1,397 @@
+/*
+ * Compact Binary Op-Stream Format: Encoder and Direct Evaluator
+
+   Why a Binary Format?
+
+   Our games are stored as text tokens and parsed again on every run. At 1,000,000 ops the
+   `largeOps` pointer array alone is 8 MB (plus the strings it points to), and every run pays
+   for isdigit()/strcmp()/atoi() again.
+
+   This program encodes the op stream once into a compact byte format and evaluates the
+   encoded bytes directly:
+
+   Encoding
+   --------
+   Every op starts with one byte whose low 2 bits are a tag:
+
+       tag 1  "C"     one byte: 0x01
+       tag 2  "D"     one byte: 0x02
+       tag 3  "+"     one byte: 0x03
+       tag 0  number  varint of (zigzag(x) << 2), 7 bits per byte, high bit = "more bytes"
+
+   zigzag(x) = (x << 1) ^ (x >> 31) maps small negative and positive scores to small
+   unsigned values (0, -1, 1, -2 ... -> 0, 1, 2, 3 ...), so scores with |x| < 16 take one
+   byte and every int fits in 5 bytes. Tokens that are neither numbers nor "C"/"D"/"+" are
+   no-ops in 1.baseball_game.c and are dropped by the encoder.
+
+   "10", "D" repeated 500,000 times encodes to 1,000,000 bytes (1 MB) instead of an 8 MB
+   pointer array.
+
+   File Layout (writeOpStream / readOpStream)
+   ------------------------------------------
+       "SBOP"  magic (4 bytes)
+       uint32  format version (1)
+       uint64  op count
+       uint64  byte length
+       bytes   encoded ops
+
+   readOpStream does not trust the header: a length that disagrees with the file size, a
+   count larger than the length, a varint cut off at the end or longer than 5 bytes, or more
+   ops than `count` (which sizes `records`) makes the read fail.
+
+   Input Explained
+   ---------------
+   - The seven test cases from 2.baseball_game_direct_update_sum_store_converted_values.c,
+     encoded and evaluated from the byte stream.
+   - "10", "D" repeated 500,000 times, encoded once and scored SCORE_RUNS times.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Pointer array: 8000000 bytes, encoded stream: 1000000 bytes
+   Text calPoints x5: [time_ms] ms, Result: 15000000
+   Encode once: [time_ms] ms
+   Encoded calPoints x5: [time_ms] ms, Result: 15000000
+   File round trip: OK
+   Corrupt streams rejected: OK
+
+   gcc -O3 16.baseball_binary_op_stream_zigzag_varint.c -o baseball_binary_ops
+*/
+
+#include <stdio.h>      // printf(), FILE I/O
+#include <stdlib.h>     // atoi(), malloc(), free()
+#include <string.h>     // strcmp(), memcmp()
+#include <ctype.h>      // isdigit()
+#include <stdint.h>     // fixed-width integer types
+#include <limits.h>     // INT_MAX
+#include <time.h>       // clock_gettime()
+
+#define MAX_OPERATIONS 1000000  // 1 million operations supported
+#define SCORE_RUNS 5            // Times the same input is scored in the benchmark
+
+#define OP_NUMBER 0     // Tag of a varint-encoded number
+#define OP_CANCEL 1     // "C"
+#define OP_DOUBLE 2     // "D"
+#define OP_PLUS   3     // "+"
+#define MAX_VARINT_BYTES 5  // zigzag(int) << 2 needs at most 34 bits
+
+#define OPSTREAM_MAGIC "SBOP"
+#define OPSTREAM_VERSION 1
+
+// Encoded operation stream
+typedef struct {
+    uint8_t *bytes;   // Encoded ops
+    size_t length;    // Bytes used
+    size_t count;     // Ops encoded (upper bound for the number of records)
+} OpStream;
+
+static inline uint32_t zigzagEncode(int x) {
+    return ((uint32_t)x << 1) ^ (uint32_t)(x >> 31);
+}
+
+static inline int zigzagDecode(uint32_t z) {
+    return (int)((z >> 1) ^ (0u - (z & 1)));
+}
+
+// Encodes the text form of an op stream. The caller frees stream->bytes.
+// Returns 0 on success, -1 if out of memory.
+int encodeOps(char *ops[], int size, OpStream *stream) {
+    stream->bytes = malloc(size ? (size_t)size * MAX_VARINT_BYTES : 1);
+    stream->length = 0;
+    stream->count = 0;
+    if (!stream->bytes) return -1;
+    uint8_t *out = stream->bytes;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            uint64_t v = (uint64_t)zigzagEncode(atoi(ops[i])) << 2;  // Tag 0 in the low bits
+            while (v >= 0x80) {
+                *out++ = (uint8_t)(v | 0x80);
+                v >>= 7;
+            }
+            *out++ = (uint8_t)v;
+        } else if (strcmp(ops[i], "C") == 0) {
+            *out++ = OP_CANCEL;
+        } else if (strcmp(ops[i], "D") == 0) {
+            *out++ = OP_DOUBLE;
+        } else if (strcmp(ops[i], "+") == 0) {
+            *out++ = OP_PLUS;
+        } else {
+            continue;  // No-op token, nothing to encode
+        }
+        stream->count++;
+    }
+
+    stream->length = (size_t)(out - stream->bytes);
+    uint8_t *shrunk = realloc(stream->bytes, stream->length ? stream->length : 1);
+    if (shrunk) stream->bytes = shrunk;  // Keeping the larger buffer is harmless
+    return 0;
+}
+
+// Checks that a stream decodes cleanly: every varint ends before the last byte, no varint
+// is longer than MAX_VARINT_BYTES and there are at most `count` ops, so calPointsEncoded
+// never reads past `bytes` or writes past `records`. Returns 0 if valid, -1 otherwise.
+int validateOpStream(const OpStream *stream) {
+    const uint8_t *p = stream->bytes;
+    const uint8_t *end = stream->bytes + stream->length;
+    size_t ops = 0;
+
+    while (p < end) {
+        uint8_t b = *p++;
+        if ((b & 3) == OP_NUMBER) {
+            int shift = 7;
+            while (b & 0x80) {
+                if (p == end || shift > 28) return -1;  // Truncated, or past 5 bytes
+                b = *p++;
+                shift += 7;
+            }
+        }
+        if (++ops > stream->count) return -1;
+    }
+    return 0;
+}
+
+// Evaluates an encoded op stream directly (running sum, as in file 2). The stream must come
+// from encodeOps or pass validateOpStream. Returns 0 on success, -1 if out of memory.
+int calPointsEncoded(const OpStream *stream, int *result) {
+    int *records = malloc((stream->count ? stream->count : 1) * sizeof(int));
+    if (!records) return -1;
+    int index = 0, sum = 0;
+    const uint8_t *p = stream->bytes;
+    const uint8_t *end = stream->bytes + stream->length;
+
+    while (p < end) {
+        uint8_t b = *p++;
+        switch (b & 3) {
+        case OP_NUMBER: {
+            uint64_t v = b & 0x7F;
+            int shift = 7;
+            while (b & 0x80) {
+                b = *p++;
+                v |= (uint64_t)(b & 0x7F) << shift;
+                shift += 7;
+            }
+            int num = zigzagDecode((uint32_t)(v >> 2));
+            records[index++] = num;
+            sum += num;
+            break;
+        }
+        case OP_CANCEL:
+            if (index > 0) sum -= records[--index];
+            break;
+        case OP_DOUBLE:
+            if (index > 0) {
+                int doublePrev = 2 * records[index - 1];
+                records[index++] = doublePrev;
+                sum += doublePrev;
+            }
+            break;
+        case OP_PLUS:
+            if (index > 1) {
+                int sumLastTwo = records[index - 1] + records[index - 2];
+                records[index++] = sumLastTwo;
+                sum += sumLastTwo;
+            }
+            break;
+        }
+    }
+
+    free(records);
+    *result = sum;
+    return 0;
+}
+
+// Writes an encoded stream with its header. Returns 0 on success, -1 on error.
+int writeOpStream(const char *path, const OpStream *stream) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+
+    uint32_t version = OPSTREAM_VERSION;
+    uint64_t count = stream->count, length = stream->length;
+    int ok = fwrite(OPSTREAM_MAGIC, 1, 4, f) == 4 &&
+             fwrite(&version, sizeof(version), 1, f) == 1 &&
+             fwrite(&count, sizeof(count), 1, f) == 1 &&
+             fwrite(&length, sizeof(length), 1, f) == 1 &&
+             fwrite(stream->bytes, 1, stream->length, f) == stream->length;
+
+    if (fclose(f) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+// Reads a stream written by writeOpStream. The header is not trusted: its byte length must
+// match the rest of the file, the op count cannot exceed the byte length (every op takes at
+// least one byte) and the bytes must pass validateOpStream. Returns 0 on success, -1 on error.
+int readOpStream(const char *path, OpStream *stream) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+
+    char magic[4];
+    uint32_t version;
+    uint64_t count, length;
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, OPSTREAM_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(version), 1, f) != 1 || version != OPSTREAM_VERSION ||
+        fread(&count, sizeof(count), 1, f) != 1 ||
+        fread(&length, sizeof(length), 1, f) != 1) {
+        fclose(f);
+        return -1;
+    }
+
+    // Bytes left after the header
+    long header = ftell(f);
+    if (header < 0 || fseek(f, 0, SEEK_END) != 0) {
+        fclose(f);
+        return -1;
+    }
+    long fileSize = ftell(f);
+    if (fileSize < header || fseek(f, header, SEEK_SET) != 0 ||
+        length != (uint64_t)(fileSize - header) || count > length || count > INT_MAX) {
+        fclose(f);
+        return -1;
+    }
+
+    stream->bytes = malloc(length ? length : 1);
+    if (!stream->bytes || fread(stream->bytes, 1, length, f) != length) {
+        free(stream->bytes);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    stream->count = count;
+    stream->length = length;
+    if (validateOpStream(stream) != 0) {
+        free(stream->bytes);
+        stream->bytes = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+// Text baseline: the running-sum calPoints of file 2.
+int calPoints(char *ops[], int size) {
+    static int records[MAX_OPERATIONS];
+    int index = 0, sum = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            int num = atoi(ops[i]);
+            records[index++] = num;
+            sum += num;
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            sum -= records[--index];
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            int doublePrev = 2 * records[index - 1];
+            records[index++] = doublePrev;
+            sum += doublePrev;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            int sumLastTwo = records[index - 1] + records[index - 2];
+            records[index++] = sumLastTwo;
+            sum += sumLastTwo;
+        }
+    }
+
+    return sum;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    OpStream stream;
+
+    // Test cases from file 2, evaluated from the encoded form
+    char *testCases[][8] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int sizes[] = {5, 8, 1, 1, 2, 5, 6};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        int result;
+        if (encodeOps(testCases[i], sizes[i], &stream) != 0 || calPointsEncoded(&stream, &result) != 0) {
+            fprintf(stderr, "Out of memory!\n");
+            return EXIT_FAILURE;
+        }
+        printf("Test %lu: %d\n", i + 1, result);
+        free(stream.bytes);
+    }
+
+    // Generate large input: "10", "D", "10", "D", ...
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+
+    double start = nowMs();
+    int result1 = 0;
+    for (int run = 0; run < SCORE_RUNS; run++) result1 = calPoints(largeOps, MAX_OPERATIONS);
+    double end = nowMs();
+
+    double encodeStart = nowMs();
+    if (encodeOps(largeOps, MAX_OPERATIONS, &stream) != 0) {
+        fprintf(stderr, "Out of memory!\n");
+        return EXIT_FAILURE;
+    }
+    double encodeEnd = nowMs();
+
+    printf("Pointer array: %zu bytes, encoded stream: %zu bytes\n",
+           sizeof(largeOps), stream.length);
+    printf("Text calPoints x%d: %.3f ms, Result: %d\n", SCORE_RUNS, end - start, result1);
+    printf("Encode once: %.3f ms\n", encodeEnd - encodeStart);
+
+    start = nowMs();
+    int result2 = 0;
+    for (int run = 0; run < SCORE_RUNS; run++) {
+        if (calPointsEncoded(&stream, &result2) != 0) {
+            fprintf(stderr, "Out of memory!\n");
+            return EXIT_FAILURE;
+        }
+    }
+    end = nowMs();
+    printf("Encoded calPoints x%d: %.3f ms, Result: %d\n", SCORE_RUNS, end - start, result2);
+
+    // Store once, score later without any text parsing
+    OpStream loaded;
+    int loadedResult;
+    const char *path = "baseball_ops.sbop";
+    if (writeOpStream(path, &stream) != 0 || readOpStream(path, &loaded) != 0 ||
+        calPointsEncoded(&loaded, &loadedResult) != 0 || loadedResult != result1) {
+        fprintf(stderr, "File round trip failed!\n");
+        return EXIT_FAILURE;
+    }
+    printf("File round trip: OK\n");
+    free(loaded.bytes);
+
+    // Corrupt files must be rejected, not evaluated: a header claiming fewer ops than the
+    // bytes hold, and a stream cut inside a varint
+    uint8_t truncated[] = {0x50, 0x02, 0x80};   // "10", "D", then an unfinished number
+    OpStream bad[] = {
+        {stream.bytes, stream.length, stream.count / 2},
+        {truncated, sizeof(truncated), 3}
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (writeOpStream(path, &bad[i]) != 0 || readOpStream(path, &loaded) == 0) {
+            fprintf(stderr, "Corrupt stream %zu was not rejected!\n", i + 1);
+            return EXIT_FAILURE;
+        }
+    }
+    printf("Corrupt streams rejected: OK\n");
+    remove(path);
+    free(stream.bytes);
+
+    if (result1 != result2) {
+        fprintf(stderr, "Mismatch between text and encoded results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
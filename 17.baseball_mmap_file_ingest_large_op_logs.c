@@ -0,0 +1,327 @@
+/*
+ * Memory-mapped File Ingest for Multi-gigabyte Op Logs
+
+   Why mmap?
+
+   Every benchmark so far builds `static char *largeOps[MAX_OPERATIONS]` from string literals,
+   and nothing reads real data. Game logs are tens of GB; reading them through stdio copies
+   every byte from the page cache into a user buffer before scoring even starts, and the
+   1,000,000-op MAX_OPERATIONS ceiling does not fit them at all.
+
+   This program scores an op log file in place:
+
+   1. mmap() the whole file read-only. No intermediate buffer, no copies.
+   2. madvise(MADV_SEQUENTIAL) so the kernel reads ahead aggressively and drops pages behind
+      us, and madvise(MADV_HUGEPAGE) so file systems that support huge pages in the page
+      cache map the log with 2 MB pages (fewer TLB misses). The outcome of each hint is
+      reported; an unsupported hint is not an error.
+   3. Tokenize and evaluate the mapping with the AVX2 tokenizer of
+      14.baseball_simd_tokenizer_raw_buffer_avx2.c.
+   4. After every WINDOW_BYTES the consumed part of the mapping is released with
+      madvise(MADV_DONTNEED), so resident memory stays bounded by the window size
+      instead of growing with the file.
+
+   The records array grows by doubling, so there is no MAX_OPERATIONS ceiling. Records stay
+   int (same arithmetic as 1.baseball_game.c); the total is accumulated as long long,
+   because the sum of a multi-GB log does not fit in an int.
+
+   Input Explained
+   ---------------
+   ./baseball_mmap [oplog]
+
+   The log holds one op per line (commas also work as delimiters). Without an argument the
+   program writes a sample log of 3,000,000 ops ("10", "D" repeated 1,500,000 times, three
+   times the old MAX_OPERATIONS ceiling) and scores that.
+
+   Expected Output (sample log)
+   ----------------------------
+   Log: baseball_ops.log, 7500000 bytes
+   madvise(MADV_SEQUENTIAL): ok
+   madvise(MADV_HUGEPAGE): ok | not supported for this mapping
+   stdio read + tokenize: [time_ms] ms, Result: 45000000
+   mmap in place: [time_ms] ms, Result: 45000000
+
+   gcc -mavx2 -O3 17.baseball_mmap_file_ingest_large_op_logs.c -o baseball_mmap
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>      // printf(), stdio baseline
+#include <stdlib.h>     // malloc(), realloc()
+#include <string.h>     // memcpy(), memset(), strerror()
+#include <errno.h>      // errno
+#include <stdint.h>     // uint32_t bitmasks
+#include <immintrin.h>  // AVX2 intrinsics
+#include <fcntl.h>      // open()
+#include <unistd.h>     // close(), sysconf()
+#include <sys/mman.h>   // mmap(), madvise()
+#include <sys/stat.h>   // fstat()
+#include <time.h>       // clock_gettime()
+
+#define BLOCK 32                       // Bytes classified per AVX2 step
+#define WINDOW_BYTES (64UL << 20)      // Release consumed input every 64 MB
+#define INITIAL_RECORDS 4096           // First records allocation; doubles on demand
+#define SAMPLE_PAIRS 1500000           // "10", "D" pairs in the generated sample log
+
+// Bitmasks describing the tokens that start in one 32-byte block.
+typedef struct {
+    uint32_t number;  // Token starts of numeric tokens
+    uint32_t cancel;  // Token starts of "C"
+    uint32_t dbl;     // Token starts of "D"
+    uint32_t plus;    // Token starts of "+"
+} TokenMasks;
+
+// Growable scoring state: records without a fixed ceiling plus the running total.
+typedef struct {
+    int *records;
+    size_t index;
+    size_t capacity;
+    long long sum;
+} ScoreState;
+
+static inline uint32_t cmpMask(__m256i block, char c) {
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(c)));
+}
+
+static inline int isDelimiter(char c) {
+    return c == '\n' || c == ',' || c == '\r';
+}
+
+// Classifies one 32-byte block (see file 14).
+static inline TokenMasks classifyBlock(const char *p, uint32_t prevDelim, char next) {
+    __m256i block = _mm256_loadu_si256((const __m256i *)p);
+
+    uint32_t delim = cmpMask(block, '\n') | cmpMask(block, ',') | cmpMask(block, '\r');
+
+    __m256i gtSlash = _mm256_cmpgt_epi8(block, _mm256_set1_epi8('0' - 1));
+    __m256i ltColon = _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), block);
+    uint32_t digit = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(gtSlash, ltColon));
+
+    uint32_t nextIsDelim = (delim >> 1) | ((uint32_t)isDelimiter(next) << 31);
+    uint32_t nextIsDigit = (digit >> 1) | ((uint32_t)(next >= '0' && next <= '9') << 31);
+
+    uint32_t starts = ~delim & ((delim << 1) | prevDelim);
+
+    TokenMasks m;
+    m.number = starts & (digit | (cmpMask(block, '-') & nextIsDigit));
+    m.cancel = starts & cmpMask(block, 'C') & nextIsDelim;
+    m.dbl    = starts & cmpMask(block, 'D') & nextIsDelim;
+    m.plus   = starts & cmpMask(block, '+') & nextIsDelim;
+    return m;
+}
+
+static inline int parseNumber(const char *p, const char *end) {
+    int negative = (*p == '-');
+    if (negative) p++;
+    unsigned value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (unsigned)(*p - '0');
+        p++;
+    }
+    return (int)(negative ? 0u - value : value);
+}
+
+// Evaluates the tokens of one block in order. The caller guarantees room for
+// BLOCK more records.
+static inline void evaluateBlock(const char *p, const char *end, TokenMasks m, ScoreState *st) {
+    uint32_t all = m.number | m.cancel | m.dbl | m.plus;
+    int *records = st->records;
+    size_t index = st->index;
+    long long sum = st->sum;
+
+    while (all) {
+        int pos = __builtin_ctz(all);
+        uint32_t bit = 1u << pos;
+        all &= all - 1;
+
+        if (m.number & bit) {
+            int num = parseNumber(p + pos, end);
+            records[index++] = num;
+            sum += num;
+        } else if ((m.cancel & bit) && index > 0) {
+            sum -= records[--index];
+        } else if ((m.dbl & bit) && index > 0) {
+            int doublePrev = 2 * records[index - 1];
+            records[index++] = doublePrev;
+            sum += doublePrev;
+        } else if ((m.plus & bit) && index > 1) {
+            int sumLastTwo = records[index - 1] + records[index - 2];
+            records[index++] = sumLastTwo;
+            sum += sumLastTwo;
+        }
+    }
+
+    st->index = index;
+    st->sum = sum;
+}
+
+// Makes room for one more block of records.
+static inline int reserveBlock(ScoreState *st) {
+    if (st->index + BLOCK <= st->capacity) return 0;
+    size_t capacity = st->capacity * 2;
+    int *records = realloc(st->records, capacity * sizeof(int));
+    if (!records) return -1;
+    st->records = records;
+    st->capacity = capacity;
+    return 0;
+}
+
+// Scores a byte buffer in place. If `releaseBehind` is set the buffer is a private
+// mapping and consumed windows are dropped with MADV_DONTNEED.
+int scoreBuffer(const char *buf, size_t len, int releaseBehind, long long *total) {
+    ScoreState st = { malloc(INITIAL_RECORDS * sizeof(int)), 0, INITIAL_RECORDS, 0 };
+    const char *end = buf + len;
+    uint32_t prevDelim = 1;
+    size_t released = 0;
+    size_t i = 0;
+
+    if (!st.records) return -1;
+
+    for (; i + BLOCK <= len; i += BLOCK) {
+        if (reserveBlock(&st) != 0) { free(st.records); return -1; }
+        char next = (i + BLOCK < len) ? buf[i + BLOCK] : '\n';
+        TokenMasks m = classifyBlock(buf + i, prevDelim, next);
+        evaluateBlock(buf + i, end, m, &st);
+        prevDelim = isDelimiter(buf[i + BLOCK - 1]);
+
+        // Drop everything except the current window tail; a number that
+        // started before `i` can still be read, so keep one window back.
+        if (releaseBehind && i - released >= 2 * WINDOW_BYTES) {
+            madvise((void *)(buf + released), WINDOW_BYTES, MADV_DONTNEED);
+            released += WINDOW_BYTES;
+        }
+    }
+
+    if (i < len) {
+        char tail[BLOCK];
+        memset(tail, '\n', BLOCK);
+        memcpy(tail, buf + i, len - i);
+        if (reserveBlock(&st) != 0) { free(st.records); return -1; }
+        TokenMasks m = classifyBlock(tail, prevDelim, '\n');
+        evaluateBlock(tail, tail + BLOCK, m, &st);
+    }
+
+    free(st.records);
+    *total = st.sum;
+    return 0;
+}
+
+// Maps an op log and scores it in place. Returns 0 on success, -1 on error.
+int calPointsFile(const char *path, long long *total) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "open(%s): %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        fprintf(stderr, "fstat(%s): %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    size_t len = (size_t)sb.st_size;
+    if (len == 0) {  // mmap() rejects empty mappings; an empty log scores 0
+        close(fd);
+        *total = 0;
+        return 0;
+    }
+
+    char *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file referenced
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "mmap(%s): %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    printf("madvise(MADV_SEQUENTIAL): %s\n",
+           madvise(map, len, MADV_SEQUENTIAL) == 0 ? "ok" : strerror(errno));
+    printf("madvise(MADV_HUGEPAGE): %s\n",
+           madvise(map, len, MADV_HUGEPAGE) == 0 ? "ok" : "not supported for this mapping");
+
+    int rc = scoreBuffer(map, len, 1, total);
+    munmap(map, len);
+    return rc;
+}
+
+// Baseline: read the whole log through stdio into a heap buffer, then tokenize.
+int calPointsStdio(const char *path, long long *total) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+
+    fseek(f, 0, SEEK_END);
+    size_t len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *buf = malloc(len ? len : 1);
+    if (!buf || fread(buf, 1, len, f) != len) {
+        free(buf);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    int rc = scoreBuffer(buf, len, 0, total);
+    free(buf);
+    return rc;
+}
+
+// Writes the sample log: "10", "D" repeated SAMPLE_PAIRS times.
+int writeSampleLog(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    for (long i = 0; i < SAMPLE_PAIRS; i++) {
+        fputs("10\nD\n", f);
+    }
+    return fclose(f);
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = (argc > 1) ? argv[1] : "baseball_ops.log";
+
+    if (argc <= 1 && writeSampleLog(path) != 0) {
+        fprintf(stderr, "Could not write sample log %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    struct stat sb;
+    if (stat(path, &sb) != 0) {
+        fprintf(stderr, "stat(%s): %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    printf("Log: %s, %lld bytes\n", path, (long long)sb.st_size);
+
+    long long result1 = 0, result2 = 0;
+
+    double start = nowMs();
+    if (calPointsStdio(path, &result1) != 0) {
+        fprintf(stderr, "stdio ingest failed\n");
+        return EXIT_FAILURE;
+    }
+    double end = nowMs();
+    double stdioMs = end - start;
+
+    start = nowMs();
+    if (calPointsFile(path, &result2) != 0) {
+        return EXIT_FAILURE;
+    }
+    end = nowMs();
+
+    printf("stdio read + tokenize: %.3f ms, Result: %lld\n", stdioMs, result1);
+    printf("mmap in place: %.3f ms, Result: %lld\n", end - start, result2);
+
+    if (argc <= 1) remove(path);
+
+    if (result1 != result2) {
+        fprintf(stderr, "Mismatch between stdio and mmap results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,327 @@
+/*
+ * Unbounded Records Storage: Segmented Records Arena with a Reusable Chunk Pool
+
+   Why Replace static int records[MAX_OPERATIONS]?
+
+   Every calPoints so far keeps its records in `static int records[MAX_OPERATIONS]`:
+   - Inputs above 1,000,000 ops overflow it silently (no bounds check).
+   - Its 4 MB is reserved even when scoring five ops.
+   - Raising the limit means recompiling.
+
+   Records Arena
+   -------------
+   Records live in fixed-size chunks of CHUNK_RECORDS ints (16 KB, so a small game stays
+   in L1). Each chunk is 64-byte aligned (one cache line), which also makes every chunk
+   start valid for the aligned AVX loads (_mm256_load_si256) used by the reducer.
+
+   - Position i lives in chunks[i >> CHUNK_SHIFT][i & CHUNK_MASK].
+   - push: O(1); a new chunk is taken from the pool only when the position crosses into a
+           chunk that was never used before.
+   - pop ("C"): O(1); only the count moves. Chunks above the top are kept until the arena
+           is released, so C/push sequences around a chunk boundary never allocate.
+   - "D" and "+" read the one or two positions below the top, even across a boundary.
+
+   Chunk Pool
+   ----------
+   Released arenas return their chunks to a pool (up to POOL_MAX_CHUNKS), and the next
+   arena takes them from there instead of calling aligned_alloc() again. The pool is not
+   synchronized: one pool per scoring thread.
+
+   SIMD Reducers Walk the Chunks
+   -----------------------------
+   The multi-threaded sum splits the records on chunk boundaries. Each thread runs the AVX
+   loop of 5.baseball_parallel_optimization_simd_avx_sse.c chunk by chunk with aligned loads.
+
+   Input Explained
+   ---------------
+   - The seven test cases from 2.baseball_game_direct_update_sum_store_converted_values.c.
+   - "10", "D" repeated 500,000 times (1M ops, expected 15,000,000), scored with the static
+     array of file 5 and with the arena.
+   - "10", "D" repeated 1,500,000 times (3M ops, three times MAX_OPERATIONS, expected
+     45,000,000), which the static array cannot hold.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Static records array: [time_ms] ms, Result: 15000000
+   Records arena: [time_ms] ms, Result: 15000000
+   Records arena (3M ops): [time_ms] ms, Result: 45000000
+   Small game footprint: 1 chunk(s), 16384 bytes
+   Pool: [n] chunk(s) ready for reuse
+
+   gcc -mavx2 -pthread -O3 18.baseball_chunked_records_arena_pool.c -o baseball_arena
+*/
+
+#include <stdio.h>      // printf()
+#include <stdlib.h>     // atoi(), aligned_alloc(), realloc(), free()
+#include <string.h>     // strcmp()
+#include <ctype.h>      // isdigit()
+#include <pthread.h>    // pthreads for parallel summation
+#include <immintrin.h>  // AVX intrinsics
+#include <time.h>       // clock_gettime()
+
+#define MAX_OPERATIONS 1000000      // Limit of the static-array baseline only
+#define NUM_THREADS 2               // Threads for the parallel sum
+#define CHUNK_SHIFT 12
+#define CHUNK_RECORDS (1 << CHUNK_SHIFT)  // 4096 ints = 16 KB per chunk
+#define CHUNK_MASK (CHUNK_RECORDS - 1)
+#define CHUNK_ALIGN 64              // Cache-line alignment of every chunk
+#define POOL_MAX_CHUNKS 1024        // Chunks kept for reuse (16 MB)
+
+// Free chunks ready for reuse.
+typedef struct {
+    int *chunks[POOL_MAX_CHUNKS];
+    int count;
+} ChunkPool;
+
+// Growable records storage made of fixed-size chunks.
+typedef struct {
+    int **chunks;        // Chunk directory
+    int numChunks;       // Chunks owned by the arena
+    int dirCapacity;     // Capacity of the chunk directory
+    size_t count;        // Records currently on the stack
+    ChunkPool *pool;     // Where chunks come from and go back to
+} RecordsArena;
+
+typedef struct {
+    RecordsArena *arena;  // Records to sum
+    size_t start, end;    // Record range for this thread (start is chunk-aligned)
+    int result;           // Partial sum result
+} ThreadData;
+
+int *poolAcquire(ChunkPool *pool) {
+    if (pool->count > 0) return pool->chunks[--pool->count];
+    return aligned_alloc(CHUNK_ALIGN, CHUNK_RECORDS * sizeof(int));
+}
+
+void poolRelease(ChunkPool *pool, int *chunk) {
+    if (pool->count < POOL_MAX_CHUNKS) {
+        pool->chunks[pool->count++] = chunk;
+    } else {
+        free(chunk);
+    }
+}
+
+void poolDestroy(ChunkPool *pool) {
+    while (pool->count > 0) free(pool->chunks[--pool->count]);
+}
+
+void arenaInit(RecordsArena *arena, ChunkPool *pool) {
+    arena->chunks = NULL;
+    arena->numChunks = 0;
+    arena->dirCapacity = 0;
+    arena->count = 0;
+    arena->pool = pool;
+}
+
+// Returns all chunks to the pool; the arena can be reused after arenaInit.
+void arenaRelease(RecordsArena *arena) {
+    for (int i = 0; i < arena->numChunks; i++) poolRelease(arena->pool, arena->chunks[i]);
+    free(arena->chunks);
+    arenaInit(arena, arena->pool);
+}
+
+// Slow path of arenaPush: the next position starts a chunk the arena does not own yet.
+static int arenaGrow(RecordsArena *arena) {
+    if (arena->numChunks == arena->dirCapacity) {
+        int capacity = arena->dirCapacity ? arena->dirCapacity * 2 : 16;
+        int **chunks = realloc(arena->chunks, capacity * sizeof(int *));
+        if (!chunks) return -1;
+        arena->chunks = chunks;
+        arena->dirCapacity = capacity;
+    }
+    int *chunk = poolAcquire(arena->pool);
+    if (!chunk) return -1;
+    arena->chunks[arena->numChunks++] = chunk;
+    return 0;
+}
+
+static inline int *arenaAt(RecordsArena *arena, size_t i) {
+    return &arena->chunks[i >> CHUNK_SHIFT][i & CHUNK_MASK];
+}
+
+static inline int arenaPush(RecordsArena *arena, int value) {
+    size_t i = arena->count;
+    if ((i >> CHUNK_SHIFT) == (size_t)arena->numChunks && arenaGrow(arena) != 0) return -1;
+    *arenaAt(arena, i) = value;
+    arena->count = i + 1;
+    return 0;
+}
+
+// k = 0 is the top record, k = 1 the one below it.
+static inline int arenaPeek(RecordsArena *arena, size_t k) {
+    return *arenaAt(arena, arena->count - 1 - k);
+}
+
+// SIMD-optimized sum over a chunk-aligned range of the arena
+void *arenaSimdSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    __m256i sumVec = _mm256_setzero_si256();
+    int sum = 0;
+    size_t i = data->start;
+
+    while (i < data->end) {
+        int *chunk = data->arena->chunks[i >> CHUNK_SHIFT];
+        size_t offset = i & CHUNK_MASK;
+        size_t n = CHUNK_RECORDS - offset;
+        if (n > data->end - i) n = data->end - i;
+
+        size_t j = offset;
+        for (; j + 7 < offset + n; j += 8) {
+            __m256i values = _mm256_load_si256((__m256i *)&chunk[j]); // Chunks are 64-byte aligned
+            sumVec = _mm256_add_epi32(sumVec, values);
+        }
+        for (; j < offset + n; j++) {
+            sum += chunk[j];
+        }
+        i += n;
+    }
+
+    int sumArray[8];
+    _mm256_storeu_si256((__m256i *)sumArray, sumVec);
+    sum += sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+           sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
+
+    data->result = sum;
+    return NULL;
+}
+
+// Evaluates the ops into the arena and sums the records with SIMD + threads.
+int calPoints(char *ops[], int size, int useMultithreading, ChunkPool *pool, int *chunksUsed) {
+    RecordsArena arena;
+    arenaInit(&arena, pool);
+
+    for (int i = 0; i < size; i++) {
+        int rc = 0;
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            rc = arenaPush(&arena, atoi(ops[i]));
+        } else if (strcmp(ops[i], "C") == 0 && arena.count > 0) {
+            arena.count--;
+        } else if (strcmp(ops[i], "D") == 0 && arena.count > 0) {
+            rc = arenaPush(&arena, 2 * arenaPeek(&arena, 0));
+        } else if (strcmp(ops[i], "+") == 0 && arena.count > 1) {
+            rc = arenaPush(&arena, arenaPeek(&arena, 0) + arenaPeek(&arena, 1));
+        }
+        if (rc != 0) {
+            fprintf(stderr, "Out of memory after %zu records\n", arena.count);
+            break;
+        }
+    }
+
+    if (chunksUsed) *chunksUsed = arena.numChunks;
+
+    size_t index = arena.count;
+    int totalSum = 0;
+
+    if (!useMultithreading || index < 500) {
+        ThreadData data = {&arena, 0, index, 0};
+        arenaSimdSum(&data);
+        totalSum = data.result;
+    } else {
+        pthread_t threads[NUM_THREADS];
+        ThreadData data[NUM_THREADS];
+        size_t mid = (index / NUM_THREADS) & ~(size_t)CHUNK_MASK;  // Split on chunk boundaries
+
+        for (int i = 0; i < NUM_THREADS; i++) {
+            data[i].arena = &arena;
+            data[i].start = i * mid;
+            data[i].end = (i == NUM_THREADS - 1) ? index : (i + 1) * mid;
+            pthread_create(&threads[i], NULL, arenaSimdSum, &data[i]);
+        }
+        for (int i = 0; i < NUM_THREADS; i++) {
+            pthread_join(threads[i], NULL);
+            totalSum += data[i].result;
+        }
+    }
+
+    arenaRelease(&arena);
+    return totalSum;
+}
+
+// Baseline: static records array (file 5), single-threaded sum.
+int calPointsStatic(char *ops[], int size) {
+    static int records[MAX_OPERATIONS];
+    int index = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+
+    int sum = 0;
+    for (int i = 0; i < index; i++) sum += records[i];
+    return sum;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    static ChunkPool pool;
+    int chunksUsed = 0;
+
+    char *testCases[][8] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int sizes[] = {5, 8, 1, 1, 2, 5, 6};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("Test %lu: %d\n", i + 1, calPoints(testCases[i], sizes[i], 1, &pool, NULL));
+    }
+
+    // 3M ops: three times the static array's capacity
+    int hugeSize = 3 * MAX_OPERATIONS;
+    char **largeOps = malloc(hugeSize * sizeof(char *));
+    for (int i = 0; i < hugeSize / 2; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+
+    double start = nowMs();
+    int result1 = calPointsStatic(largeOps, MAX_OPERATIONS);
+    double end = nowMs();
+    printf("Static records array: %.3f ms, Result: %d\n", end - start, result1);
+
+    start = nowMs();
+    int result2 = calPoints(largeOps, MAX_OPERATIONS, 1, &pool, NULL);
+    end = nowMs();
+    printf("Records arena: %.3f ms, Result: %d\n", end - start, result2);
+
+    start = nowMs();
+    int result3 = calPoints(largeOps, hugeSize, 1, &pool, NULL);
+    end = nowMs();
+    printf("Records arena (3M ops): %.3f ms, Result: %d\n", end - start, result3);
+
+    calPoints(testCases[1], sizes[1], 0, &pool, &chunksUsed);
+    printf("Small game footprint: %d chunk(s), %zu bytes\n",
+           chunksUsed, chunksUsed * CHUNK_RECORDS * sizeof(int));
+    printf("Pool: %d chunk(s) ready for reuse\n", pool.count);
+
+    free(largeOps);
+    poolDestroy(&pool);
+
+    if (result1 != result2 || result3 != 3 * result1) {
+        fprintf(stderr, "Mismatch between static array and arena results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
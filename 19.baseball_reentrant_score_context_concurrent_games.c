@@ -0,0 +1,333 @@
+/*
+ * Reentrant Scoring Contexts: Scoring Many Games Concurrently in One Process
+
+   Why a Context Object?
+
+   Every calPoints so far keeps `records` in a function-local `static` array. Two threads that
+   score two different games at the same time write into the same array and corrupt each
+   other's results, which is why each game has been scored in its own process.
+
+   ScoreContext
+   ------------
+   A ScoreContext owns everything one scoring call needs:
+
+   - records:   a 32-byte-aligned, growable records buffer (aligned AVX loads stay valid).
+   - workers:   the worker configuration for the in-game parallel sum
+                (numThreads and the parallelThreshold below which the sum stays single-threaded).
+   - scratch:   the pthread_t and ThreadData arrays for those workers.
+
+   scoreContextReset() forgets the records but keeps every buffer, so a context can score
+   game after game without reallocating. Contexts share nothing, so any number of threads
+   can score games at the same time, each with its own context.
+
+       ScoreContext ctx;
+       scoreContextInit(&ctx, 2, 500);
+       for (...) total = calPoints(&ctx, ops, size);   // resets ctx itself
+       scoreContextDestroy(&ctx);
+
+   Input Explained
+   ---------------
+   - The seven test cases from 2.baseball_game_direct_update_sum_store_converted_values.c.
+   - NUM_GAME_THREADS threads each score GAMES_PER_THREAD generated games of different
+     lengths (up to 4,000 ops) with one reused context, and every total is checked
+     against the single-threaded reference.
+   - "10", "D" repeated 500,000 times through a context with a 2-thread parallel sum.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Concurrent scoring: 8 threads x 500 games, [time_ms] ms, mismatches: 0
+   Context reuse: [n] records capacity, 0 reallocations after warm-up
+   Context (2 workers): [time_ms] ms, Result: 15000000
+
+   gcc -mavx2 -pthread -O3 19.baseball_reentrant_score_context_concurrent_games.c -o baseball_context
+*/
+
+#include <stdio.h>      // printf()
+#include <stdlib.h>     // atoi(), aligned_alloc(), free()
+#include <string.h>     // strcmp(), memcpy()
+#include <ctype.h>      // isdigit()
+#include <pthread.h>    // pthreads
+#include <immintrin.h>  // AVX intrinsics
+#include <time.h>       // clock_gettime()
+
+#define MAX_OPERATIONS 1000000   // Size of the benchmark input
+#define RECORDS_ALIGN 32         // Alignment of the records buffer (one AVX register)
+#define INITIAL_CAPACITY 1024    // First records allocation of a context
+#define NUM_GAME_THREADS 8       // Threads scoring independent games
+#define GAMES_PER_THREAD 500     // Games scored by each of those threads
+#define MAX_GAME_OPS 4000        // Longest generated game
+
+typedef struct {
+    int *records;   // Pointer to scores array
+    int start, end; // Range of elements to sum
+    int result;     // Partial sum result
+} ThreadData;
+
+// Everything one scoring call needs; nothing is shared between contexts.
+typedef struct {
+    // Records
+    int *records;            // 32-byte-aligned records buffer
+    int index;               // Records in use
+    int capacity;            // Records allocated
+    int reallocations;       // Times the buffer grew (for reuse statistics)
+
+    // Worker configuration
+    int numThreads;          // Threads for the parallel sum
+    int parallelThreshold;   // Below this many records the sum is single-threaded
+
+    // Scratch space for the workers
+    pthread_t *threads;
+    ThreadData *data;
+} ScoreContext;
+
+int scoreContextInit(ScoreContext *ctx, int numThreads, int parallelThreshold) {
+    ctx->records = aligned_alloc(RECORDS_ALIGN, INITIAL_CAPACITY * sizeof(int));
+    ctx->index = 0;
+    ctx->capacity = INITIAL_CAPACITY;
+    ctx->reallocations = 0;
+    ctx->numThreads = numThreads > 0 ? numThreads : 1;
+    ctx->parallelThreshold = parallelThreshold;
+    ctx->threads = malloc(ctx->numThreads * sizeof(pthread_t));
+    ctx->data = malloc(ctx->numThreads * sizeof(ThreadData));
+
+    if (!ctx->records || !ctx->threads || !ctx->data) {
+        free(ctx->records);
+        free(ctx->threads);
+        free(ctx->data);
+        return -1;
+    }
+    return 0;
+}
+
+// Forgets the records but keeps all buffers for the next game.
+void scoreContextReset(ScoreContext *ctx) {
+    ctx->index = 0;
+}
+
+void scoreContextDestroy(ScoreContext *ctx) {
+    free(ctx->records);
+    free(ctx->threads);
+    free(ctx->data);
+    ctx->records = NULL;
+    ctx->threads = NULL;
+    ctx->data = NULL;
+}
+
+// Makes room for `needed` records. Only called when a game is longer than any
+// game this context has scored before.
+static int scoreContextReserve(ScoreContext *ctx, int needed) {
+    if (needed <= ctx->capacity) return 0;
+
+    int capacity = ctx->capacity;
+    while (capacity < needed) capacity *= 2;
+
+    // aligned_alloc() has no realloc counterpart, so copy the live records
+    int *records = aligned_alloc(RECORDS_ALIGN, (size_t)capacity * sizeof(int));
+    if (!records) return -1;
+    memcpy(records, ctx->records, ctx->index * sizeof(int));
+    free(ctx->records);
+
+    ctx->records = records;
+    ctx->capacity = capacity;
+    ctx->reallocations++;
+    return 0;
+}
+
+// SIMD-optimized sum using AVX
+void *simdSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    __m256i sumVec = _mm256_setzero_si256();
+    int i;
+
+    for (i = data->start; i + 7 < data->end; i += 8) {
+        __m256i values = _mm256_loadu_si256((__m256i *)&data->records[i]);
+        sumVec = _mm256_add_epi32(sumVec, values);
+    }
+
+    int sumArray[8];
+    _mm256_storeu_si256((__m256i *)sumArray, sumVec);
+    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+              sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
+
+    for (; i < data->end; i++) {
+        sum += data->records[i];
+    }
+
+    data->result = sum;
+    return NULL;
+}
+
+// Reentrant calPoints: all state lives in ctx. Returns the score of the game.
+int calPoints(ScoreContext *ctx, char *ops[], int size) {
+    scoreContextReset(ctx);
+
+    // A game never has more records than ops, so one reserve covers the whole loop
+    if (scoreContextReserve(ctx, size) != 0) {
+        fprintf(stderr, "Out of memory reserving %d records\n", size);
+        return 0;
+    }
+
+    int *records = ctx->records;
+    int index = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+    ctx->index = index;
+
+    if (ctx->numThreads == 1 || index < ctx->parallelThreshold) {
+        ThreadData single = {records, 0, index, 0};
+        simdSum(&single);
+        return single.result;
+    }
+
+    int mid = index / ctx->numThreads;
+    for (int i = 0; i < ctx->numThreads; i++) {
+        ctx->data[i].records = records;
+        ctx->data[i].start = i * mid;
+        ctx->data[i].end = (i == ctx->numThreads - 1) ? index : (i + 1) * mid;
+        pthread_create(&ctx->threads[i], NULL, simdSum, &ctx->data[i]);
+    }
+
+    int totalSum = 0;
+    for (int i = 0; i < ctx->numThreads; i++) {
+        pthread_join(ctx->threads[i], NULL);
+        totalSum += ctx->data[i].result;
+    }
+
+    return totalSum;
+}
+
+// Single-threaded reference with its own records (no static state).
+int calPointsReference(char *ops[], int size) {
+    int *records = malloc((size > 0 ? size : 1) * sizeof(int));
+    int index = 0, sum = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+
+    for (int i = 0; i < index; i++) sum += records[i];
+    free(records);
+    return sum;
+}
+
+// One game-scoring thread: its own context, reused for every game.
+typedef struct {
+    int seed;
+    int mismatches;
+    int capacity;
+    int reallocationsAfterWarmup;
+} GameWorker;
+
+void *scoreGames(void *arg) {
+    GameWorker *w = (GameWorker *)arg;
+    static char *pool[] = {"5", "-2", "10", "C", "D", "+", "7"};
+    char **ops = malloc(MAX_GAME_OPS * sizeof(char *));
+    unsigned seed = (unsigned)w->seed;
+    ScoreContext ctx;
+
+    scoreContextInit(&ctx, 1, 500);
+
+    // Warm-up: the longest game sizes the context once
+    for (int i = 0; i < MAX_GAME_OPS; i++) ops[i] = pool[rand_r(&seed) % 7];
+    calPoints(&ctx, ops, MAX_GAME_OPS);
+    int warmReallocations = ctx.reallocations;
+
+    for (int g = 0; g < GAMES_PER_THREAD; g++) {
+        int size = 1 + rand_r(&seed) % MAX_GAME_OPS;
+        for (int i = 0; i < size; i++) ops[i] = pool[rand_r(&seed) % 7];
+        if (calPoints(&ctx, ops, size) != calPointsReference(ops, size)) w->mismatches++;
+    }
+
+    w->capacity = ctx.capacity;
+    w->reallocationsAfterWarmup = ctx.reallocations - warmReallocations;
+    scoreContextDestroy(&ctx);
+    free(ops);
+    return NULL;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    ScoreContext ctx;
+    if (scoreContextInit(&ctx, 2, 500) != 0) {
+        fprintf(stderr, "Could not create scoring context\n");
+        return EXIT_FAILURE;
+    }
+
+    char *testCases[][8] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int sizes[] = {5, 8, 1, 1, 2, 5, 6};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("Test %lu: %d\n", i + 1, calPoints(&ctx, testCases[i], sizes[i]));
+    }
+
+    // Many games at once, one context per scoring thread
+    pthread_t gameThreads[NUM_GAME_THREADS];
+    GameWorker workers[NUM_GAME_THREADS];
+    double start = nowMs();
+    for (int t = 0; t < NUM_GAME_THREADS; t++) {
+        workers[t] = (GameWorker){ .seed = 1000 + t };
+        pthread_create(&gameThreads[t], NULL, scoreGames, &workers[t]);
+    }
+    int mismatches = 0, reallocations = 0;
+    for (int t = 0; t < NUM_GAME_THREADS; t++) {
+        pthread_join(gameThreads[t], NULL);
+        mismatches += workers[t].mismatches;
+        reallocations += workers[t].reallocationsAfterWarmup;
+    }
+    double end = nowMs();
+    printf("Concurrent scoring: %d threads x %d games, %.3f ms, mismatches: %d\n",
+           NUM_GAME_THREADS, GAMES_PER_THREAD, end - start, mismatches);
+    printf("Context reuse: %d records capacity, %d reallocations after warm-up\n",
+           workers[0].capacity, reallocations);
+
+    // One long game through the context's parallel sum
+    static char *largeOps[MAX_OPERATIONS];
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+    start = nowMs();
+    int result = calPoints(&ctx, largeOps, MAX_OPERATIONS);
+    end = nowMs();
+    printf("Context (%d workers): %.3f ms, Result: %d\n", ctx.numThreads, end - start, result);
+
+    scoreContextDestroy(&ctx);
+    return (mismatches == 0 && result == 15000000) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,460 @@
+/*
+ * Persistent Worker Thread Pool: Lock-free Task Queue and Futex Completion Latch
+
+   Why a Persistent Pool?
+
+   Every multi-threaded calPoints (3, 4, 5, 6, 7, 8, 10, 11, 12) calls pthread_create() and
+   pthread_join() for every scoring call. File 8's "Synchronization Overhead" output shows that
+   this costs about as much as the 1M-element summation itself. Scoring the same kind of input
+   over and over pays thread creation every time.
+
+   This program creates a pool of pinned workers once and hands work to them as tasks:
+
+   - Task queue:  a bounded lock-free MPMC ring (per-slot sequence numbers, one CAS per
+                  enqueue/dequeue). Any thread can submit, any worker can take.
+   - Idle workers: spin briefly, then sleep on a futex "event count" that every submit bumps.
+                  Submitters only make the wake-up syscall when a worker is actually asleep.
+   - Completion:  a CompletionLatch is an atomic counter of outstanding tasks. The caller spins
+                  briefly and then futex-waits on it; the worker that finishes the last task
+                  wakes it.
+   - Pinning:     worker i is bound to the i-th CPU this process is allowed to run on
+                  (sched_getaffinity), not blindly to CPU i.
+   - Spinning is disabled when there are not more allowed CPUs than workers, because a
+     spinning waiter would then hold the CPU the awaited thread needs.
+
+   simdSum is no longer a pthread entry point; it is a task function:
+
+       void simdSumTask(void *arg);   // arg = ThreadData *
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (expected 15,000,000), scored SCORE_RUNS times with
+     pthread_create/join per call and with the pool.
+   - DISPATCH_ROUNDS rounds of empty tasks to measure pure dispatch latency.
+
+   Expected Output
+   ---------------
+   Pool: 2 workers pinned to CPUs 0 1
+   pthread_create/join per call: [time_ms] ms for 100 calls, Result: 15000000
+   Persistent pool: [time_ms] ms for 100 calls, Result: 15000000
+   Dispatch latency (2 empty tasks): pthread_create/join [us] us, pool [us] us
+
+   gcc -mavx2 -pthread -O3 20.baseball_persistent_thread_pool_lockfree_queue_futex.c -o baseball_pool
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>         // printf()
+#include <stdlib.h>        // atoi(), malloc()
+#include <string.h>        // strcmp()
+#include <ctype.h>         // isdigit()
+#include <stdint.h>        // uint32_t
+#include <stdatomic.h>     // C11 atomics for the queue and latches
+#include <pthread.h>       // worker threads
+#include <sched.h>         // CPU affinity, sched_yield()
+#include <immintrin.h>     // AVX intrinsics, _mm_pause()
+#include <unistd.h>        // syscall()
+#include <sys/syscall.h>   // SYS_futex
+#include <linux/futex.h>   // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <limits.h>        // INT_MAX
+#include <time.h>          // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define NUM_THREADS 2            // Workers in the pool / tasks per sum
+#define QUEUE_CAPACITY 1024      // Task ring size (power of two)
+#define SPIN_ITERATIONS 2000     // Busy-wait before sleeping on a futex
+#define SCORE_RUNS 100           // Repeated scoring calls in the benchmark
+#define DISPATCH_ROUNDS 10000    // Empty-task rounds for the latency measurement
+
+typedef struct {
+    int *records;      // Pointer to scores array
+    int start, end;    // Indices for partial sum calculation
+    int result;        // Partial sum result for each task
+} ThreadData;
+
+// Outstanding-task counter that a caller can sleep on.
+typedef struct {
+    atomic_int remaining;
+} CompletionLatch;
+
+typedef struct {
+    void (*fn)(void *);      // Task function
+    void *arg;               // Its argument
+    CompletionLatch *latch;  // Counted down when the task finishes (may be NULL)
+} Task;
+
+// One slot of the bounded MPMC ring.
+typedef struct {
+    atomic_size_t sequence;
+    Task task;
+} QueueSlot;
+
+typedef struct {
+    QueueSlot slots[QUEUE_CAPACITY];
+    _Alignas(64) atomic_size_t head;   // Next slot to dequeue (own cache line)
+    _Alignas(64) atomic_size_t tail;   // Next slot to enqueue (own cache line)
+} TaskQueue;
+
+typedef struct {
+    TaskQueue queue;
+    _Alignas(64) atomic_int workSignal;  // Event count bumped by every submit
+    atomic_int sleepers;                 // Workers blocked in futex wait
+    atomic_int shutdown;
+    int numWorkers;
+    int spinIterations;                  // 0 when workers and callers share CPUs
+    int cpus[NUM_THREADS];               // CPU each worker is pinned to
+    pthread_t threads[NUM_THREADS];
+} ThreadPool;
+
+static long futexWait(atomic_int *addr, int expected) {
+    return syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static long futexWake(atomic_int *addr, int count) {
+    return syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+void queueInit(TaskQueue *q) {
+    for (size_t i = 0; i < QUEUE_CAPACITY; i++) {
+        atomic_store_explicit(&q->slots[i].sequence, i, memory_order_relaxed);
+    }
+    atomic_store(&q->head, 0);
+    atomic_store(&q->tail, 0);
+}
+
+// Returns 1 on success, 0 if the ring is full.
+int queuePush(TaskQueue *q, Task task) {
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    for (;;) {
+        QueueSlot *slot = &q->slots[pos & (QUEUE_CAPACITY - 1)];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                slot->task = task;
+                atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;  // Full
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+}
+
+// Returns 1 and fills *task on success, 0 if the ring is empty.
+int queuePop(TaskQueue *q, Task *task) {
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    for (;;) {
+        QueueSlot *slot = &q->slots[pos & (QUEUE_CAPACITY - 1)];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *task = slot->task;
+                atomic_store_explicit(&slot->sequence, pos + QUEUE_CAPACITY, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;  // Empty
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+}
+
+void latchInit(CompletionLatch *latch, int count) {
+    atomic_store(&latch->remaining, count);
+}
+
+void latchCountDown(CompletionLatch *latch) {
+    if (atomic_fetch_sub_explicit(&latch->remaining, 1, memory_order_acq_rel) == 1) {
+        futexWake(&latch->remaining, INT_MAX);
+    }
+}
+
+// Spins first (short tasks finish within microseconds), then sleeps.
+void latchWait(CompletionLatch *latch, int spinIterations) {
+    for (int spin = 0; spin < spinIterations; spin++) {
+        if (atomic_load_explicit(&latch->remaining, memory_order_acquire) == 0) return;
+        _mm_pause();
+    }
+    int remaining;
+    while ((remaining = atomic_load_explicit(&latch->remaining, memory_order_acquire)) != 0) {
+        futexWait(&latch->remaining, remaining);
+    }
+}
+
+// Binds the calling thread to one CPU.
+void pinToCPU(int cpu) {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+}
+
+typedef struct {
+    ThreadPool *pool;
+    int id;
+} WorkerArg;
+
+void *workerMain(void *arg) {
+    WorkerArg *w = (WorkerArg *)arg;
+    ThreadPool *pool = w->pool;
+    pinToCPU(pool->cpus[w->id]);
+    free(w);
+
+    Task task;
+    while (!atomic_load_explicit(&pool->shutdown, memory_order_acquire)) {
+        // Read the event count before checking the queue, so a submit that
+        // lands in between makes the futex wait return immediately.
+        int signal = atomic_load_explicit(&pool->workSignal, memory_order_acquire);
+
+        if (queuePop(&pool->queue, &task)) {
+            task.fn(task.arg);
+            if (task.latch) latchCountDown(task.latch);
+            continue;
+        }
+
+        int found = 0;
+        for (int spin = 0; spin < pool->spinIterations && !found; spin++) {
+            _mm_pause();
+            found = atomic_load_explicit(&pool->workSignal, memory_order_acquire) != signal;
+        }
+        if (found) continue;
+
+        atomic_fetch_add(&pool->sleepers, 1);
+        futexWait(&pool->workSignal, signal);
+        atomic_fetch_sub(&pool->sleepers, 1);
+    }
+    return NULL;
+}
+
+// Creates the workers once; worker i is pinned to the i-th allowed CPU.
+int poolInit(ThreadPool *pool, int numWorkers) {
+    queueInit(&pool->queue);
+    atomic_store(&pool->workSignal, 0);
+    atomic_store(&pool->sleepers, 0);
+    atomic_store(&pool->shutdown, 0);
+    pool->numWorkers = numWorkers;
+
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    int allowedCount = CPU_COUNT(&allowed);
+
+    // Spinning only pays off when every worker and the caller have a CPU of
+    // their own; otherwise it steals the time slice of the thread it waits for.
+    pool->spinIterations = (allowedCount > numWorkers) ? SPIN_ITERATIONS : 0;
+
+    for (int i = 0; i < numWorkers; i++) {
+        int nth = i % allowedCount, cpu = 0;
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed) && nth-- == 0) { cpu = c; break; }
+        }
+        pool->cpus[i] = cpu;
+
+        WorkerArg *w = malloc(sizeof(WorkerArg));
+        w->pool = pool;
+        w->id = i;
+        if (pthread_create(&pool->threads[i], NULL, workerMain, w) != 0) {
+            free(w);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void poolSubmit(ThreadPool *pool, void (*fn)(void *), void *arg, CompletionLatch *latch) {
+    Task task = {fn, arg, latch};
+    while (!queuePush(&pool->queue, task)) sched_yield();  // Ring full: let workers drain it
+
+    // Sequentially consistent pair with the worker's sleepers increment: either
+    // we see the sleeper, or its futex wait sees the new signal value.
+    atomic_fetch_add(&pool->workSignal, 1);
+    if (atomic_load(&pool->sleepers) > 0) {
+        futexWake(&pool->workSignal, 1);
+    }
+}
+
+void poolDestroy(ThreadPool *pool) {
+    atomic_store(&pool->shutdown, 1);
+    atomic_fetch_add(&pool->workSignal, 1);
+    futexWake(&pool->workSignal, INT_MAX);
+    for (int i = 0; i < pool->numWorkers; i++) pthread_join(pool->threads[i], NULL);
+}
+
+// SIMD-optimized sum using AVX, as a pool task
+void simdSumTask(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    __m256i sumVec = _mm256_setzero_si256();
+    int i;
+
+    for (i = data->start; i + 7 < data->end; i += 8) {
+        __m256i values = _mm256_loadu_si256((__m256i *)&data->records[i]);
+        sumVec = _mm256_add_epi32(sumVec, values);
+    }
+
+    int sumArray[8];
+    _mm256_storeu_si256((__m256i *)sumArray, sumVec);
+    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+              sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
+
+    for (; i < data->end; i++) {
+        sum += data->records[i];
+    }
+
+    data->result = sum;
+}
+
+// Thread entry point wrapper for the pthread_create/join baseline
+void *simdSum(void *arg) {
+    simdSumTask(arg);
+    return NULL;
+}
+
+// Evaluates the ops into records and returns the record count.
+int buildRecords(char *ops[], int size, int *records) {
+    int index = 0;
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+    return index;
+}
+
+// Parallel sum with fresh threads per call (as in files 5-12)
+int sumWithThreads(int *records, int index) {
+    pthread_t threads[NUM_THREADS];
+    ThreadData data[NUM_THREADS];
+    int mid = index / NUM_THREADS;
+
+    for (int i = 0; i < NUM_THREADS; i++) {
+        data[i] = (ThreadData){records, i * mid, (i == NUM_THREADS - 1) ? index : (i + 1) * mid, 0};
+        pthread_create(&threads[i], NULL, simdSum, &data[i]);
+    }
+
+    int totalSum = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        totalSum += data[i].result;
+    }
+    return totalSum;
+}
+
+// Parallel sum as pool tasks
+int sumWithPool(ThreadPool *pool, int *records, int index) {
+    ThreadData data[NUM_THREADS];
+    CompletionLatch latch;
+    int mid = index / NUM_THREADS;
+
+    latchInit(&latch, NUM_THREADS);
+    for (int i = 0; i < NUM_THREADS; i++) {
+        data[i] = (ThreadData){records, i * mid, (i == NUM_THREADS - 1) ? index : (i + 1) * mid, 0};
+        poolSubmit(pool, simdSumTask, &data[i], &latch);
+    }
+    latchWait(&latch, pool->spinIterations);
+
+    int totalSum = 0;
+    for (int i = 0; i < NUM_THREADS; i++) totalSum += data[i].result;
+    return totalSum;
+}
+
+// calPoints with either dispatch strategy for the sum (pool == NULL: pthread_create/join)
+int calPoints(char *ops[], int size, ThreadPool *pool) {
+    static int records[MAX_OPERATIONS];
+    int index = buildRecords(ops, size, records);
+
+    if (index < 500) {
+        ThreadData single = {records, 0, index, 0};
+        simdSumTask(&single);
+        return single.result;
+    }
+    return pool ? sumWithPool(pool, records, index) : sumWithThreads(records, index);
+}
+
+void emptyTask(void *arg) {
+    (void)arg;
+}
+
+void *emptyThread(void *arg) {
+    (void)arg;
+    return NULL;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    static ThreadPool pool;
+
+    if (poolInit(&pool, NUM_THREADS) != 0) {
+        fprintf(stderr, "Could not start the worker pool\n");
+        return EXIT_FAILURE;
+    }
+    printf("Pool: %d workers pinned to CPUs", pool.numWorkers);
+    for (int i = 0; i < pool.numWorkers; i++) printf(" %d", pool.cpus[i]);
+    printf("\n");
+
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+
+    double start = nowMs();
+    int result1 = 0;
+    for (int run = 0; run < SCORE_RUNS; run++) result1 = calPoints(largeOps, MAX_OPERATIONS, NULL);
+    double end = nowMs();
+    printf("pthread_create/join per call: %.3f ms for %d calls, Result: %d\n",
+           end - start, SCORE_RUNS, result1);
+
+    start = nowMs();
+    int result2 = 0;
+    for (int run = 0; run < SCORE_RUNS; run++) result2 = calPoints(largeOps, MAX_OPERATIONS, &pool);
+    end = nowMs();
+    printf("Persistent pool: %.3f ms for %d calls, Result: %d\n", end - start, SCORE_RUNS, result2);
+
+    // Pure dispatch cost: NUM_THREADS empty units of work per round
+    start = nowMs();
+    for (int r = 0; r < DISPATCH_ROUNDS; r++) {
+        pthread_t threads[NUM_THREADS];
+        for (int i = 0; i < NUM_THREADS; i++) pthread_create(&threads[i], NULL, emptyThread, NULL);
+        for (int i = 0; i < NUM_THREADS; i++) pthread_join(threads[i], NULL);
+    }
+    double threadUs = (nowMs() - start) * 1000.0 / DISPATCH_ROUNDS;
+
+    start = nowMs();
+    for (int r = 0; r < DISPATCH_ROUNDS; r++) {
+        CompletionLatch latch;
+        latchInit(&latch, NUM_THREADS);
+        for (int i = 0; i < NUM_THREADS; i++) poolSubmit(&pool, emptyTask, NULL, &latch);
+        latchWait(&latch, pool.spinIterations);
+    }
+    double poolUs = (nowMs() - start) * 1000.0 / DISPATCH_ROUNDS;
+
+    printf("Dispatch latency (%d empty tasks): pthread_create/join %.2f us, pool %.2f us\n",
+           NUM_THREADS, threadUs, poolUs);
+
+    poolDestroy(&pool);
+
+    if (result1 != result2) {
+        fprintf(stderr, "Mismatch between pthread and pool results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,682 @@
+/*
+ * Work-Stealing Scheduler for Chunked Evaluation and Reduction (Chase-Lev Deques)
+
+   Why Work Stealing?
+
+   Every parallel calPoints so far splits the work statically: `mid = index / NUM_THREADS`,
+   one half or quarter per thread. On a loaded host one preempted thread stalls the join,
+   and that straggler decides the latency of the whole call (our p99, since the scorer shares
+   cores with other services).
+
+   This program cuts the work into cache-sized tasks and lets idle threads steal them:
+
+   - Every participant (NUM_WORKERS pool workers + the calling thread) owns a Chase-Lev deque.
+     The owner pushes and takes at the bottom without contention; thieves CAS the top.
+     Deque entries are [begin, end) ranges packed into one 64-bit atomic word.
+   - parallelFor(pool, count, grain, fn, ctx) puts [0, count) into the caller's deque. Whoever
+     holds a range larger than `grain` pushes its right half and keeps splitting the left half
+     (so big ranges are always available to steal), then runs fn(ctx, begin, end).
+   - The caller controls the grain size: smaller grains balance better, larger grains cost
+     less scheduling.
+
+   Both the evaluation and the reduction of 13.baseball_parallel_segment_summary_full_stack_eval.c
+   run on it. Chunks are GRAIN ops each (not NUM_THREADS chunks):
+
+   1. parallelFor over chunks: summarize each chunk (pops, need, survivors as c + a*x1 + b*x2).
+   2. Prefix pass on the caller over the chunk summaries.
+   3. parallelFor over chunks: sum the survivors of each chunk that reach the final stack.
+
+   Straggler Simulation
+   --------------------
+   To show the effect of a preempted thread, the first task of each run sleeps for
+   STRAGGLER_MS. With the static split of file 13 that sleep holds up a quarter of the work;
+   with stealing, the other participants take over the rest of the work meanwhile.
+
+   Input Explained
+   ---------------
+   - The seven test cases from 2.baseball_game_direct_update_sum_store_converted_values.c.
+   - "10", "D" repeated 500,000 times (expected 15,000,000) with several grain sizes.
+   - 1,000,000 random ops cross-checked against the sequential reference.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Static split (straggler): [time_ms] ms, Result: 15000000
+   Work stealing, grain 4096 (straggler): [time_ms] ms, Result: 15000000, steals: [n]
+   ...
+   Random ops cross-check: OK
+
+   gcc -pthread -O3 21.baseball_work_stealing_chase_lev_fine_grained_tasks.c -o baseball_work_stealing
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>         // printf()
+#include <stdlib.h>        // atoi(), malloc(), free()
+#include <string.h>        // strcmp()
+#include <ctype.h>         // isdigit()
+#include <stdint.h>        // int64_t, uint64_t
+#include <stdatomic.h>     // C11 atomics
+#include <pthread.h>       // worker threads
+#include <sched.h>         // sched_yield()
+#include <unistd.h>        // syscall(), usleep()
+#include <sys/syscall.h>   // SYS_futex
+#include <linux/futex.h>   // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <limits.h>        // INT_MAX
+#include <time.h>          // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define NUM_WORKERS 3                 // Pool workers; the caller is participant NUM_WORKERS
+#define NUM_PARTICIPANTS (NUM_WORKERS + 1)
+#define DEQUE_CAPACITY 4096           // Ranges per deque (power of two)
+#define DEFAULT_GRAIN 4096            // Ops per chunk: summaries of 3 x 16 KB stay in L2
+#define STATIC_THREADS 4              // Threads of the static-split baseline
+#define STRAGGLER_MS 20               // Simulated preemption of one task
+#define IDLE_SPINS 64                 // Failed steal rounds before yielding
+
+// ---------------------------------------------------------------------------
+// Chase-Lev work-stealing deque of [begin, end) ranges
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    _Alignas(64) atomic_llong top;                  // Thieves take here
+    _Alignas(64) atomic_llong bottom;               // Owner pushes/takes here
+    atomic_uint_fast64_t buffer[DEQUE_CAPACITY];   // begin << 32 | end
+} Deque;
+
+static inline uint64_t packRange(int begin, int end) {
+    return ((uint64_t)(uint32_t)begin << 32) | (uint32_t)end;
+}
+
+static inline void unpackRange(uint64_t r, int *begin, int *end) {
+    *begin = (int)(r >> 32);
+    *end = (int)(uint32_t)r;
+}
+
+void dequeInit(Deque *d) {
+    atomic_store(&d->top, 0);
+    atomic_store(&d->bottom, 0);
+}
+
+// Owner only. Returns 0 if the deque is full (the caller then keeps the range).
+int dequePush(Deque *d, uint64_t range) {
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - t >= DEQUE_CAPACITY) return 0;
+    atomic_store_explicit(&d->buffer[b & (DEQUE_CAPACITY - 1)], range, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    return 1;
+}
+
+// Owner only. Returns 1 and the newest range, or 0 if empty.
+int dequeTake(Deque *d, uint64_t *range) {
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {  // Empty
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return 0;
+    }
+
+    *range = atomic_load_explicit(&d->buffer[b & (DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (t == b) {  // Last element: race against thieves
+        int won = atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                          memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return 1;
+}
+
+// Any thread. Returns 1 and the oldest range, 0 if empty or lost a race.
+int dequeSteal(Deque *d, uint64_t *range) {
+    long long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (t >= b) return 0;
+    *range = atomic_load_explicit(&d->buffer[t & (DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                   memory_order_seq_cst, memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Work-stealing pool
+// ---------------------------------------------------------------------------
+
+typedef void (*RangeFn)(void *ctx, int begin, int end);
+
+typedef struct {
+    RangeFn fn;
+    void *ctx;
+    int grain;
+    atomic_int remaining;   // Items not processed yet
+} Job;
+
+typedef struct {
+    _Alignas(64) atomic_long steals;  // Successful steals (own cache line)
+} StealCounter;
+
+typedef struct {
+    Deque deques[NUM_PARTICIPANTS];
+    StealCounter stats[NUM_PARTICIPANTS];
+    Job job;
+    _Alignas(64) atomic_int epoch;    // Bumped when a job starts
+    atomic_int busy;                  // Workers currently inside a job
+    atomic_int shutdown;
+    pthread_t threads[NUM_WORKERS];
+} WorkStealingPool;
+
+typedef struct {
+    WorkStealingPool *pool;
+    int id;
+} ParticipantArg;
+
+static long futexWait(atomic_int *addr, int expected) {
+    return syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static long futexWake(atomic_int *addr, int count) {
+    return syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+// Steals from the other participants, starting at a pseudo-random victim.
+static int stealAny(WorkStealingPool *pool, int self, unsigned *seed, uint64_t *range) {
+    *seed = *seed * 1103515245u + 12345u;
+    int first = (int)((*seed >> 16) % NUM_PARTICIPANTS);
+    for (int k = 0; k < NUM_PARTICIPANTS; k++) {
+        int victim = (first + k) % NUM_PARTICIPANTS;
+        if (victim != self && dequeSteal(&pool->deques[victim], range)) {
+            atomic_fetch_add_explicit(&pool->stats[self].steals, 1, memory_order_relaxed);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Runs tasks of the current job until every item has been processed.
+static void workLoop(WorkStealingPool *pool, int self) {
+    Job *job = &pool->job;
+    Deque *own = &pool->deques[self];
+    unsigned seed = 2654435761u * (unsigned)(self + 1);
+    int idle = 0;
+
+    while (atomic_load_explicit(&job->remaining, memory_order_acquire) > 0) {
+        uint64_t range;
+        if (!dequeTake(own, &range) && !stealAny(pool, self, &seed, &range)) {
+            if (++idle >= IDLE_SPINS) {
+                sched_yield();
+                idle = 0;
+            }
+            continue;
+        }
+        idle = 0;
+
+        int begin, end;
+        unpackRange(range, &begin, &end);
+
+        // Split: publish right halves for thieves, keep the left half
+        while (end - begin > job->grain) {
+            int mid = begin + (end - begin) / 2;
+            if (!dequePush(own, packRange(mid, end))) break;
+            end = mid;
+        }
+
+        job->fn(job->ctx, begin, end);
+        atomic_fetch_sub_explicit(&job->remaining, end - begin, memory_order_acq_rel);
+    }
+}
+
+static void *workerMain(void *arg) {
+    ParticipantArg *p = (ParticipantArg *)arg;
+    WorkStealingPool *pool = p->pool;
+    int self = p->id;
+    free(p);
+
+    int seen = 0;
+    for (;;) {
+        int epoch;
+        while ((epoch = atomic_load(&pool->epoch)) == seen && !atomic_load(&pool->shutdown)) {
+            futexWait(&pool->epoch, seen);
+        }
+        if (atomic_load(&pool->shutdown)) break;
+        seen = epoch;
+
+        atomic_fetch_add(&pool->busy, 1);
+        if (atomic_load(&pool->epoch) == seen) workLoop(pool, self);
+        atomic_fetch_sub(&pool->busy, 1);
+    }
+    return NULL;
+}
+
+int poolInit(WorkStealingPool *pool) {
+    for (int i = 0; i < NUM_PARTICIPANTS; i++) {
+        dequeInit(&pool->deques[i]);
+        atomic_store(&pool->stats[i].steals, 0);
+    }
+    atomic_store(&pool->job.remaining, 0);
+    atomic_store(&pool->epoch, 0);
+    atomic_store(&pool->busy, 0);
+    atomic_store(&pool->shutdown, 0);
+
+    for (int i = 0; i < NUM_WORKERS; i++) {
+        ParticipantArg *p = malloc(sizeof(ParticipantArg));
+        p->pool = pool;
+        p->id = i;
+        if (pthread_create(&pool->threads[i], NULL, workerMain, p) != 0) {
+            free(p);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void poolDestroy(WorkStealingPool *pool) {
+    atomic_store(&pool->shutdown, 1);
+    atomic_fetch_add(&pool->epoch, 1);
+    futexWake(&pool->epoch, INT_MAX);
+    for (int i = 0; i < NUM_WORKERS; i++) pthread_join(pool->threads[i], NULL);
+}
+
+long poolSteals(WorkStealingPool *pool) {
+    long total = 0;
+    for (int i = 0; i < NUM_PARTICIPANTS; i++) total += atomic_load(&pool->stats[i].steals);
+    return total;
+}
+
+// Runs fn over [0, count) in ranges of at most `grain` items; the caller participates.
+void parallelFor(WorkStealingPool *pool, int count, int grain, RangeFn fn, void *ctx) {
+    if (count <= 0) return;
+
+    pool->job.fn = fn;
+    pool->job.ctx = ctx;
+    pool->job.grain = grain > 0 ? grain : 1;
+    atomic_store_explicit(&pool->job.remaining, count, memory_order_release);
+    dequePush(&pool->deques[NUM_WORKERS], packRange(0, count));
+
+    atomic_fetch_add(&pool->epoch, 1);
+    futexWake(&pool->epoch, INT_MAX);
+
+    workLoop(pool, NUM_WORKERS);
+
+    // Workers may still be leaving the loop; the next job must not start under them
+    while (atomic_load(&pool->busy) > 0) sched_yield();
+}
+
+// ---------------------------------------------------------------------------
+// Segment-summary evaluation (see file 13), one chunk per task item
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int start, end;       // Operations [start, end) of this chunk
+    int pops;             // Inherited records removed by this chunk
+    int need;             // Minimum inherited depth for which the summary is exact
+    int count;            // Survivors pushed by this chunk
+    unsigned *c, *a, *b;  // Survivor i = c[i] + a[i] * x1 + b[i] * x2
+    int base;             // Stack position of the first survivor
+    unsigned x1, x2;      // Inherited top and second-from-top after the pops
+    int keep;             // Survivors not removed by later chunks
+    unsigned result;      // Sum of the kept survivors
+} ChunkSummary;
+
+typedef struct {
+    char **ops;
+    ChunkSummary *chunks;
+    atomic_int straggler;  // 1: the next task sleeps STRAGGLER_MS
+} EvalJob;
+
+static inline int isNumber(const char *op) {
+    return isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]));
+}
+
+static void maybeStraggle(EvalJob *job) {
+    if (atomic_load_explicit(&job->straggler, memory_order_relaxed) &&
+        atomic_exchange(&job->straggler, 0)) {
+        usleep(STRAGGLER_MS * 1000);
+    }
+}
+
+static void summarizeChunk(char **ops, ChunkSummary *s) {
+    unsigned *c = s->c, *a = s->a, *b = s->b;
+    int n = 0, pops = 0, need = 0;
+
+    for (int i = s->start; i < s->end; i++) {
+        const char *op = ops[i];
+        if (isNumber(op)) {
+            c[n] = (unsigned)atoi(op); a[n] = 0; b[n] = 0;
+            n++;
+        } else if (strcmp(op, "C") == 0) {
+            if (n > 0) {
+                n--;
+            } else {
+                pops++;
+                if (pops > need) need = pops;
+            }
+        } else if (strcmp(op, "D") == 0) {
+            if (n > 0) {
+                c[n] = 2u * c[n - 1]; a[n] = 2u * a[n - 1]; b[n] = 2u * b[n - 1];
+            } else {
+                if (pops + 1 > need) need = pops + 1;
+                c[n] = 0; a[n] = 2; b[n] = 0;
+            }
+            n++;
+        } else if (strcmp(op, "+") == 0) {
+            if (n > 1) {
+                c[n] = c[n - 1] + c[n - 2]; a[n] = a[n - 1] + a[n - 2]; b[n] = b[n - 1] + b[n - 2];
+            } else if (n == 1) {
+                if (pops + 1 > need) need = pops + 1;
+                c[n] = c[0]; a[n] = a[0] + 1; b[n] = b[0];
+            } else {
+                if (pops + 2 > need) need = pops + 2;
+                c[n] = 0; a[n] = 1; b[n] = 1;
+            }
+            n++;
+        }
+    }
+
+    s->pops = pops;
+    s->need = need;
+    s->count = n;
+}
+
+static void summarizeTask(void *ctx, int begin, int end) {
+    EvalJob *job = (EvalJob *)ctx;
+    maybeStraggle(job);
+    for (int k = begin; k < end; k++) summarizeChunk(job->ops, &job->chunks[k]);
+}
+
+static void reduceTask(void *ctx, int begin, int end) {
+    EvalJob *job = (EvalJob *)ctx;
+    maybeStraggle(job);
+    for (int k = begin; k < end; k++) {
+        ChunkSummary *s = &job->chunks[k];
+        unsigned sumC = 0, sumA = 0, sumB = 0;
+        for (int i = 0; i < s->keep; i++) {
+            sumC += s->c[i];
+            sumA += s->a[i];
+            sumB += s->b[i];
+        }
+        s->result = sumC + sumA * s->x1 + sumB * s->x2;
+    }
+}
+
+// Concrete value of stack position q from the chunks before `upto`.
+static unsigned valueAt(ChunkSummary *s, int upto, int q) {
+    for (int j = upto - 1; j >= 0; j--) {
+        if (q >= s[j].base && q < s[j].base + s[j].count) {
+            int i = q - s[j].base;
+            return s[j].c[i] + s[j].a[i] * s[j].x1 + s[j].b[i] * s[j].x2;
+        }
+    }
+    return 0;
+}
+
+// Replays chunk k on the real inherited stack when it is shallower than `need`.
+static void replayChunk(char **ops, ChunkSummary *s, int k, int depth) {
+    ChunkSummary *ck = &s[k];
+    unsigned *stack = malloc((depth + (ck->end - ck->start) + 1) * sizeof(unsigned));
+    int index = 0;
+
+    for (int q = 0; q < depth; q++) stack[index++] = valueAt(s, k, q);
+
+    for (int i = ck->start; i < ck->end; i++) {
+        const char *op = ops[i];
+        if (isNumber(op)) {
+            stack[index++] = (unsigned)atoi(op);
+        } else if (strcmp(op, "C") == 0) {
+            if (index > 0) index--;
+        } else if (strcmp(op, "D") == 0) {
+            if (index > 0) { stack[index] = 2u * stack[index - 1]; index++; }
+        } else if (strcmp(op, "+") == 0) {
+            if (index > 1) { stack[index] = stack[index - 1] + stack[index - 2]; index++; }
+        }
+    }
+
+    free(ck->c); free(ck->a); free(ck->b);
+    ck->c = stack;
+    ck->a = calloc(index + 1, sizeof(unsigned));
+    ck->b = calloc(index + 1, sizeof(unsigned));
+    ck->pops = depth;
+    ck->need = 0;
+    ck->count = index;
+    ck->x1 = ck->x2 = 0;
+}
+
+// Work-stealing calPoints: `grain` ops per chunk task.
+int calPoints(WorkStealingPool *pool, char *ops[], int size, int grain, int straggler) {
+    int numChunks = (size + grain - 1) / grain;
+    if (numChunks == 0) return 0;
+
+    EvalJob job;
+    job.ops = ops;
+    job.chunks = malloc(numChunks * sizeof(ChunkSummary));
+    atomic_store(&job.straggler, straggler);
+
+    for (int k = 0; k < numChunks; k++) {
+        ChunkSummary *s = &job.chunks[k];
+        s->start = k * grain;
+        s->end = (k == numChunks - 1) ? size : (k + 1) * grain;
+        int len = s->end - s->start;
+        s->c = malloc(len * sizeof(unsigned));
+        s->a = malloc(len * sizeof(unsigned));
+        s->b = malloc(len * sizeof(unsigned));
+    }
+
+    // Phase 1: summaries, one chunk per item
+    parallelFor(pool, numChunks, 1, summarizeTask, &job);
+
+    // Phase 2: prefix pass over the summaries
+    ChunkSummary *s = job.chunks;
+    int depth = 0;
+    for (int k = 0; k < numChunks; k++) {
+        if (depth < s[k].need) {
+            replayChunk(ops, s, k, depth);
+        } else {
+            int top = depth - s[k].pops;
+            s[k].x1 = (top >= 1) ? valueAt(s, k, top - 1) : 0;
+            s[k].x2 = (top >= 2) ? valueAt(s, k, top - 2) : 0;
+        }
+        s[k].base = depth - s[k].pops;
+        depth = s[k].base + s[k].count;
+    }
+
+    int limit = depth;
+    for (int k = numChunks - 1; k >= 0; k--) {
+        int keep = limit - s[k].base;
+        if (keep < 0) keep = 0;
+        if (keep > s[k].count) keep = s[k].count;
+        s[k].keep = keep;
+        if (s[k].base < limit) limit = s[k].base;
+    }
+
+    // Phase 3: reduction, one chunk per item
+    atomic_store(&job.straggler, straggler);
+    parallelFor(pool, numChunks, 1, reduceTask, &job);
+
+    unsigned totalSum = 0;
+    for (int k = 0; k < numChunks; k++) {
+        totalSum += s[k].result;
+        free(s[k].c); free(s[k].a); free(s[k].b);
+    }
+    free(job.chunks);
+    return (int)totalSum;
+}
+
+// ---------------------------------------------------------------------------
+// Static-split baseline: STATIC_THREADS chunks with fresh threads (file 13)
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    EvalJob *job;
+    int chunk;
+    void (*fn)(void *, int, int);
+} StaticArg;
+
+static void *staticThread(void *arg) {
+    StaticArg *s = (StaticArg *)arg;
+    s->fn(s->job, s->chunk, s->chunk + 1);
+    return NULL;
+}
+
+int calPointsStatic(char *ops[], int size, int straggler) {
+    int chunk = size / STATIC_THREADS;
+    EvalJob job;
+    job.ops = ops;
+    job.chunks = malloc(STATIC_THREADS * sizeof(ChunkSummary));
+    pthread_t threads[STATIC_THREADS];
+    StaticArg args[STATIC_THREADS];
+
+    for (int k = 0; k < STATIC_THREADS; k++) {
+        ChunkSummary *s = &job.chunks[k];
+        s->start = k * chunk;
+        s->end = (k == STATIC_THREADS - 1) ? size : (k + 1) * chunk;
+        int len = s->end - s->start;
+        s->c = malloc((len + 1) * sizeof(unsigned));
+        s->a = malloc((len + 1) * sizeof(unsigned));
+        s->b = malloc((len + 1) * sizeof(unsigned));
+    }
+
+    atomic_store(&job.straggler, straggler);
+    for (int k = 0; k < STATIC_THREADS; k++) {
+        args[k] = (StaticArg){&job, k, summarizeTask};
+        pthread_create(&threads[k], NULL, staticThread, &args[k]);
+    }
+    for (int k = 0; k < STATIC_THREADS; k++) pthread_join(threads[k], NULL);
+
+    ChunkSummary *s = job.chunks;
+    int depth = 0;
+    for (int k = 0; k < STATIC_THREADS; k++) {
+        if (depth < s[k].need) {
+            replayChunk(ops, s, k, depth);
+        } else {
+            int top = depth - s[k].pops;
+            s[k].x1 = (top >= 1) ? valueAt(s, k, top - 1) : 0;
+            s[k].x2 = (top >= 2) ? valueAt(s, k, top - 2) : 0;
+        }
+        s[k].base = depth - s[k].pops;
+        depth = s[k].base + s[k].count;
+    }
+    int limit = depth;
+    for (int k = STATIC_THREADS - 1; k >= 0; k--) {
+        int keep = limit - s[k].base;
+        if (keep < 0) keep = 0;
+        if (keep > s[k].count) keep = s[k].count;
+        s[k].keep = keep;
+        if (s[k].base < limit) limit = s[k].base;
+    }
+
+    atomic_store(&job.straggler, straggler);
+    for (int k = 0; k < STATIC_THREADS; k++) {
+        args[k] = (StaticArg){&job, k, reduceTask};
+        pthread_create(&threads[k], NULL, staticThread, &args[k]);
+    }
+    unsigned totalSum = 0;
+    for (int k = 0; k < STATIC_THREADS; k++) {
+        pthread_join(threads[k], NULL);
+        totalSum += s[k].result;
+        free(s[k].c); free(s[k].a); free(s[k].b);
+    }
+    free(job.chunks);
+    return (int)totalSum;
+}
+
+// Sequential reference (same rules as 1.baseball_game.c)
+int calPointsSequential(char *ops[], int size) {
+    static int records[MAX_OPERATIONS];
+    int index = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isNumber(ops[i])) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0) {
+            if (index > 0) index--;
+        } else if (strcmp(ops[i], "D") == 0) {
+            if (index > 0) { records[index] = (int)(2u * (unsigned)records[index - 1]); index++; }
+        } else if (strcmp(ops[i], "+") == 0) {
+            if (index > 1) {
+                records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+                index++;
+            }
+        }
+    }
+
+    unsigned result = 0;
+    for (int i = 0; i < index; i++) result += (unsigned)records[i];
+    return (int)result;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    static WorkStealingPool pool;
+
+    if (poolInit(&pool) != 0) {
+        fprintf(stderr, "Could not start the work-stealing pool\n");
+        return EXIT_FAILURE;
+    }
+
+    char *testCases[][8] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int sizes[] = {5, 8, 1, 1, 2, 5, 6};
+
+    // Grain 2 splits even the small games into several chunks
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("Test %lu: %d\n", i + 1, calPoints(&pool, testCases[i], sizes[i], 2, 0));
+    }
+
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+    int expected = calPointsSequential(largeOps, MAX_OPERATIONS);
+    int failed = 0;
+
+    double start = nowMs();
+    int result = calPointsStatic(largeOps, MAX_OPERATIONS, 1);
+    printf("Static split (straggler): %.3f ms, Result: %d\n", nowMs() - start, result);
+    failed |= (result != expected);
+
+    int grains[] = {1024, DEFAULT_GRAIN, 16384, 65536};
+    for (size_t g = 0; g < sizeof(grains) / sizeof(grains[0]); g++) {
+        long stealsBefore = poolSteals(&pool);
+        start = nowMs();
+        result = calPoints(&pool, largeOps, MAX_OPERATIONS, grains[g], 1);
+        printf("Work stealing, grain %d (straggler): %.3f ms, Result: %d, steals: %ld\n",
+               grains[g], nowMs() - start, result, poolSteals(&pool) - stealsBefore);
+        failed |= (result != expected);
+    }
+
+    // Random ops: pops across chunk boundaries and shallow-stack replays
+    static char *opPool[] = {"C", "D", "+", "1", "-3", "7", "12", "-40", "100"};
+    srand(7);
+    for (int round = 0; round < 10; round++) {
+        int cWeight = round;
+        for (int i = 0; i < MAX_OPERATIONS; i++) {
+            int r = rand() % (9 + cWeight);
+            largeOps[i] = (r >= 9) ? "C" : opPool[r];
+        }
+        if (calPoints(&pool, largeOps, MAX_OPERATIONS, 1000 + 997 * round, 0) !=
+            calPointsSequential(largeOps, MAX_OPERATIONS)) {
+            failed = 1;
+        }
+    }
+    printf("Random ops cross-check: %s\n", failed ? "FAILED" : "OK");
+
+    poolDestroy(&pool);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
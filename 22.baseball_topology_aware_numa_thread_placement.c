@@ -0,0 +1,402 @@
+/*
+ * Topology-Aware Thread Placement: Mapping NUMA Nodes to CPUs (Compact, Scatter, One per Node)
+
+   Why a Placement Layer?
+
+   bindThreadToNUMANode(node) in files 10, 11 and 12 used to call CPU_SET(node, ...), which pins
+   thread N to CPU N, not to a CPU on NUMA node N. "NUMA-aware" runs therefore landed on CPUs 0-3
+   wherever the memory was. On a dual-socket host CPUs 0-3 are all on socket 0, so half the
+   workers summed records that live on the other socket.
+
+   This program builds the CPU topology once and places workers from it:
+
+   - Topology:  libnuma gives the CPUs of every node (numa_node_to_cpus). The package and core
+                of every CPU come from /sys/devices/system/cpu/cpuN/topology, so SMT siblings
+                are recognised. Only CPUs in this process's affinity mask are used.
+   - Policies:  PLACE_COMPACT       fill node 0 core by core (siblings next to each other),
+                                    then node 1, ... (shares caches, one memory controller)
+                PLACE_SCATTER       one CPU per node in turn, distinct cores before siblings
+                                    (uses every memory controller)
+                PLACE_ONE_PER_NODE  worker w is bound to all CPUs of node w % nodes
+   - Slices:    when the node of each worker's slice of records is known, the worker is bound
+                to a CPU on that node (policy order is kept among the node's CPUs). The node of
+                a slice is read back from the kernel (numa_move_pages in query mode), not
+                assumed.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (expected 15,000,000). The records buffer is split into
+     NUM_WORKERS page-aligned slices and slice w is placed on node w * nodes / NUM_WORKERS.
+   - Each worker reports the CPU it ran on, and its node is compared with its slice's node.
+
+   Expected Output
+   ---------------
+   Topology: [n] allowed CPUs on [m] nodes
+     node 0: CPUs 0 1 ...
+   Legacy CPU_SET(node) binding: [time_ms] ms, Result: 15000000, remote slices: [k]/4
+   Compact: [time_ms] ms, Result: 15000000, remote slices: 0/4, CPUs: ...
+   Scatter: [time_ms] ms, Result: 15000000, remote slices: 0/4, CPUs: ...
+   One per node: [time_ms] ms, Result: 15000000, remote slices: 0/4, CPUs: ...
+
+   gcc -mavx2 -pthread -O3 22.baseball_topology_aware_numa_thread_placement.c -lnuma -o baseball_placement
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>       // printf(), fopen()
+#include <stdlib.h>      // atoi(), qsort()
+#include <string.h>      // strcmp(), memcpy()
+#include <stdint.h>      // uintptr_t
+#include <ctype.h>       // isdigit()
+#include <pthread.h>     // pthreads
+#include <sched.h>       // cpu_set_t, sched_getaffinity(), sched_getcpu()
+#include <immintrin.h>   // AVX intrinsics
+#include <numa.h>        // numa_node_to_cpus(), numa_alloc(), numa_move_pages()
+#include <unistd.h>      // sysconf()
+#include <time.h>        // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define NUM_WORKERS 4
+#define MAX_CPUS 1024
+
+typedef enum {
+    PLACE_COMPACT,
+    PLACE_SCATTER,
+    PLACE_ONE_PER_NODE
+} PlacementPolicy;
+
+typedef struct {
+    int cpu;       // Logical CPU number
+    int node;      // NUMA node (numa_node_to_cpus)
+    int package;   // physical_package_id
+    int core;      // core_id within the package
+    int coreRank;  // Index of this CPU's core within its node
+    int smtRank;   // 0 for the first hardware thread of a core, 1 for its sibling, ...
+} CpuInfo;
+
+typedef struct {
+    CpuInfo cpus[MAX_CPUS];   // Allowed CPUs only
+    int numCpus;
+    int numNodes;             // numa_max_node() + 1
+} Topology;
+
+typedef struct {
+    cpu_set_t cpuset;  // CPUs the worker may run on
+    int node;          // Node those CPUs belong to
+} WorkerPlacement;
+
+typedef struct {
+    int *records;
+    int start, end;
+    int result;
+    const cpu_set_t *cpuset;  // NULL: legacy binding to CPU `legacyCpu`
+    int legacyCpu;
+    int ranOnCpu;             // sched_getcpu() after binding
+} ThreadData;
+
+// Reads one integer from a sysfs file; returns -1 if it is missing.
+static int readSysInt(const char *path) {
+    FILE *f = fopen(path, "r");
+    int value = -1;
+    if (f) {
+        if (fscanf(f, "%d", &value) != 1) value = -1;
+        fclose(f);
+    }
+    return value;
+}
+
+static int compareCompact(const void *pa, const void *pb) {
+    const CpuInfo *a = pa, *b = pb;
+    if (a->node != b->node) return a->node - b->node;
+    if (a->coreRank != b->coreRank) return a->coreRank - b->coreRank;
+    return a->smtRank - b->smtRank;
+}
+
+static int compareScatter(const void *pa, const void *pb) {
+    const CpuInfo *a = pa, *b = pb;
+    if (a->smtRank != b->smtRank) return a->smtRank - b->smtRank;
+    if (a->coreRank != b->coreRank) return a->coreRank - b->coreRank;
+    return a->node - b->node;
+}
+
+// Builds the topology of the CPUs this process may run on.
+int topologyInit(Topology *t) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return -1;
+
+    t->numCpus = 0;
+    t->numNodes = numa_max_node() + 1;
+    struct bitmask *nodeCpus = numa_allocate_cpumask();
+
+    for (int node = 0; node < t->numNodes; node++) {
+        if (numa_node_to_cpus(node, nodeCpus) != 0) continue;
+
+        for (unsigned cpu = 0; cpu < nodeCpus->size && cpu < CPU_SETSIZE; cpu++) {
+            if (!numa_bitmask_isbitset(nodeCpus, cpu) || !CPU_ISSET(cpu, &allowed)) continue;
+            if (t->numCpus == MAX_CPUS) break;
+
+            char path[128];
+            CpuInfo *c = &t->cpus[t->numCpus++];
+            c->cpu = (int)cpu;
+            c->node = node;
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+            c->package = readSysInt(path);
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu);
+            c->core = readSysInt(path);
+            if (c->core < 0) c->core = (int)cpu;  // No topology info: every CPU is its own core
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+
+    // Rank cores within their node and hardware threads within their core
+    for (int i = 0; i < t->numCpus; i++) {
+        CpuInfo *c = &t->cpus[i];
+        c->coreRank = 0;
+        c->smtRank = 0;
+        for (int j = 0; j < i; j++) {
+            CpuInfo *p = &t->cpus[j];
+            if (p->node != c->node) continue;
+            if (p->package == c->package && p->core == c->core) {
+                c->smtRank++;
+                c->coreRank = p->coreRank;
+            }
+        }
+        if (c->smtRank == 0) {
+            for (int j = 0; j < i; j++) {
+                CpuInfo *p = &t->cpus[j];
+                if (p->node == c->node && p->smtRank == 0) c->coreRank++;
+            }
+        }
+    }
+    return t->numCpus > 0 ? 0 : -1;
+}
+
+void topologyPrint(const Topology *t) {
+    printf("Topology: %d allowed CPUs on %d nodes\n", t->numCpus, t->numNodes);
+    for (int node = 0; node < t->numNodes; node++) {
+        int any = 0;
+        for (int i = 0; i < t->numCpus; i++) {
+            if (t->cpus[i].node != node) continue;
+            if (!any) printf("  node %d: CPUs", node);
+            printf(" %d", t->cpus[i].cpu);
+            any = 1;
+        }
+        if (any) printf("\n");
+    }
+}
+
+// Places numWorkers workers. sliceNodes[w] (may be NULL) is the node holding
+// worker w's records; the worker then gets a CPU on that node if it has one.
+int placeWorkers(const Topology *t, PlacementPolicy policy, const int *sliceNodes,
+                 int numWorkers, WorkerPlacement *out) {
+    static CpuInfo order[MAX_CPUS];
+    int used[MAX_CPUS] = {0};
+
+    memcpy(order, t->cpus, t->numCpus * sizeof(CpuInfo));
+    qsort(order, t->numCpus, sizeof(CpuInfo),
+          policy == PLACE_SCATTER ? compareScatter : compareCompact);
+
+    for (int w = 0; w < numWorkers; w++) {
+        WorkerPlacement *p = &out[w];
+        CPU_ZERO(&p->cpuset);
+
+        if (policy == PLACE_ONE_PER_NODE) {
+            int node = sliceNodes ? sliceNodes[w] : w % t->numNodes;
+            for (int i = 0; i < t->numCpus; i++) {
+                if (order[i].node == node) CPU_SET(order[i].cpu, &p->cpuset);
+            }
+            if (CPU_COUNT(&p->cpuset) == 0) {  // Memory-only node: fall back to any CPU
+                node = order[w % t->numCpus].node;
+                for (int i = 0; i < t->numCpus; i++) {
+                    if (order[i].node == node) CPU_SET(order[i].cpu, &p->cpuset);
+                }
+            }
+            p->node = node;
+            continue;
+        }
+
+        // Next unused CPU in policy order, restricted to the slice's node if it has CPUs
+        int pick = -1;
+        for (int pass = 0; pass < 2 && pick < 0; pass++) {
+            for (int i = 0; i < t->numCpus && pick < 0; i++) {
+                if (sliceNodes && order[i].node != sliceNodes[w]) continue;
+                if (pass == 0 && used[i]) continue;
+                pick = i;
+            }
+            if (pass == 1 && pick < 0 && sliceNodes) {
+                // The slice's node has no allowed CPU: use the policy order
+                for (int i = 0; i < t->numCpus && pick < 0; i++) {
+                    if (!used[i]) pick = i;
+                }
+                if (pick < 0) pick = w % t->numCpus;
+            }
+        }
+        used[pick] = 1;
+        CPU_SET(order[pick].cpu, &p->cpuset);
+        p->node = order[pick].node;
+    }
+    return 0;
+}
+
+// Node that actually backs the page at addr (-1 if it is not resident).
+int nodeOfAddress(void *addr) {
+    void *page = (void *)((uintptr_t)addr & ~((uintptr_t)sysconf(_SC_PAGESIZE) - 1));
+    int status = -1;
+    if (numa_move_pages(0, 1, &page, NULL, &status, 0) != 0) return -1;
+    return status;
+}
+
+// SIMD-optimized sum using AVX, run on the worker's placement
+void *placedSimdSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+
+    cpu_set_t legacy;
+    if (!data->cpuset) {
+        // What files 10-12 used to do: "node" i == CPU i
+        CPU_ZERO(&legacy);
+        CPU_SET(data->legacyCpu, &legacy);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &legacy);
+    } else {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), data->cpuset);
+    }
+    data->ranOnCpu = sched_getcpu();
+
+    __m256i sumVec = _mm256_setzero_si256();
+    int i;
+
+    for (i = data->start; i + 7 < data->end; i += 8) {
+        __m256i values = _mm256_loadu_si256((__m256i *)&data->records[i]);
+        sumVec = _mm256_add_epi32(sumVec, values);
+    }
+
+    int sumArray[8];
+    _mm256_storeu_si256((__m256i *)sumArray, sumVec);
+    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+              sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
+
+    for (; i < data->end; i++) {
+        sum += data->records[i];
+    }
+
+    data->result = sum;
+    return NULL;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Sums the slices with one thread per placement (placements == NULL: legacy binding).
+int sumPlaced(int *records, const int *bounds, const int *sliceNodes,
+              const WorkerPlacement *placements, const char *label) {
+    pthread_t threads[NUM_WORKERS];
+    ThreadData data[NUM_WORKERS];
+
+    double start = nowMs();
+    for (int w = 0; w < NUM_WORKERS; w++) {
+        data[w] = (ThreadData){records, bounds[w], bounds[w + 1], 0,
+                               placements ? &placements[w].cpuset : NULL, w, -1};
+        pthread_create(&threads[w], NULL, placedSimdSum, &data[w]);
+    }
+
+    int totalSum = 0, remote = 0;
+    for (int w = 0; w < NUM_WORKERS; w++) {
+        pthread_join(threads[w], NULL);
+        totalSum += data[w].result;
+        if (data[w].ranOnCpu < 0 || numa_node_of_cpu(data[w].ranOnCpu) != sliceNodes[w]) remote++;
+    }
+    double end = nowMs();
+
+    printf("%s: %.3f ms, Result: %d, remote slices: %d/%d, CPUs:",
+           label, end - start, totalSum, remote, NUM_WORKERS);
+    for (int w = 0; w < NUM_WORKERS; w++) printf(" %d", data[w].ranOnCpu);
+    printf("\n");
+    return totalSum;
+}
+
+int main() {
+    static Topology topo;
+    static char *ops[MAX_OPERATIONS];
+
+    if (numa_available() == -1) {
+        fprintf(stderr, "NUMA is not available on this system\n");
+        return EXIT_FAILURE;
+    }
+    if (topologyInit(&topo) != 0) {
+        fprintf(stderr, "Could not read the CPU topology\n");
+        return EXIT_FAILURE;
+    }
+    topologyPrint(&topo);
+
+    for (int i = 0; i < 500000; i++) {
+        ops[i * 2] = "10";
+        ops[i * 2 + 1] = "D";
+    }
+
+    // Page-aligned slices, slice w bound to node w * nodes / NUM_WORKERS before first touch
+    size_t pageInts = sysconf(_SC_PAGESIZE) / sizeof(int);
+    size_t bytes = MAX_OPERATIONS * sizeof(int);
+    int *records = numa_alloc(bytes);
+    int bounds[NUM_WORKERS + 1];
+    for (int w = 0; w <= NUM_WORKERS; w++) {
+        bounds[w] = (int)((size_t)MAX_OPERATIONS / NUM_WORKERS * w / pageInts * pageInts);
+    }
+    bounds[NUM_WORKERS] = MAX_OPERATIONS;
+
+    for (int w = 0; w < NUM_WORKERS; w++) {
+        int node = w * topo.numNodes / NUM_WORKERS;
+        if (numa_bitmask_isbitset(numa_all_nodes_ptr, node)) {
+            numa_tonode_memory(records + bounds[w], (bounds[w + 1] - bounds[w]) * sizeof(int), node);
+        }
+    }
+
+    int index = 0;
+    for (int i = 0; i < MAX_OPERATIONS; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+    bounds[NUM_WORKERS] = index;
+
+    // Where the kernel actually put each slice
+    int sliceNodes[NUM_WORKERS];
+    for (int w = 0; w < NUM_WORKERS; w++) {
+        sliceNodes[w] = nodeOfAddress(records + bounds[w]);
+        if (sliceNodes[w] < 0) sliceNodes[w] = 0;
+    }
+
+    WorkerPlacement placements[NUM_WORKERS];
+    int results[4];
+
+    // Worker w pinned to CPU w, wherever its slice lives
+    results[0] = sumPlaced(records, bounds, sliceNodes, NULL, "Legacy CPU_SET(node) binding");
+
+    placeWorkers(&topo, PLACE_COMPACT, sliceNodes, NUM_WORKERS, placements);
+    results[1] = sumPlaced(records, bounds, sliceNodes, placements, "Compact");
+
+    placeWorkers(&topo, PLACE_SCATTER, sliceNodes, NUM_WORKERS, placements);
+    results[2] = sumPlaced(records, bounds, sliceNodes, placements, "Scatter");
+
+    placeWorkers(&topo, PLACE_ONE_PER_NODE, sliceNodes, NUM_WORKERS, placements);
+    results[3] = sumPlaced(records, bounds, sliceNodes, placements, "One per node");
+
+    numa_free(records, bytes);
+
+    for (int r = 1; r < 4; r++) {
+        if (results[r] != results[0]) {
+            fprintf(stderr, "Mismatch between placement results!\n");
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,391 @@
+/*
+ * NUMA-Sharded Records: Per-Node Shards, First-Touch by the Owning Worker, Local Summation
+
+   Why Shard the Records?
+
+   Files 10, 11 and 12 keep the records in one static buffer that the main thread faults in while
+   parsing. Linux places a page on the node of the thread that touches it first, so every page
+   lives on the main thread's node and, on a multi-socket host, every worker on another socket
+   sums remote memory. numa_set_preferred(0) only moves the problem to node 0, and because the
+   whole run uses one node, the benchmarks cannot show what remote access costs.
+
+   Sharded Layout
+   --------------
+   The records stay one logical array (index i, same C/D/+ rules), but are stored as one shard
+   per NUMA node: shard s holds records [s * shardCapacity, (s + 1) * shardCapacity).
+
+   - SHARD_ALLOC_ONNODE:  shards come from numa_alloc_onnode(), so pages land on the shard's
+                          node whichever thread faults them in.
+   - SHARD_FIRST_TOUCH:   shards come from plain mmap (numa_alloc) and a worker bound to the
+                          shard's node zeroes them before parsing: the first touch decides.
+
+   The summation then runs one worker per shard, bound to the CPUs of the shard's node, so every
+   load is local. Where each shard actually landed is checked with numa_move_pages().
+
+   Local vs Remote Bandwidth
+   -------------------------
+   For every pair (CPU node, memory node) a worker bound to the CPU node sums a BW_BYTES buffer
+   allocated on the memory node BW_RUNS times. The diagonal is local bandwidth, everything else
+   is remote. On a single-node machine the matrix has one entry.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (expected 15,000,000).
+
+   Expected Output
+   ---------------
+   NUMA nodes with CPUs: [n]
+   numa_alloc_onnode shards: shard 0 on node 0 (verified), ...
+   Sharded sum (numa_alloc_onnode): [time_ms] ms, Result: 15000000
+   First-touch shards: shard 0 on node 0 (verified), ...
+   Sharded sum (first touch): [time_ms] ms, Result: 15000000
+   Single buffer faulted by main: [time_ms] ms, Result: 15000000
+   Bandwidth (GB/s), rows = CPU node, columns = memory node:
+     cpu node 0: [GB/s] ...
+
+   gcc -mavx2 -pthread -O3 23.baseball_numa_sharded_records_first_touch.c -lnuma -o baseball_numa_shards
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>       // printf()
+#include <stdlib.h>      // atoi(), malloc()
+#include <string.h>      // strcmp(), memset()
+#include <stdint.h>      // uintptr_t
+#include <ctype.h>       // isdigit()
+#include <pthread.h>     // pthreads
+#include <sched.h>       // cpu_set_t
+#include <immintrin.h>   // AVX intrinsics
+#include <numa.h>        // numa_alloc_onnode(), numa_node_to_cpus(), numa_move_pages()
+#include <unistd.h>      // sysconf()
+#include <time.h>        // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define MAX_SHARDS 64             // Upper bound on NUMA nodes used
+#define BW_BYTES (64 << 20)       // Buffer per bandwidth measurement
+#define BW_RUNS 5                 // Passes over it
+
+typedef enum {
+    SHARD_ALLOC_ONNODE,
+    SHARD_FIRST_TOUCH
+} ShardAllocation;
+
+typedef struct {
+    int *data;       // Records [base, base + capacity) of the logical array
+    size_t bytes;    // Allocation size
+    int node;        // Node this shard belongs to
+    int base;        // Logical index of data[0]
+    int capacity;    // Records per shard
+} Shard;
+
+typedef struct {
+    Shard shards[MAX_SHARDS];
+    int numShards;
+    int shardCapacity;
+    int count;       // Records in use
+} ShardedRecords;
+
+typedef struct {
+    int *records;    // Pointer to scores array
+    int start, end;  // Range of elements to sum
+    int result;      // Partial sum result
+    int numa_node;   // Node whose CPUs run this worker
+    size_t bytes;    // First touch: bytes to zero at `records`
+} ThreadData;
+
+// Binds the calling thread to the CPUs of a NUMA node.
+void bindThreadToNUMANode(int node) {
+    struct bitmask *nodeCpus = numa_allocate_cpumask();
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+
+    if (numa_node_to_cpus(node, nodeCpus) == 0) {
+        for (unsigned cpu = 0; cpu < nodeCpus->size && cpu < CPU_SETSIZE; cpu++) {
+            if (numa_bitmask_isbitset(nodeCpus, cpu)) CPU_SET(cpu, &cpuset);
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+
+    if (CPU_COUNT(&cpuset) > 0) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
+}
+
+// Node that actually backs the page at addr (-1 if it is not resident).
+int nodeOfAddress(void *addr) {
+    void *page = (void *)((uintptr_t)addr & ~((uintptr_t)sysconf(_SC_PAGESIZE) - 1));
+    int status = -1;
+    if (numa_move_pages(0, 1, &page, NULL, &status, 0) != 0) return -1;
+    return status;
+}
+
+// Nodes that have CPUs this process may use, in node order.
+int nodesWithCpus(int *nodes, int maxNodes) {
+    struct bitmask *nodeCpus = numa_allocate_cpumask();
+    cpu_set_t allowed;
+    int count = 0;
+
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    for (int node = 0; node <= numa_max_node() && count < maxNodes; node++) {
+        if (!numa_bitmask_isbitset(numa_all_nodes_ptr, node)) continue;
+        if (numa_node_to_cpus(node, nodeCpus) != 0) continue;
+        for (unsigned cpu = 0; cpu < nodeCpus->size && cpu < CPU_SETSIZE; cpu++) {
+            if (numa_bitmask_isbitset(nodeCpus, cpu) && CPU_ISSET(cpu, &allowed)) {
+                nodes[count++] = node;
+                break;
+            }
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+    return count;
+}
+
+// First-touch worker: faults its shard in from a CPU of the shard's node.
+void *touchShard(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    bindThreadToNUMANode(data->numa_node);
+    memset(data->records, 0, data->bytes);
+    return NULL;
+}
+
+// Allocates one shard per node for up to maxRecords records.
+int shardedInit(ShardedRecords *r, const int *nodes, int numNodes, int maxRecords,
+                ShardAllocation allocation) {
+    size_t pageInts = sysconf(_SC_PAGESIZE) / sizeof(int);
+    int capacity = (maxRecords + numNodes - 1) / numNodes;
+    capacity = (int)((capacity + pageInts - 1) / pageInts * pageInts);
+
+    r->numShards = numNodes;
+    r->shardCapacity = capacity;
+    r->count = 0;
+
+    for (int s = 0; s < numNodes; s++) {
+        Shard *sh = &r->shards[s];
+        sh->node = nodes[s];
+        sh->base = s * capacity;
+        sh->capacity = capacity;
+        sh->bytes = (size_t)capacity * sizeof(int);
+        sh->data = (allocation == SHARD_ALLOC_ONNODE) ? numa_alloc_onnode(sh->bytes, sh->node)
+                                                      : numa_alloc(sh->bytes);
+        if (!sh->data) return -1;
+    }
+
+    if (allocation == SHARD_FIRST_TOUCH) {
+        pthread_t threads[MAX_SHARDS];
+        ThreadData data[MAX_SHARDS];
+        for (int s = 0; s < numNodes; s++) {
+            data[s] = (ThreadData){r->shards[s].data, 0, 0, 0, r->shards[s].node, r->shards[s].bytes};
+            pthread_create(&threads[s], NULL, touchShard, &data[s]);
+        }
+        for (int s = 0; s < numNodes; s++) pthread_join(threads[s], NULL);
+    }
+    return 0;
+}
+
+void shardedFree(ShardedRecords *r) {
+    for (int s = 0; s < r->numShards; s++) numa_free(r->shards[s].data, r->shards[s].bytes);
+    r->numShards = 0;
+}
+
+static inline int *shardedAt(ShardedRecords *r, int i) {
+    Shard *sh = &r->shards[i / r->shardCapacity];
+    return &sh->data[i - sh->base];
+}
+
+// Evaluates the ops into the sharded records.
+void shardedBuild(ShardedRecords *r, char *ops[], int size) {
+    int index = 0;
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            *shardedAt(r, index++) = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            *shardedAt(r, index) = 2 * *shardedAt(r, index - 1);
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            *shardedAt(r, index) = *shardedAt(r, index - 1) + *shardedAt(r, index - 2);
+            index++;
+        }
+    }
+    r->count = index;
+}
+
+// SIMD-optimized sum using AVX, run on the CPUs of data->numa_node
+void *numaSimdSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    bindThreadToNUMANode(data->numa_node);
+
+    __m256i sumVec = _mm256_setzero_si256();
+    int i;
+
+    for (i = data->start; i + 7 < data->end; i += 8) {
+        __m256i values = _mm256_loadu_si256((__m256i *)&data->records[i]);
+        sumVec = _mm256_add_epi32(sumVec, values);
+    }
+
+    int sumArray[8];
+    _mm256_storeu_si256((__m256i *)sumArray, sumVec);
+    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+              sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
+
+    for (; i < data->end; i++) {
+        sum += data->records[i];
+    }
+
+    data->result = sum;
+    return NULL;
+}
+
+// One worker per shard, each on its shard's node.
+int shardedSum(ShardedRecords *r) {
+    pthread_t threads[MAX_SHARDS];
+    ThreadData data[MAX_SHARDS];
+
+    for (int s = 0; s < r->numShards; s++) {
+        Shard *sh = &r->shards[s];
+        int used = r->count - sh->base;
+        if (used < 0) used = 0;
+        if (used > sh->capacity) used = sh->capacity;
+        data[s] = (ThreadData){sh->data, 0, used, 0, sh->node, 0};
+        pthread_create(&threads[s], NULL, numaSimdSum, &data[s]);
+    }
+
+    int totalSum = 0;
+    for (int s = 0; s < r->numShards; s++) {
+        pthread_join(threads[s], NULL);
+        totalSum += data[s].result;
+    }
+    return totalSum;
+}
+
+void printShardPlacement(ShardedRecords *r, const char *label) {
+    printf("%s:", label);
+    for (int s = 0; s < r->numShards; s++) {
+        int actual = nodeOfAddress(r->shards[s].data);
+        printf(" shard %d on node %d (%s)%s", s, actual,
+               actual == r->shards[s].node ? "verified" : "MISPLACED",
+               s == r->numShards - 1 ? "" : ",");
+    }
+    printf("\n");
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// GB/s of a worker on cpuNode summing BW_BYTES that live on memNode.
+double measureBandwidth(int cpuNode, int memNode) {
+    int *buffer = numa_alloc_onnode(BW_BYTES, memNode);
+    if (!buffer) return 0.0;
+    memset(buffer, 1, BW_BYTES);
+
+    ThreadData data = {buffer, 0, BW_BYTES / sizeof(int), 0, cpuNode, 0};
+    pthread_t thread;
+
+    // Untimed warm-up pass, then BW_RUNS timed passes
+    pthread_create(&thread, NULL, numaSimdSum, &data);
+    pthread_join(thread, NULL);
+
+    double start = nowMs();
+    for (int run = 0; run < BW_RUNS; run++) {
+        pthread_create(&thread, NULL, numaSimdSum, &data);
+        pthread_join(thread, NULL);
+    }
+    double elapsed = nowMs() - start;
+
+    numa_free(buffer, BW_BYTES);
+    return (double)BW_BYTES * BW_RUNS / (elapsed * 1e6);
+}
+
+int main() {
+    static char *ops[MAX_OPERATIONS];
+    static int singleBuffer[MAX_OPERATIONS];
+    int nodes[MAX_SHARDS];
+
+    if (numa_available() == -1) {
+        fprintf(stderr, "NUMA is not available on this system\n");
+        return EXIT_FAILURE;
+    }
+    int numNodes = nodesWithCpus(nodes, MAX_SHARDS);
+    if (numNodes == 0) {
+        fprintf(stderr, "No NUMA node with usable CPUs\n");
+        return EXIT_FAILURE;
+    }
+    printf("NUMA nodes with CPUs: %d\n", numNodes);
+
+    for (int i = 0; i < 500000; i++) {
+        ops[i * 2] = "10";
+        ops[i * 2 + 1] = "D";
+    }
+
+    int results[3];
+    ShardAllocation modes[2] = {SHARD_ALLOC_ONNODE, SHARD_FIRST_TOUCH};
+    const char *names[2] = {"numa_alloc_onnode", "first touch"};
+    const char *placementNames[2] = {"numa_alloc_onnode shards", "First-touch shards"};
+
+    for (int m = 0; m < 2; m++) {
+        ShardedRecords records;
+        if (shardedInit(&records, nodes, numNodes, MAX_OPERATIONS, modes[m]) != 0) {
+            fprintf(stderr, "Could not allocate shards\n");
+            return EXIT_FAILURE;
+        }
+        shardedBuild(&records, ops, MAX_OPERATIONS);
+        printShardPlacement(&records, placementNames[m]);
+
+        double start = nowMs();
+        results[m] = shardedSum(&records);
+        double end = nowMs();
+        printf("Sharded sum (%s): %.3f ms, Result: %d\n", names[m], end - start, results[m]);
+        shardedFree(&records);
+    }
+
+    // Files 10-12: one buffer faulted in by the main thread, workers spread over the nodes
+    int index = 0;
+    for (int i = 0; i < MAX_OPERATIONS; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            singleBuffer[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            singleBuffer[index] = 2 * singleBuffer[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            singleBuffer[index] = singleBuffer[index - 1] + singleBuffer[index - 2];
+            index++;
+        }
+    }
+
+    pthread_t threads[MAX_SHARDS];
+    ThreadData data[MAX_SHARDS];
+    int chunk = index / numNodes;
+    double start = nowMs();
+    for (int s = 0; s < numNodes; s++) {
+        data[s] = (ThreadData){singleBuffer, s * chunk, (s == numNodes - 1) ? index : (s + 1) * chunk,
+                               0, nodes[s], 0};
+        pthread_create(&threads[s], NULL, numaSimdSum, &data[s]);
+    }
+    results[2] = 0;
+    for (int s = 0; s < numNodes; s++) {
+        pthread_join(threads[s], NULL);
+        results[2] += data[s].result;
+    }
+    double end = nowMs();
+    printf("Single buffer faulted by main (node %d): %.3f ms, Result: %d\n",
+           nodeOfAddress(singleBuffer), end - start, results[2]);
+
+    printf("Bandwidth (GB/s), rows = CPU node, columns = memory node:\n");
+    for (int c = 0; c < numNodes; c++) {
+        printf("  cpu node %d:", nodes[c]);
+        for (int m = 0; m < numNodes; m++) printf(" %7.2f", measureBandwidth(nodes[c], nodes[m]));
+        printf("\n");
+    }
+
+    if (results[0] != results[2] || results[1] != results[2]) {
+        fprintf(stderr, "Mismatch between sharded and single-buffer results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,469 @@
+/*
+ * Per-Node Replication of the Read-Only Op Stream for Multi-Socket Evaluation
+
+   Why Replicate the Input?
+
+   The records can be sharded per node (23.baseball_numa_sharded_records_first_touch.c), but the
+   input cannot: when workers on several sockets parse or evaluate the same `largeOps` input,
+   they all read it from the node that allocated it. Every worker on another socket streams the
+   whole input across the interconnect, and it does so again for every re-score.
+
+   The input is read-only, so it can simply be copied: replicateOnNodes() allocates one copy per
+   NUMA node with numa_alloc_onnode() and every worker reads the copy on its own node. Both input
+   forms are supported:
+
+   - FORMAT_TEXT:     the newline-separated op log (as read by files 14 and 17)
+   - FORMAT_ENCODED:  the zigzag-varint op stream of 16.baseball_binary_op_stream_zigzag_varint.c
+
+   Replication costs one copy per node. It pays off when the input is scored several times, for
+   example under several rule configurations. Here, NUM_CONFIGS RuleConfigs (different "D"
+   multipliers) are each scored by every worker.
+
+   Report
+   ------
+   For each format, the program prints:
+   - Shared:      every worker reads the single copy on the first node
+   - Replication: time to build the per-node copies
+   - Replicated:  every worker reads its local copy
+   - Penalty avoided = Shared - Replicated; replication pays off once it exceeds the replication
+     cost (break-even is reported in scoring passes over the input).
+   Shared and replicated runs alternate after one untimed warm-up of each, and the best of
+   TIMING_RUNS is reported. A penalty is only claimed when it is larger than the run-to-run
+   spread. On a single-node machine there is no remote penalty to avoid, and none is reported.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times. RuleConfig 0 is the standard game (expected 15,000,000).
+
+   Expected Output
+   ---------------
+   NUMA nodes with CPUs: [n], workers: [w]
+   Text (2500000 bytes): shared [ms] ms, replication [ms] ms, replicated [ms] ms, penalty avoided [ms] ms (...)
+   Encoded (1000000 bytes): shared [ms] ms, replication [ms] ms, replicated [ms] ms, penalty avoided [ms] ms (...)
+   (on one node: "..., no remote penalty (single node)")
+   Standard rules: Result: 15000000
+
+   gcc -pthread -O3 24.baseball_numa_replicated_read_only_op_stream.c -lnuma -o baseball_numa_replicas
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>       // printf()
+#include <stdlib.h>      // atoi(), malloc()
+#include <string.h>      // strcmp(), memcpy()
+#include <ctype.h>       // isdigit()
+#include <stdint.h>      // uint8_t, uint32_t
+#include <pthread.h>     // pthreads
+#include <sched.h>       // cpu_set_t
+#include <numa.h>        // numa_alloc_onnode(), numa_node_to_cpus()
+#include <time.h>        // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define MAX_NODES 64
+#define WORKERS_PER_NODE 2
+#define MAX_WORKERS (MAX_NODES * WORKERS_PER_NODE)
+#define NUM_CONFIGS 4            // Rule configurations each worker scores
+#define MAX_VARINT_BYTES 5
+#define TIMING_RUNS 5            // Alternating shared/replicated runs after a warm-up
+
+#define OP_NUMBER 0     // Tag of a varint-encoded number
+#define OP_CANCEL 1     // "C"
+#define OP_DOUBLE 2     // "D"
+#define OP_PLUS   3     // "+"
+
+typedef enum {
+    FORMAT_TEXT,
+    FORMAT_ENCODED
+} BufferFormat;
+
+// A scoring rule variant; config 0 is the standard game.
+typedef struct {
+    int doubleFactor;   // "D" records doubleFactor * previous
+} RuleConfig;
+
+// One read-only copy of the input per node.
+typedef struct {
+    const uint8_t *replicas[MAX_NODES];
+    int nodes[MAX_NODES];
+    int numNodes;
+    size_t length;
+} ReplicatedBuffer;
+
+typedef struct {
+    const uint8_t *input;      // Buffer this worker reads
+    size_t length;
+    BufferFormat format;
+    size_t maxRecords;         // Ops in the input, an upper bound for the records
+    const RuleConfig *configs;
+    int numa_node;             // Node whose CPUs run this worker
+    int results[NUM_CONFIGS];
+    int failed;                // Records could not be allocated
+} ThreadData;
+
+static const RuleConfig ruleConfigs[NUM_CONFIGS] = {{2}, {3}, {1}, {4}};
+
+// Binds the calling thread to the CPUs of a NUMA node.
+void bindThreadToNUMANode(int node) {
+    struct bitmask *nodeCpus = numa_allocate_cpumask();
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+
+    if (numa_node_to_cpus(node, nodeCpus) == 0) {
+        for (unsigned cpu = 0; cpu < nodeCpus->size && cpu < CPU_SETSIZE; cpu++) {
+            if (numa_bitmask_isbitset(nodeCpus, cpu)) CPU_SET(cpu, &cpuset);
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+
+    if (CPU_COUNT(&cpuset) > 0) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
+}
+
+// Nodes that have CPUs this process may use, in node order.
+int nodesWithCpus(int *nodes, int maxNodes) {
+    struct bitmask *nodeCpus = numa_allocate_cpumask();
+    cpu_set_t allowed;
+    int count = 0;
+
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    for (int node = 0; node <= numa_max_node() && count < maxNodes; node++) {
+        if (!numa_bitmask_isbitset(numa_all_nodes_ptr, node)) continue;
+        if (numa_node_to_cpus(node, nodeCpus) != 0) continue;
+        for (unsigned cpu = 0; cpu < nodeCpus->size && cpu < CPU_SETSIZE; cpu++) {
+            if (numa_bitmask_isbitset(nodeCpus, cpu) && CPU_ISSET(cpu, &allowed)) {
+                nodes[count++] = node;
+                break;
+            }
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+    return count;
+}
+
+// Copies src onto every node. Returns 0 on success, -1 if a copy could not be allocated.
+int replicateOnNodes(ReplicatedBuffer *rb, const void *src, size_t length,
+                     const int *nodes, int numNodes) {
+    rb->numNodes = 0;
+    rb->length = length;
+    for (int n = 0; n < numNodes; n++) {
+        uint8_t *copy = numa_alloc_onnode(length, nodes[n]);
+        if (!copy) return -1;
+        memcpy(copy, src, length);   // Pages fault in on nodes[n] (bind policy)
+        rb->replicas[n] = copy;
+        rb->nodes[n] = nodes[n];
+        rb->numNodes++;
+    }
+    return 0;
+}
+
+// The copy a worker on `node` should read (the first copy if the node has none).
+const uint8_t *replicaFor(const ReplicatedBuffer *rb, int node) {
+    for (int n = 0; n < rb->numNodes; n++) {
+        if (rb->nodes[n] == node) return rb->replicas[n];
+    }
+    return rb->replicas[0];
+}
+
+void replicasFree(ReplicatedBuffer *rb) {
+    for (int n = 0; n < rb->numNodes; n++) numa_free((void *)rb->replicas[n], rb->length);
+    rb->numNodes = 0;
+}
+
+// Newline-separated op log. *count is the number of lines written.
+size_t encodeText(char *ops[], int size, uint8_t *out, size_t *count) {
+    size_t length = 0;
+    for (int i = 0; i < size; i++) {
+        size_t n = strlen(ops[i]);
+        memcpy(out + length, ops[i], n);
+        length += n;
+        out[length++] = '\n';
+    }
+    *count = (size_t)size;
+    return length;
+}
+
+// Zigzag-varint op stream (file 16). *count is the number of ops encoded.
+size_t encodeBinary(char *ops[], int size, uint8_t *out, size_t *count) {
+    uint8_t *p = out;
+    *count = 0;
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            int x = atoi(ops[i]);
+            uint64_t v = (uint64_t)(((uint32_t)x << 1) ^ (uint32_t)(x >> 31)) << 2;
+            while (v >= 0x80) {
+                *p++ = (uint8_t)(v | 0x80);
+                v >>= 7;
+            }
+            *p++ = (uint8_t)v;
+        } else if (strcmp(ops[i], "C") == 0) {
+            *p++ = OP_CANCEL;
+        } else if (strcmp(ops[i], "D") == 0) {
+            *p++ = OP_DOUBLE;
+        } else if (strcmp(ops[i], "+") == 0) {
+            *p++ = OP_PLUS;
+        } else {
+            continue;  // No-op token, nothing to encode
+        }
+        (*count)++;
+    }
+    return (size_t)(p - out);
+}
+
+// Scores the text log under one rule configuration (running sum, as in file 2).
+int calPointsText(const uint8_t *buf, size_t length, int *records, const RuleConfig *rules) {
+    int index = 0, sum = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        size_t start = i;
+        while (i < length && buf[i] != '\n') i++;
+        const uint8_t *op = buf + start;
+        size_t len = i - start;
+        i++;
+        if (len == 0) continue;
+
+        if (isdigit(op[0]) || (op[0] == '-' && len > 1 && isdigit(op[1]))) {
+            int neg = (op[0] == '-'), num = 0;
+            for (size_t k = neg; k < len && isdigit(op[k]); k++) num = num * 10 + (op[k] - '0');
+            num = neg ? -num : num;
+            records[index++] = num;
+            sum += num;
+        } else if (len == 1 && op[0] == 'C') {
+            if (index > 0) sum -= records[--index];
+        } else if (len == 1 && op[0] == 'D') {
+            if (index > 0) {
+                int doublePrev = rules->doubleFactor * records[index - 1];
+                records[index++] = doublePrev;
+                sum += doublePrev;
+            }
+        } else if (len == 1 && op[0] == '+') {
+            if (index > 1) {
+                int sumLastTwo = records[index - 1] + records[index - 2];
+                records[index++] = sumLastTwo;
+                sum += sumLastTwo;
+            }
+        }
+    }
+    return sum;
+}
+
+// Scores the encoded stream under one rule configuration.
+int calPointsEncoded(const uint8_t *buf, size_t length, int *records, const RuleConfig *rules) {
+    int index = 0, sum = 0;
+    const uint8_t *p = buf, *end = buf + length;
+
+    while (p < end) {
+        uint8_t b = *p++;
+        switch (b & 3) {
+        case OP_NUMBER: {
+            uint64_t v = b & 0x7F;
+            int shift = 7;
+            while (b & 0x80) {
+                b = *p++;
+                v |= (uint64_t)(b & 0x7F) << shift;
+                shift += 7;
+            }
+            uint32_t z = (uint32_t)(v >> 2);
+            int num = (int)((z >> 1) ^ (0u - (z & 1)));
+            records[index++] = num;
+            sum += num;
+            break;
+        }
+        case OP_CANCEL:
+            if (index > 0) sum -= records[--index];
+            break;
+        case OP_DOUBLE:
+            if (index > 0) {
+                int doublePrev = rules->doubleFactor * records[index - 1];
+                records[index++] = doublePrev;
+                sum += doublePrev;
+            }
+            break;
+        case OP_PLUS:
+            if (index > 1) {
+                int sumLastTwo = records[index - 1] + records[index - 2];
+                records[index++] = sumLastTwo;
+                sum += sumLastTwo;
+            }
+            break;
+        }
+    }
+    return sum;
+}
+
+// Worker: scores its input under every rule configuration on its node.
+void *scoreConfigs(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    bindThreadToNUMANode(data->numa_node);
+
+    // Records are private to the worker and first-touched on its node
+    int *records = malloc((data->maxRecords ? data->maxRecords : 1) * sizeof(int));
+    data->failed = (records == NULL);
+    if (!records) return NULL;
+    for (int c = 0; c < NUM_CONFIGS; c++) {
+        data->results[c] = (data->format == FORMAT_TEXT)
+            ? calPointsText(data->input, data->length, records, &data->configs[c])
+            : calPointsEncoded(data->input, data->length, records, &data->configs[c]);
+    }
+    free(records);
+    return NULL;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Runs WORKERS_PER_NODE workers per node; replicas == NULL means all read `shared`.
+// Returns the elapsed milliseconds, or -1 if a worker could not allocate its records.
+double scoreOnAllNodes(const uint8_t *shared, const ReplicatedBuffer *replicas, size_t length,
+                       size_t opCount, BufferFormat format, const int *nodes, int numNodes,
+                       ThreadData *data) {
+    pthread_t threads[MAX_WORKERS];
+    int numWorkers = numNodes * WORKERS_PER_NODE;
+
+    double start = nowMs();
+    for (int w = 0; w < numWorkers; w++) {
+        int node = nodes[w % numNodes];
+        data[w].input = replicas ? replicaFor(replicas, node) : shared;
+        data[w].length = length;
+        data[w].format = format;
+        data[w].maxRecords = opCount;
+        data[w].configs = ruleConfigs;
+        data[w].numa_node = node;
+        pthread_create(&threads[w], NULL, scoreConfigs, &data[w]);
+    }
+    for (int w = 0; w < numWorkers; w++) pthread_join(threads[w], NULL);
+    double elapsed = nowMs() - start;
+    for (int w = 0; w < numWorkers; w++) {
+        if (data[w].failed) return -1;
+    }
+    return elapsed;
+}
+
+// Best and spread (max - min) of TIMING_RUNS alternating shared/replicated runs, after one
+// untimed warm-up of each, so neither side is charged for cold caches and page faults.
+// Returns 0, or -1 if a run failed.
+int timeSharedAndReplicated(const uint8_t *shared, const ReplicatedBuffer *replicas, size_t length,
+                            size_t opCount, BufferFormat format, const int *nodes, int numNodes,
+                            ThreadData *data, double best[2], double spread[2]) {
+    double worst[2] = {0, 0};
+    best[0] = best[1] = 1e300;
+    for (int run = -1; run < TIMING_RUNS; run++) {
+        for (int side = 0; side < 2; side++) {
+            double ms = scoreOnAllNodes(side ? NULL : shared, side ? replicas : NULL, length,
+                                        opCount, format, nodes, numNodes, data);
+            if (ms < 0) return -1;
+            if (run < 0) continue;   // Warm-up
+            if (ms < best[side]) best[side] = ms;
+            if (ms > worst[side]) worst[side] = ms;
+        }
+    }
+    spread[0] = worst[0] - best[0];
+    spread[1] = worst[1] - best[1];
+    return 0;
+}
+
+int main() {
+    static char *ops[MAX_OPERATIONS];
+    static ThreadData data[MAX_WORKERS];
+    int nodes[MAX_NODES];
+
+    if (numa_available() == -1) {
+        fprintf(stderr, "NUMA is not available on this system\n");
+        return EXIT_FAILURE;
+    }
+    int numNodes = nodesWithCpus(nodes, MAX_NODES);
+    if (numNodes == 0) {
+        fprintf(stderr, "No NUMA node with usable CPUs\n");
+        return EXIT_FAILURE;
+    }
+    printf("NUMA nodes with CPUs: %d, workers: %d\n", numNodes, numNodes * WORKERS_PER_NODE);
+
+    for (int i = 0; i < 500000; i++) {
+        ops[i * 2] = "10";
+        ops[i * 2 + 1] = "D";
+    }
+
+    uint8_t *staging = malloc((size_t)MAX_OPERATIONS * (MAX_VARINT_BYTES + 8));
+    if (!staging) {
+        fprintf(stderr, "Could not allocate the staging buffer\n");
+        return EXIT_FAILURE;
+    }
+    const char *formatNames[2] = {"Text", "Encoded"};
+    int standardResult = 0, failed = 0;
+
+    for (int f = FORMAT_TEXT; f <= FORMAT_ENCODED; f++) {
+        size_t opCount;
+        size_t length = (f == FORMAT_TEXT) ? encodeText(ops, MAX_OPERATIONS, staging, &opCount)
+                                           : encodeBinary(ops, MAX_OPERATIONS, staging, &opCount);
+
+        // Shared: the single copy lives on the first node
+        uint8_t *shared = numa_alloc_onnode(length, nodes[0]);
+        if (!shared) {
+            fprintf(stderr, "Could not allocate the input on node %d\n", nodes[0]);
+            return EXIT_FAILURE;
+        }
+        memcpy(shared, staging, length);
+
+        ReplicatedBuffer replicas;
+        double start = nowMs();
+        if (replicateOnNodes(&replicas, shared, length, nodes, numNodes) != 0) {
+            fprintf(stderr, "Could not replicate the input on every node\n");
+            return EXIT_FAILURE;
+        }
+        double replicationMs = nowMs() - start;
+
+        // Reference results from the shared copy, then the timed runs
+        int reference[NUM_CONFIGS];
+        double best[2], spread[2];
+        if (scoreOnAllNodes(shared, NULL, length, opCount, f, nodes, numNodes, data) < 0) {
+            fprintf(stderr, "Could not allocate the worker records\n");
+            return EXIT_FAILURE;
+        }
+        memcpy(reference, data[0].results, sizeof(reference));
+        if (timeSharedAndReplicated(shared, &replicas, length, opCount, f, nodes, numNodes,
+                                    data, best, spread) != 0) {
+            fprintf(stderr, "Could not allocate the worker records\n");
+            return EXIT_FAILURE;
+        }
+
+        // The last run read the replicas
+        for (int w = 0; w < numNodes * WORKERS_PER_NODE; w++) {
+            if (memcmp(data[w].results, reference, sizeof(reference)) != 0) failed = 1;
+        }
+
+        double sharedMs = best[0], replicatedMs = best[1];
+        double penalty = sharedMs - replicatedMs;
+        double noise = spread[0] > spread[1] ? spread[0] : spread[1];
+        printf("%s (%zu bytes): shared %.3f ms, replication %.3f ms, replicated %.3f ms",
+               formatNames[f], length, sharedMs, replicationMs, replicatedMs);
+        if (numNodes < 2) {
+            printf(", no remote penalty (single node)\n");
+        } else if (penalty <= noise) {
+            printf(", no remote penalty above the run-to-run noise (%.3f ms)\n", noise);
+        } else {
+            // Each worker scored the input NUM_CONFIGS times
+            printf(", penalty avoided %.3f ms (pays off after %.1f scoring passes)\n",
+                   penalty, replicationMs / (penalty / NUM_CONFIGS));
+        }
+
+        if (f == FORMAT_TEXT) {
+            standardResult = reference[0];
+        } else if (reference[0] != standardResult) {
+            failed = 1;
+        }
+        replicasFree(&replicas);
+        numa_free(shared, length);
+    }
+    free(staging);
+
+    printf("Standard rules: Result: %d\n", standardResult);
+    if (failed || standardResult != 15000000) {
+        fprintf(stderr, "Mismatch between shared and replicated results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,333 @@
+/*
+ * Huge-Page Backed Records and Op Buffers (MAP_HUGETLB with THP Fallback)
+
+   Why Huge Pages?
+
+   With 4 KB pages, one pass over 4 MB of records touches about 1000 pages, far more than the
+   first-level data TLB holds, and the `char *ops[]` pointer array adds another 8 MB (2000 pages)
+   before a single record is written. Every TLB miss is a page walk. A 2 MB page covers 512 small
+   pages with one TLB entry, so the records need 2 entries and the pointer array 4.
+
+   Allocation Strategy
+   -------------------
+   pageBufferAlloc(buffer, size, PAGES_HUGE) tries, in order:
+
+   1. mmap(MAP_HUGETLB): explicit huge pages from the reserved pool (vm.nr_hugepages). These are
+      guaranteed huge, but the pool is often empty.
+   2. mmap + madvise(MADV_HUGEPAGE): transparent huge pages. The mapping is 2 MB aligned and
+      faulted in right away. The kernel may still hand out small pages (fragmentation, THP
+      disabled), so the result is checked in /proc/self/smaps (AnonHugePages).
+
+   PAGES_NORMAL maps with madvise(MADV_NOHUGEPAGE), so the baseline stays on 4 KB pages even
+   when THP is set to "always". Every buffer reports the kind of pages it actually got.
+
+   Benchmark Switch
+   ----------------
+       ./baseball_huge_pages huge     only huge pages
+       ./baseball_huge_pages normal   only 4 KB pages
+       ./baseball_huge_pages          both, one after the other (default)
+
+   Each mode runs the cache benchmark of 9.baseball_cache_performance_impact_multithreaded_simd.c
+   (its 2-thread aligned-load simdSum, which has no main of its own). The ops pointer array and the
+   records both come from the selected pages. A page-walk test then reads one int per 4 KB
+   page of a PAGE_WALK_BYTES buffer in shuffled order; this access pattern is dominated by TLB
+   misses.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (expected 15,000,000).
+
+   Expected Output
+   ---------------
+   [huge pages]
+   ops pointer array: transparent huge pages (7812 KB of 7812 KB huge)
+   records: transparent huge pages (3906 KB of 3906 KB huge)
+   Parse: [time_ms] ms, Sum x100: [time_ms] ms, Result: 15000000
+   Page walk (256 MB, transparent huge pages): [ns] ns per page
+   [normal pages]
+   ...
+
+   gcc -mavx2 -pthread -O3 25.baseball_huge_page_records_and_op_buffers.c -o baseball_huge_pages
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>         // printf(), fopen()
+#include <stdlib.h>        // atoi(), rand()
+#include <string.h>        // strcmp(), memset()
+#include <ctype.h>         // isdigit()
+#include <stdint.h>        // uintptr_t
+#include <pthread.h>       // pthreads
+#include <immintrin.h>     // AVX intrinsics
+#include <sys/mman.h>      // mmap(), madvise(), MAP_HUGETLB
+#include <time.h>          // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define NUM_THREADS 2
+#define HUGE_PAGE_SIZE (2UL << 20)
+#define SMALL_PAGE_SIZE 4096UL
+#define SUM_RUNS 100                     // Passes of the file-9 sum per mode
+#define PAGE_WALK_BYTES (256UL << 20)    // Buffer for the TLB-bound page walk
+#define PAGE_WALK_ROUNDS 4
+
+typedef enum {
+    PAGES_NORMAL,        // 4 KB pages (THP disabled for the mapping)
+    PAGES_HUGE           // Request: explicit huge pages, else THP
+} PageRequest;
+
+typedef enum {
+    KIND_NORMAL,         // 4 KB pages
+    KIND_HUGETLB,        // Explicit huge pages (MAP_HUGETLB)
+    KIND_THP,            // Transparent huge pages, at least partly granted
+    KIND_THP_DENIED      // MADV_HUGEPAGE accepted, but only small pages were faulted in
+} PageKind;
+
+typedef struct {
+    void *ptr;           // 2 MB aligned for huge requests
+    size_t size;         // Bytes requested
+    void *mapping;       // What to munmap
+    size_t mappedBytes;
+    PageKind kind;
+    size_t hugeBytes;    // Bytes backed by huge pages (from smaps for THP)
+} PageBuffer;
+
+typedef struct {
+    int *records;
+    int start, end;
+    int result;
+} ThreadData;
+
+const char *pageKindName(PageKind kind) {
+    switch (kind) {
+    case KIND_HUGETLB:    return "explicit huge pages (MAP_HUGETLB)";
+    case KIND_THP:        return "transparent huge pages";
+    case KIND_THP_DENIED: return "THP requested but not granted (4 KB pages)";
+    default:              return "4 KB pages";
+    }
+}
+
+// Bytes of the mapping starting at addr that are backed by transparent huge pages.
+size_t anonHugeBytes(void *addr) {
+    FILE *f = fopen("/proc/self/smaps", "r");
+    if (!f) return 0;
+
+    char line[256];
+    int inMapping = 0;
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long start, end;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            if (inMapping) break;  // Past our mapping
+            inMapping = ((uintptr_t)addr >= start && (uintptr_t)addr < end);
+        } else if (inMapping && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+    return kb * 1024;
+}
+
+// Allocates and pre-faults `size` bytes. Returns 0 on success, -1 if nothing could be mapped.
+int pageBufferAlloc(PageBuffer *b, size_t size, PageRequest request) {
+    b->size = size;
+    b->hugeBytes = 0;
+
+    if (request == PAGES_HUGE) {
+        // 1. Explicit huge pages
+        size_t rounded = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        void *p = mmap(NULL, rounded, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (p != MAP_FAILED) {
+            b->ptr = b->mapping = p;
+            b->mappedBytes = rounded;
+            b->kind = KIND_HUGETLB;
+            b->hugeBytes = rounded;
+            return 0;
+        }
+
+        // 2. Transparent huge pages on a 2 MB aligned range
+        size_t mapped = rounded + HUGE_PAGE_SIZE;
+        p = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return -1;
+        char *aligned = (char *)(((uintptr_t)p + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+        madvise(aligned, rounded, MADV_HUGEPAGE);
+        memset(aligned, 0, rounded);  // Fault in now, while the hint applies
+
+        b->ptr = aligned;
+        b->mapping = p;
+        b->mappedBytes = mapped;
+        b->hugeBytes = anonHugeBytes(aligned);
+        b->kind = b->hugeBytes > 0 ? KIND_THP : KIND_THP_DENIED;
+        return 0;
+    }
+
+    size_t rounded = (size + SMALL_PAGE_SIZE - 1) & ~(SMALL_PAGE_SIZE - 1);
+    void *p = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return -1;
+    madvise(p, rounded, MADV_NOHUGEPAGE);  // Keep the baseline on 4 KB pages
+    memset(p, 0, rounded);
+
+    b->ptr = b->mapping = p;
+    b->mappedBytes = rounded;
+    b->kind = KIND_NORMAL;
+    return 0;
+}
+
+void pageBufferFree(PageBuffer *b) {
+    munmap(b->mapping, b->mappedBytes);
+    b->ptr = b->mapping = NULL;
+}
+
+void printPageBuffer(const char *label, const PageBuffer *b) {
+    size_t huge = b->hugeBytes < b->size ? b->hugeBytes : b->size;
+    printf("%s: %s (%zu KB of %zu KB huge)\n", label, pageKindName(b->kind),
+           huge >> 10, b->size >> 10);
+}
+
+// SIMD-optimized sum function using AVX with cache optimization (file 9)
+void *simdSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    __m256i sumVec = _mm256_setzero_si256();
+    int i;
+
+    for (i = data->start; i + 7 < data->end; i += 8) {
+        __m256i values = _mm256_load_si256((__m256i*)&data->records[i]); // Aligned load
+        sumVec = _mm256_add_epi32(sumVec, values);
+    }
+
+    int sumArray[8];
+    _mm256_storeu_si256((__m256i*)sumArray, sumVec);
+
+    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+              sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
+
+    for (; i < data->end; i++) {
+        sum += data->records[i];
+    }
+
+    data->result = sum;
+    pthread_exit(NULL);
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Runs the whole benchmark on one kind of pages. Returns the score.
+int runBenchmark(PageRequest request) {
+    PageBuffer opsBuffer, recordsBuffer, walkBuffer;
+
+    if (pageBufferAlloc(&opsBuffer, MAX_OPERATIONS * sizeof(char *), request) != 0 ||
+        pageBufferAlloc(&recordsBuffer, MAX_OPERATIONS * sizeof(int), request) != 0) {
+        fprintf(stderr, "Could not map the benchmark buffers\n");
+        return -1;
+    }
+    printPageBuffer("ops pointer array", &opsBuffer);
+    printPageBuffer("records", &recordsBuffer);
+
+    char **ops = opsBuffer.ptr;
+    int *records = recordsBuffer.ptr;
+    for (int i = 0; i < 500000; i++) {
+        ops[i * 2] = "10";
+        ops[i * 2 + 1] = "D";
+    }
+
+    double start = nowMs();
+    int index = 0;
+    for (int i = 0; i < MAX_OPERATIONS; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+    double parseMs = nowMs() - start;
+
+    int totalSum = 0;
+    start = nowMs();
+    for (int run = 0; run < SUM_RUNS; run++) {
+        pthread_t threads[NUM_THREADS];
+        ThreadData data[NUM_THREADS];
+        int mid = index / NUM_THREADS & ~7;  // Keep every thread's start 32-byte aligned
+
+        for (int i = 0; i < NUM_THREADS; i++) {
+            data[i] = (ThreadData){records, i * mid, (i == NUM_THREADS - 1) ? index : (i + 1) * mid, 0};
+            pthread_create(&threads[i], NULL, simdSum, &data[i]);
+        }
+        totalSum = 0;
+        for (int i = 0; i < NUM_THREADS; i++) {
+            pthread_join(threads[i], NULL);
+            totalSum += data[i].result;
+        }
+    }
+    double sumMs = nowMs() - start;
+    printf("Parse: %.3f ms, Sum x%d: %.3f ms, Result: %d\n", parseMs, SUM_RUNS, sumMs, totalSum);
+
+    // One int per 4 KB page in shuffled order: every access needs a new translation
+    if (pageBufferAlloc(&walkBuffer, PAGE_WALK_BYTES, request) == 0) {
+        size_t pages = PAGE_WALK_BYTES / SMALL_PAGE_SIZE;
+        size_t stride = SMALL_PAGE_SIZE / sizeof(int);
+        unsigned *order = malloc(pages * sizeof(unsigned));
+        int *walk = walkBuffer.ptr;
+        for (size_t p = 0; p < pages; p++) order[p] = (unsigned)p;
+        srand(42);
+        for (size_t p = pages - 1; p > 0; p--) {
+            size_t q = (size_t)rand() % (p + 1);
+            unsigned t = order[p]; order[p] = order[q]; order[q] = t;
+        }
+
+        volatile int sink = 0;
+        start = nowMs();
+        for (int round = 0; round < PAGE_WALK_ROUNDS; round++) {
+            int acc = 0;
+            for (size_t p = 0; p < pages; p++) acc += walk[order[p] * stride];
+            sink += acc;
+        }
+        double walkMs = nowMs() - start;
+        (void)sink;
+        printf("Page walk (%lu MB, %s): %.2f ns per page\n", PAGE_WALK_BYTES >> 20,
+               walkBuffer.kind == KIND_NORMAL ? "4 KB" : pageKindName(walkBuffer.kind),
+               walkMs * 1e6 / ((double)pages * PAGE_WALK_ROUNDS));
+        free(order);
+        pageBufferFree(&walkBuffer);
+    }
+
+    pageBufferFree(&opsBuffer);
+    pageBufferFree(&recordsBuffer);
+    return totalSum;
+}
+
+int main(int argc, char *argv[]) {
+    const char *mode = argc > 1 ? argv[1] : "both";
+    int runHuge = strcmp(mode, "huge") == 0 || strcmp(mode, "both") == 0;
+    int runNormal = strcmp(mode, "normal") == 0 || strcmp(mode, "both") == 0;
+
+    if (!runHuge && !runNormal) {
+        fprintf(stderr, "Usage: %s [huge|normal|both]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int resultHuge = 15000000, resultNormal = 15000000;
+    if (runHuge) {
+        printf("[huge pages]\n");
+        resultHuge = runBenchmark(PAGES_HUGE);
+    }
+    if (runNormal) {
+        printf("[normal pages]\n");
+        resultNormal = runBenchmark(PAGES_NORMAL);
+    }
+
+    if (resultHuge != resultNormal || resultHuge != 15000000) {
+        fprintf(stderr, "Mismatch between huge-page and normal-page results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,302 @@
+/*
+ * Runtime CPU-Feature Dispatch for the Reduction Kernel (Scalar / SSE4.1 / AVX2 / AVX-512)
+
+   Why Dispatch at Runtime?
+
+   simdSum and numaSimdSum are built with -mavx2, so the binary dies with SIGILL on CPUs
+   without AVX2. It also never uses AVX-512 where that exists, so a mixed fleet needs one build
+   per CPU generation.
+
+   This program is built WITHOUT -mavx2/-mavx512f. Each kernel is compiled for its own
+   instruction set with __attribute__((target(...))), so the file holds all of them. At startup
+   selectSumKernel():
+
+   1. probes the CPU with cpuid (SSE4.1, AVX2, AVX-512F) and checks with xgetbv that the OS
+      saves the YMM/ZMM state (a CPU flag alone is not enough);
+   2. binds the fastest supported kernel to the `sumKernel` function pointer;
+   3. honours SCOREBENCH_SUM_KERNEL=scalar|sse41|avx2|avx512 for A/B tests. An override the
+      CPU cannot run is refused with a warning, and the automatic choice is kept.
+
+   Only code reached through the pointer uses the wider instructions. The parse loop, the
+   thread setup and main are plain x86-64, so they run on any 64-bit x86 CPU.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (expected 15,000,000), summed with 2 threads through the
+     dispatched kernel.
+   - Every kernel the CPU supports is also benchmarked directly, and all results must agree.
+
+   Expected Output
+   ---------------
+   CPU features: sse4.1 avx2 avx512f
+   Selected kernel: avx512 (automatic)
+     avx512  [GB/s] GB/s, Result: 15000000
+     avx2    [GB/s] GB/s, Result: 15000000
+     sse41   [GB/s] GB/s, Result: 15000000
+     scalar  [GB/s] GB/s, Result: 15000000
+   Dispatched calPoints (avx512): [time_ms] ms, Result: 15000000
+
+   gcc -pthread -O3 26.baseball_runtime_cpu_dispatch_reduction_kernels.c -o baseball_dispatch
+   SCOREBENCH_SUM_KERNEL=sse41 ./baseball_dispatch
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), getenv()
+#include <string.h>       // strcmp()
+#include <ctype.h>        // isdigit()
+#include <pthread.h>      // pthreads
+#include <cpuid.h>        // __get_cpuid(), __get_cpuid_count()
+#include <immintrin.h>    // SSE4.1 / AVX2 / AVX-512 intrinsics (per-function targets)
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define NUM_THREADS 2
+#define BENCH_RUNS 200             // Passes per kernel in the benchmark
+
+typedef int (*SumKernel)(const int *records, int start, int end);
+
+typedef struct {
+    int *records;    // Pointer to scores array
+    int start, end;  // Range of elements to sum
+    int result;      // Partial sum result
+} ThreadData;
+
+typedef struct {
+    const char *name;      // Name used by SCOREBENCH_SUM_KERNEL
+    SumKernel fn;
+    int supported;         // Filled in by detectCpuFeatures()
+} KernelEntry;
+
+// Reference kernel; runs everywhere.
+static int sumScalar(const int *records, int start, int end) {
+    int sum = 0;
+    for (int i = start; i < end; i++) sum += records[i];
+    return sum;
+}
+
+__attribute__((target("sse4.1")))
+static int sumSse41(const int *records, int start, int end) {
+    __m128i sumVec = _mm_setzero_si128();
+    int i;
+
+    for (i = start; i + 3 < end; i += 4) {
+        sumVec = _mm_add_epi32(sumVec, _mm_loadu_si128((const __m128i *)&records[i]));
+    }
+
+    int sum = _mm_extract_epi32(sumVec, 0) + _mm_extract_epi32(sumVec, 1) +
+              _mm_extract_epi32(sumVec, 2) + _mm_extract_epi32(sumVec, 3);
+    for (; i < end; i++) sum += records[i];
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static int sumAvx2(const int *records, int start, int end) {
+    __m256i sumVec = _mm256_setzero_si256();
+    int i;
+
+    for (i = start; i + 7 < end; i += 8) {
+        sumVec = _mm256_add_epi32(sumVec, _mm256_loadu_si256((const __m256i *)&records[i]));
+    }
+
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sumVec), _mm256_extracti128_si256(sumVec, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    int sum = _mm_cvtsi128_si32(half);
+    for (; i < end; i++) sum += records[i];
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+static int sumAvx512(const int *records, int start, int end) {
+    __m512i sumVec = _mm512_setzero_si512();
+    int i;
+
+    for (i = start; i + 15 < end; i += 16) {
+        sumVec = _mm512_add_epi32(sumVec, _mm512_loadu_si512((const void *)&records[i]));
+    }
+
+    // Masked load for the tail instead of a scalar loop
+    if (i < end) {
+        __mmask16 tail = (__mmask16)((1u << (end - i)) - 1);
+        sumVec = _mm512_add_epi32(sumVec, _mm512_maskz_loadu_epi32(tail, &records[i]));
+    }
+    return _mm512_reduce_add_epi32(sumVec);
+}
+
+// Strongest first: selectSumKernel() takes the first supported entry.
+static KernelEntry kernels[] = {
+    {"avx512", sumAvx512, 0},
+    {"avx2",   sumAvx2,   0},
+    {"sse41",  sumSse41,  0},
+    {"scalar", sumScalar, 1},
+};
+#define NUM_KERNELS ((int)(sizeof(kernels) / sizeof(kernels[0])))
+
+// The dispatched reduction kernel
+static SumKernel sumKernel = sumScalar;
+static const char *sumKernelName = "scalar";
+
+static unsigned long long readXcr0(void) {
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+}
+
+// Marks the kernels this CPU and OS can run.
+void detectCpuFeatures(void) {
+    unsigned eax, ebx, ecx, edx;
+    int sse41 = 0, osxsave = 0, avx = 0, avx2 = 0, avx512f = 0;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        sse41 = (ecx & bit_SSE4_1) != 0;
+        osxsave = (ecx & bit_OSXSAVE) != 0;
+        avx = (ecx & bit_AVX) != 0;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        avx2 = (ebx & bit_AVX2) != 0;
+        avx512f = (ebx & bit_AVX512F) != 0;
+    }
+
+    // The OS must save the wider registers on context switches (XCR0)
+    unsigned long long xcr0 = osxsave ? readXcr0() : 0;
+    int ymmState = (xcr0 & 0x6) == 0x6;           // SSE + AVX state
+    int zmmState = (xcr0 & 0xE6) == 0xE6;         // + opmask, ZMM_Hi256, Hi16_ZMM
+
+    for (int k = 0; k < NUM_KERNELS; k++) {
+        if (strcmp(kernels[k].name, "sse41") == 0) kernels[k].supported = sse41;
+        if (strcmp(kernels[k].name, "avx2") == 0) kernels[k].supported = avx && avx2 && ymmState;
+        if (strcmp(kernels[k].name, "avx512") == 0) kernels[k].supported = avx512f && zmmState;
+    }
+
+    printf("CPU features:");
+    if (sse41) printf(" sse4.1");
+    if (avx2 && ymmState) printf(" avx2");
+    if (avx512f && zmmState) printf(" avx512f");
+    printf("\n");
+}
+
+// Binds sumKernel; SCOREBENCH_SUM_KERNEL overrides the automatic choice.
+void selectSumKernel(void) {
+    detectCpuFeatures();
+
+    int chosen = NUM_KERNELS - 1;
+    for (int k = 0; k < NUM_KERNELS; k++) {
+        if (kernels[k].supported) { chosen = k; break; }
+    }
+    const char *how = "automatic";
+
+    const char *override = getenv("SCOREBENCH_SUM_KERNEL");
+    if (override && *override) {
+        int found = -1;
+        for (int k = 0; k < NUM_KERNELS; k++) {
+            if (strcmp(kernels[k].name, override) == 0) found = k;
+        }
+        if (found < 0) {
+            fprintf(stderr, "SCOREBENCH_SUM_KERNEL=%s is unknown, using %s\n", override, kernels[chosen].name);
+        } else if (!kernels[found].supported) {
+            fprintf(stderr, "SCOREBENCH_SUM_KERNEL=%s is not supported by this CPU, using %s\n",
+                    override, kernels[chosen].name);
+        } else {
+            chosen = found;
+            how = "SCOREBENCH_SUM_KERNEL";
+        }
+    }
+
+    sumKernel = kernels[chosen].fn;
+    sumKernelName = kernels[chosen].name;
+    printf("Selected kernel: %s (%s)\n", sumKernelName, how);
+}
+
+// Thread entry point: sums its range with the dispatched kernel
+void *simdSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    data->result = sumKernel(data->records, data->start, data->end);
+    return NULL;
+}
+
+int calPoints(char *ops[], int size) {
+    static int records[MAX_OPERATIONS];
+    int index = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+
+    if (index < 500) return sumKernel(records, 0, index);
+
+    pthread_t threads[NUM_THREADS];
+    ThreadData data[NUM_THREADS];
+    int mid = index / NUM_THREADS;
+
+    for (int i = 0; i < NUM_THREADS; i++) {
+        data[i] = (ThreadData){records, i * mid, (i == NUM_THREADS - 1) ? index : (i + 1) * mid, 0};
+        pthread_create(&threads[i], NULL, simdSum, &data[i]);
+    }
+
+    int totalSum = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        totalSum += data[i].result;
+    }
+    return totalSum;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    static int records[MAX_OPERATIONS];
+
+    selectSumKernel();
+
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+    for (int i = 0; i < MAX_OPERATIONS; i++) records[i] = (i % 2) ? 20 : 10;
+
+    int failed = 0;
+    int reference = sumScalar(records, 0, MAX_OPERATIONS);
+    for (int k = 0; k < NUM_KERNELS; k++) {
+        if (!kernels[k].supported) {
+            printf("  %-7s not supported\n", kernels[k].name);
+            continue;
+        }
+        int result = 0;
+        double start = nowMs();
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            result = kernels[k].fn(records, 0, MAX_OPERATIONS - run % 3);  // Vary the tail
+        }
+        double elapsed = nowMs() - start;
+        result = kernels[k].fn(records, 0, MAX_OPERATIONS);
+        printf("  %-7s %.2f GB/s, Result: %d\n", kernels[k].name,
+               (double)MAX_OPERATIONS * sizeof(int) * BENCH_RUNS / (elapsed * 1e6), result);
+        failed |= (result != reference);
+    }
+
+    double start = nowMs();
+    int result = calPoints(largeOps, MAX_OPERATIONS);
+    double end = nowMs();
+    printf("Dispatched calPoints (%s): %.3f ms, Result: %d\n", sumKernelName, end - start, result);
+
+    if (failed || result != 15000000) {
+        fprintf(stderr, "Mismatch between kernel results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
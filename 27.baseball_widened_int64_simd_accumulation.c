@@ -0,0 +1,367 @@
+/*
+ * Widened 64-bit SIMD Accumulation (and Overflow-Trapping Variants) at Full Bandwidth
+
+   Why Widen?
+
+   Every kernel so far accumulates with _mm256_add_epi32 into an `int`. Real games with large
+   scores or long "+"/"D" chains wrap silently: "1" followed by 40 "D"s scores 2^41 - 1, and the
+   32-bit pipeline prints -1. (Files 10 and 11 used to print 5000000 for the 15,000,000 input,
+   because every "D" went through atoi() and became 0; they now evaluate C/D/+ like file 1.)
+
+   Reducers
+   --------
+   - sumInt32:           the current kernel: one _mm256_add_epi32 accumulator, wraps.
+   - sumWidened:         int32 records, int64 lanes: _mm256_cvtepi32_epi64 widens each half of a
+                         load and FOUR independent int64 accumulators hide the add latency, so
+                         the extra shuffles stay under the memory bandwidth limit.
+   - sumWidenedChecked:  same, but traps (returns SCORE_OVERFLOW) if the total does not fit the
+                         `int` that calPoints returns.
+   - sumInt64:           int64 records (needed once single records exceed 32 bits), four
+                         _mm256_add_epi64 accumulators.
+   - sumInt64Checked:    same, with signed-overflow detection per lane: an add overflowed iff
+                         both inputs have the sign the result lacks, ((a ^ r) & (b ^ r)) < 0.
+                         The sign bits are OR-ed up and checked once at the end.
+
+   Evaluation has the same two flavours: calPoints64() keeps int64 records, and the checked
+   version uses __builtin_add_overflow / __builtin_mul_overflow on every "D" and "+".
+
+   Bandwidth
+   ---------
+   The benchmark runs every reducer on an L3-sized buffer (1M ints) and on a DRAM-sized buffer
+   (BIG_ELEMENTS ints) and prints GB/s of record bytes read. From DRAM all 32-bit-input
+   reducers should run at the same GB/s as sumInt32. int64 records are twice the bytes, so the
+   same GB/s means half the records per second.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (expected 15,000,000).
+   - "1000000000" three times: each record fits an int, the total (3,000,000,000) does not.
+   - "1" followed by 40 "D"s (expected 2199023255551; wraps to -1 in 32 bits).
+   - "1" followed by 70 "D"s (overflows int64: the checked path must trap).
+
+   Expected Output
+   ---------------
+   Large input: 32-bit 15000000, 64-bit 15000000
+   Three 10^9 scores: 32-bit -1294967296, widened 3000000000, checked: overflow trapped
+   Doubling chain x40: 32-bit -1, 64-bit 2199023255551
+   Doubling chain x70: checked 64-bit evaluation: overflow trapped
+   L3 (4 MB):     sumInt32 [GB/s] GB/s, sumWidened [GB/s] GB/s, ...
+   DRAM (256 MB): sumInt32 [GB/s] GB/s, sumWidened [GB/s] GB/s, ...
+
+   gcc -mavx2 -O3 27.baseball_widened_int64_simd_accumulation.c -o baseball_widened
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), malloc()
+#include <string.h>       // strcmp()
+#include <ctype.h>        // isdigit()
+#include <stdint.h>       // int64_t
+#include <limits.h>       // INT_MIN, INT_MAX
+#include <immintrin.h>    // AVX2 intrinsics
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define BIG_ELEMENTS (64 << 20)     // 256 MB of int32 records (DRAM-sized)
+#define BENCH_BYTES (2048L << 20)   // Bytes streamed per reducer and buffer size
+#define SCORE_OK 0
+#define SCORE_OVERFLOW -1
+
+// Current kernel: one 32-bit accumulator (wraps on overflow)
+int sumInt32(const int *records, int start, int end) {
+    __m256i sumVec = _mm256_setzero_si256();
+    int i;
+
+    for (i = start; i + 7 < end; i += 8) {
+        __m256i values = _mm256_loadu_si256((const __m256i *)&records[i]);
+        sumVec = _mm256_add_epi32(sumVec, values);
+    }
+
+    int sumArray[8];
+    _mm256_storeu_si256((__m256i *)sumArray, sumVec);
+    unsigned sum = 0;
+    for (int k = 0; k < 8; k++) sum += (unsigned)sumArray[k];
+    for (; i < end; i++) sum += (unsigned)records[i];
+    return (int)sum;
+}
+
+static inline int64_t horizontalSum64(__m256i v) {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+}
+
+// int32 records, int64 total: four independent widened accumulators
+int64_t sumWidened(const int *records, int start, int end) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+    int i;
+
+    for (i = start; i + 15 < end; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)&records[i]);
+        __m256i b = _mm256_loadu_si256((const __m256i *)&records[i + 8]);
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(a)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(a, 1)));
+        acc2 = _mm256_add_epi64(acc2, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(b)));
+        acc3 = _mm256_add_epi64(acc3, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(b, 1)));
+    }
+
+    __m256i acc = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    int64_t sum = horizontalSum64(acc);
+    for (; i < end; i++) sum += records[i];
+    return sum;
+}
+
+// Fewer than 2^32 int32 values cannot overflow int64; trap if the total does not fit an int.
+int sumWidenedChecked(const int *records, int start, int end, int *result) {
+    int64_t sum = sumWidened(records, start, end);
+    if (sum < INT_MIN || sum > INT_MAX) return SCORE_OVERFLOW;
+    *result = (int)sum;
+    return SCORE_OK;
+}
+
+// int64 records: four independent 64-bit accumulators (wraps on overflow)
+int64_t sumInt64(const int64_t *records, int start, int end) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+    int i;
+
+    for (i = start; i + 15 < end; i += 16) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256((const __m256i *)&records[i]));
+        acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256((const __m256i *)&records[i + 4]));
+        acc2 = _mm256_add_epi64(acc2, _mm256_loadu_si256((const __m256i *)&records[i + 8]));
+        acc3 = _mm256_add_epi64(acc3, _mm256_loadu_si256((const __m256i *)&records[i + 12]));
+    }
+
+    __m256i acc = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    uint64_t sum = (uint64_t)horizontalSum64(acc);
+    for (; i < end; i++) sum += (uint64_t)records[i];
+    return (int64_t)sum;
+}
+
+// Signed int64 add that also collects an overflow sign bit per lane.
+static inline __m256i addTrack64(__m256i acc, __m256i v, __m256i *overflow) {
+    __m256i r = _mm256_add_epi64(acc, v);
+    __m256i o = _mm256_and_si256(_mm256_xor_si256(acc, r), _mm256_xor_si256(v, r));
+    *overflow = _mm256_or_si256(*overflow, o);
+    return r;
+}
+
+// int64 records with overflow trapping. Returns SCORE_OK or SCORE_OVERFLOW.
+int sumInt64Checked(const int64_t *records, int start, int end, int64_t *result) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+    __m256i overflow = _mm256_setzero_si256();
+    int i;
+
+    for (i = start; i + 15 < end; i += 16) {
+        acc0 = addTrack64(acc0, _mm256_loadu_si256((const __m256i *)&records[i]), &overflow);
+        acc1 = addTrack64(acc1, _mm256_loadu_si256((const __m256i *)&records[i + 4]), &overflow);
+        acc2 = addTrack64(acc2, _mm256_loadu_si256((const __m256i *)&records[i + 8]), &overflow);
+        acc3 = addTrack64(acc3, _mm256_loadu_si256((const __m256i *)&records[i + 12]), &overflow);
+    }
+    if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0) return SCORE_OVERFLOW;
+
+    // Combine the 16 lane sums and the tail one by one, checking every add
+    int64_t lanes[16];
+    _mm256_storeu_si256((__m256i *)&lanes[0], acc0);
+    _mm256_storeu_si256((__m256i *)&lanes[4], acc1);
+    _mm256_storeu_si256((__m256i *)&lanes[8], acc2);
+    _mm256_storeu_si256((__m256i *)&lanes[12], acc3);
+
+    int64_t sum = 0;
+    for (int k = 0; k < 16; k++) {
+        if (__builtin_add_overflow(sum, lanes[k], &sum)) return SCORE_OVERFLOW;
+    }
+    for (; i < end; i++) {
+        if (__builtin_add_overflow(sum, records[i], &sum)) return SCORE_OVERFLOW;
+    }
+    *result = sum;
+    return SCORE_OK;
+}
+
+static inline int isNumber(const char *op) {
+    return isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]));
+}
+
+// 32-bit evaluation as in the existing files (wraps, made well-defined with unsigned math)
+int calPoints32(char *ops[], int size, int *records) {
+    int index = 0;
+    for (int i = 0; i < size; i++) {
+        if (isNumber(ops[i])) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            index++;
+        }
+    }
+    return sumInt32(records, 0, index);
+}
+
+// 64-bit evaluation. With checked != 0 every "D" and "+" traps on overflow.
+int calPoints64(char *ops[], int size, int64_t *records, int checked, int64_t *result) {
+    int index = 0;
+    for (int i = 0; i < size; i++) {
+        if (isNumber(ops[i])) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            if (checked) {
+                if (__builtin_mul_overflow(records[index - 1], (int64_t)2, &records[index])) return SCORE_OVERFLOW;
+            } else {
+                records[index] = (int64_t)(2u * (uint64_t)records[index - 1]);
+            }
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            if (checked) {
+                if (__builtin_add_overflow(records[index - 1], records[index - 2], &records[index])) return SCORE_OVERFLOW;
+            } else {
+                records[index] = (int64_t)((uint64_t)records[index - 1] + (uint64_t)records[index - 2]);
+            }
+            index++;
+        }
+    }
+    if (checked) return sumInt64Checked(records, 0, index, result);
+    *result = sumInt64(records, 0, index);
+    return SCORE_OK;
+}
+
+// Keeps the compiler from hoisting a pure reducer call out of the benchmark loop
+static inline void clobberMemory(void) {
+    __asm__ volatile("" : : : "memory");
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Streams BENCH_BYTES through every reducer over `count` records. Returns 0 if all agree.
+int benchmarkReducers(const char *label, const int *records32, const int64_t *records64, int count) {
+    int runs = (int)(BENCH_BYTES / ((long)count * (long)sizeof(int)));
+    if (runs < 1) runs = 1;
+    volatile int64_t sink = 0;
+    int failed = 0;
+    double start, ms32, msWide, msWideChecked, ms64, ms64Checked;
+    int64_t expected = sumWidened(records32, 0, count);
+
+    start = nowMs();
+    for (int r = 0; r < runs; r++) {
+        clobberMemory();
+        sink += sumInt32(records32, 0, count);
+    }
+    ms32 = nowMs() - start;
+
+    start = nowMs();
+    for (int r = 0; r < runs; r++) {
+        clobberMemory();
+        sink += sumWidened(records32, 0, count);
+    }
+    msWide = nowMs() - start;
+
+    start = nowMs();
+    for (int r = 0; r < runs; r++) {
+        int result;
+        clobberMemory();
+        failed |= (sumWidenedChecked(records32, 0, count, &result) != SCORE_OK || result != expected);
+    }
+    msWideChecked = nowMs() - start;
+
+    // int64 records are twice the bytes: half the passes for the same traffic
+    int runs64 = runs / 2 > 0 ? runs / 2 : 1;
+    start = nowMs();
+    for (int r = 0; r < runs64; r++) {
+        clobberMemory();
+        sink += sumInt64(records64, 0, count);
+    }
+    ms64 = nowMs() - start;
+
+    start = nowMs();
+    for (int r = 0; r < runs64; r++) {
+        int64_t result;
+        clobberMemory();
+        failed |= (sumInt64Checked(records64, 0, count, &result) != SCORE_OK || result != expected);
+    }
+    ms64Checked = nowMs() - start;
+    (void)sink;
+
+    double bytes32 = (double)count * sizeof(int) * runs;
+    double bytes64 = (double)count * sizeof(int64_t) * runs64;
+    printf("%s: sumInt32 %.2f GB/s, sumWidened %.2f GB/s, sumWidenedChecked %.2f GB/s, "
+           "sumInt64 %.2f GB/s, sumInt64Checked %.2f GB/s\n", label,
+           bytes32 / (ms32 * 1e6), bytes32 / (msWide * 1e6), bytes32 / (msWideChecked * 1e6),
+           bytes64 / (ms64 * 1e6), bytes64 / (ms64Checked * 1e6));
+    return failed;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    static int records32[MAX_OPERATIONS];
+    static int64_t records64[MAX_OPERATIONS];
+    int failed = 0;
+
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+    int64_t result64;
+    int result32 = calPoints32(largeOps, MAX_OPERATIONS, records32);
+    calPoints64(largeOps, MAX_OPERATIONS, records64, 1, &result64);
+    printf("Large input: 32-bit %d, 64-bit %lld\n", result32, (long long)result64);
+    failed |= (result32 != 15000000 || result64 != 15000000);
+
+    // Three 10^9 scores: every record fits an int, the total does not
+    char *bigScores[] = {"1000000000", "1000000000", "1000000000"};
+    int checked32;
+    result32 = calPoints32(bigScores, 3, records32);
+    int status = sumWidenedChecked(records32, 0, 3, &checked32);
+    printf("Three 10^9 scores: 32-bit %d, widened %lld, checked: %s\n", result32,
+           (long long)sumWidened(records32, 0, 3), status == SCORE_OVERFLOW ? "overflow trapped" : "NOT trapped");
+    failed |= (status != SCORE_OVERFLOW || sumWidened(records32, 0, 3) != 3000000000LL);
+
+    // Doubling chains: 2^41 - 1 wraps in 32 bits, 2^71 - 1 does not fit in 64 bits
+    char *chain[71];
+    chain[0] = "1";
+    for (int i = 1; i < 71; i++) chain[i] = "D";
+
+    result32 = calPoints32(chain, 41, records32);
+    calPoints64(chain, 41, records64, 1, &result64);
+    printf("Doubling chain x40: 32-bit %d, 64-bit %lld\n", result32, (long long)result64);
+    failed |= (result64 != 2199023255551LL);
+
+    status = calPoints64(chain, 71, records64, 1, &result64);
+    printf("Doubling chain x70: checked 64-bit evaluation: %s\n",
+           status == SCORE_OVERFLOW ? "overflow trapped" : "NOT trapped");
+    failed |= (status != SCORE_OVERFLOW);
+
+    // Bandwidth: L3-sized and DRAM-sized buffers
+    for (int i = 0; i < MAX_OPERATIONS; i++) {
+        records32[i] = (i % 2) ? 20 : 10;
+        records64[i] = records32[i];
+    }
+    failed |= benchmarkReducers("L3 (4 MB)", records32, records64, MAX_OPERATIONS);
+
+    int *big32 = malloc((size_t)BIG_ELEMENTS * sizeof(int));
+    int64_t *big64 = malloc((size_t)BIG_ELEMENTS * sizeof(int64_t));
+    if (big32 && big64) {
+        for (int i = 0; i < BIG_ELEMENTS; i++) {
+            big32[i] = (i % 7) - 3;
+            big64[i] = big32[i];
+        }
+        failed |= benchmarkReducers("DRAM (256 MB)", big32, big64, BIG_ELEMENTS);
+    }
+    free(big32);
+    free(big64);
+
+    if (failed) {
+        fprintf(stderr, "Mismatch between widened and reference results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
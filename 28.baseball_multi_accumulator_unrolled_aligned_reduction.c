@@ -0,0 +1,242 @@
+/*
+ * Multi-Accumulator, Unrolled, Alignment-Aware Reduction Kernel (AVX2)
+
+   Why Another Kernel?
+
+   Every simdSum so far has one `sumVec` dependency chain: each _mm256_add_epi32 waits for the
+   previous one, so the loop retires at most one vector add per cycle (one per add latency),
+   while the core could issue two or three loads and adds per cycle. Files 9, 10 and 11 also
+   used _mm256_load_si256 on &records[start], which is only valid when the split lands on a
+   32-byte boundary (they now peel to the boundary first).
+
+   sumUnrolled(records, start, end):
+
+   1. Peel:      scalar adds until &records[i] is 32-byte aligned (at most 7 elements), so
+                 every load in the main loop is an aligned load and no load splits a cache line.
+   2. Main loop: NUM_ACCUMULATORS (8) independent accumulators, 64 ints (4 cache lines) per
+                 iteration, with a software prefetch PREFETCH_DISTANCE bytes ahead.
+   3. Vectors:   leftover whole vectors go into accumulator 0.
+   4. Tail:      the last 1-7 elements are read with _mm256_maskload_epi32 (lanes past the end
+                 are neither read nor faulted), replacing the scalar remainder loop.
+
+   Microbenchmark
+   --------------
+   The working set is sized to half of L1, L2 and L3 (from sysconf) and to DRAM_BYTES. For each
+   size it streams roughly BENCH_BYTES through the current single-accumulator kernel and through
+   sumUnrolled, from an aligned and a misaligned (start + 3) offset, and prints GB/s.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (expected 15,000,000), summed by both kernels.
+   - Random lengths and offsets checked against a scalar sum (peel and tail paths).
+
+   Expected Output
+   ---------------
+   Result: current 15000000, unrolled 15000000
+   Random lengths/offsets: OK
+   L1   ([n] KB): current [GB/s] GB/s, unrolled [GB/s] GB/s, unrolled misaligned [GB/s] GB/s
+   L2   ([n] KB): ...
+   L3   ([n] KB): ...
+   DRAM (262144 KB): ...
+
+   gcc -mavx2 -O3 28.baseball_multi_accumulator_unrolled_aligned_reduction.c -o baseball_unrolled
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), aligned_alloc(), rand()
+#include <string.h>       // strcmp()
+#include <ctype.h>        // isdigit()
+#include <stdint.h>       // uintptr_t
+#include <immintrin.h>    // AVX2 intrinsics, _mm_prefetch()
+#include <unistd.h>       // sysconf()
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define NUM_ACCUMULATORS 8            // Independent dependency chains in the main loop
+#define PREFETCH_DISTANCE 1024        // Bytes ahead of the loads (16 cache lines)
+#define DRAM_BYTES (256L << 20)
+#define BENCH_BYTES (2048L << 20)     // Bytes streamed per kernel and size
+#define RANDOM_CHECKS 2000
+
+// The current kernel: one accumulator, unaligned loads, scalar remainder
+int sumSingle(const int *records, int start, int end) {
+    __m256i sumVec = _mm256_setzero_si256();
+    int i;
+
+    for (i = start; i + 7 < end; i += 8) {
+        __m256i values = _mm256_loadu_si256((const __m256i *)&records[i]);
+        sumVec = _mm256_add_epi32(sumVec, values);
+    }
+
+    int sumArray[8];
+    _mm256_storeu_si256((__m256i *)sumArray, sumVec);
+    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+              sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
+
+    for (; i < end; i++) {
+        sum += records[i];
+    }
+    return sum;
+}
+
+static inline int horizontalSum32(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+
+// Peel to alignment, 8 accumulators with prefetch, masked-load tail
+int sumUnrolled(const int *records, int start, int end) {
+    int i = start;
+    int peel = 0;
+
+    // 1. Peel to a 32-byte boundary
+    while (i < end && ((uintptr_t)&records[i] & 31) != 0) {
+        peel += records[i++];
+    }
+
+    // 2. Main loop: 8 independent chains, 64 ints per iteration
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+    __m256i acc4 = _mm256_setzero_si256(), acc5 = _mm256_setzero_si256();
+    __m256i acc6 = _mm256_setzero_si256(), acc7 = _mm256_setzero_si256();
+
+    for (; i + 8 * NUM_ACCUMULATORS - 1 < end; i += 8 * NUM_ACCUMULATORS) {
+        const char *ahead = (const char *)&records[i] + PREFETCH_DISTANCE;
+        _mm_prefetch(ahead, _MM_HINT_T0);
+        _mm_prefetch(ahead + 64, _MM_HINT_T0);
+        _mm_prefetch(ahead + 128, _MM_HINT_T0);
+        _mm_prefetch(ahead + 192, _MM_HINT_T0);
+
+        const __m256i *p = (const __m256i *)&records[i];
+        acc0 = _mm256_add_epi32(acc0, _mm256_load_si256(p + 0));
+        acc1 = _mm256_add_epi32(acc1, _mm256_load_si256(p + 1));
+        acc2 = _mm256_add_epi32(acc2, _mm256_load_si256(p + 2));
+        acc3 = _mm256_add_epi32(acc3, _mm256_load_si256(p + 3));
+        acc4 = _mm256_add_epi32(acc4, _mm256_load_si256(p + 4));
+        acc5 = _mm256_add_epi32(acc5, _mm256_load_si256(p + 5));
+        acc6 = _mm256_add_epi32(acc6, _mm256_load_si256(p + 6));
+        acc7 = _mm256_add_epi32(acc7, _mm256_load_si256(p + 7));
+    }
+
+    // 3. Remaining whole vectors
+    for (; i + 7 < end; i += 8) {
+        acc0 = _mm256_add_epi32(acc0, _mm256_load_si256((const __m256i *)&records[i]));
+    }
+
+    // 4. Tail: masked load of the last 1-7 elements
+    if (i < end) {
+        __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(end - i), lanes);
+        acc1 = _mm256_add_epi32(acc1, _mm256_maskload_epi32(&records[i], mask));
+    }
+
+    __m256i acc = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(acc0, acc1), _mm256_add_epi32(acc2, acc3)),
+                                   _mm256_add_epi32(_mm256_add_epi32(acc4, acc5), _mm256_add_epi32(acc6, acc7)));
+    return peel + horizontalSum32(acc);
+}
+
+// Keeps the compiler from hoisting a pure kernel call out of the benchmark loop
+static inline void clobberMemory(void) {
+    __asm__ volatile("" : : : "memory");
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// GB/s of kernel over records[start, start + count), about BENCH_BYTES streamed.
+double measure(int (*kernel)(const int *, int, int), const int *records, int start, int count) {
+    long runs = BENCH_BYTES / ((long)count * (long)sizeof(int));
+    if (runs < 1) runs = 1;
+    volatile int sink = 0;
+
+    kernel(records, start, start + count);  // Warm the cache level under test
+    double begin = nowMs();
+    for (long r = 0; r < runs; r++) {
+        clobberMemory();
+        sink += kernel(records, start, start + count);
+    }
+    double elapsed = nowMs() - begin;
+    (void)sink;
+    return (double)count * sizeof(int) * runs / (elapsed * 1e6);
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    static int records[MAX_OPERATIONS] __attribute__((aligned(32)));
+
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+
+    int index = 0;
+    for (int i = 0; i < MAX_OPERATIONS; i++) {
+        if (isdigit(largeOps[i][0]) || (largeOps[i][0] == '-' && isdigit(largeOps[i][1]))) {
+            records[index++] = atoi(largeOps[i]);
+        } else if (strcmp(largeOps[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(largeOps[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(largeOps[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+
+    int current = sumSingle(records, 0, index);
+    int unrolled = sumUnrolled(records, 0, index);
+    printf("Result: current %d, unrolled %d\n", current, unrolled);
+    int failed = (current != 15000000 || unrolled != 15000000);
+
+    // Every peel length, tail length and short range
+    srand(1);
+    for (int k = 0; k < MAX_OPERATIONS; k++) records[k] = rand() % 2001 - 1000;
+    for (int t = 0; t < RANDOM_CHECKS; t++) {
+        int start = rand() % 4096;
+        int length = (t < 200) ? t : rand() % (MAX_OPERATIONS - start);
+        int expected = 0;
+        for (int k = start; k < start + length; k++) expected += records[k];
+        if (sumUnrolled(records, start, start + length) != expected) failed = 1;
+    }
+    printf("Random lengths/offsets: %s\n", failed ? "FAILED" : "OK");
+
+    // Working sets at half of each cache level, and DRAM
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE), l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    struct { const char *name; long bytes; } levels[] = {
+        {"L1", l1 > 0 ? l1 / 2 : 16L << 10},
+        {"L2", l2 > 0 ? l2 / 2 : 512L << 10},
+        {"L3", l3 > 0 ? l3 / 2 : 16L << 20},
+        {"DRAM", DRAM_BYTES},
+    };
+
+    int *buffer = aligned_alloc(64, DRAM_BYTES + 64);
+    if (!buffer) {
+        fprintf(stderr, "Could not allocate the benchmark buffer\n");
+        return EXIT_FAILURE;
+    }
+    for (long k = 0; k < DRAM_BYTES / (long)sizeof(int) + 16; k++) buffer[k] = (int)(k & 7);
+
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        int count = (int)(levels[l].bytes / sizeof(int));
+        printf("%-4s (%ld KB): current %.2f GB/s, unrolled %.2f GB/s, unrolled misaligned %.2f GB/s\n",
+               levels[l].name, levels[l].bytes >> 10,
+               measure(sumSingle, buffer, 0, count),
+               measure(sumUnrolled, buffer, 0, count),
+               measure(sumUnrolled, buffer, 3, count));
+    }
+    free(buffer);
+
+    if (failed) {
+        fprintf(stderr, "Mismatch between unrolled and reference results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,469 @@
+/*
+ * Cache-Blocked Fused Parse -> Evaluate -> Reduce Pipeline (L2-Sized Tiles)
+
+   Why Fuse?
+
+   4.baseball_parallel_bench_large_test_cases.c parses all operations into `records` and then
+   reads `records` a second time to sum it. Once the input is larger than the last-level cache,
+   that is two trips through DRAM for the records (written, and read back) on top of the pass
+   over the ops. The records array is only an intermediate: the answer is its sum.
+
+   Tiles
+   -----
+   The ops are cut into tiles of tileOps operations, sized so the tile's op pointers plus the
+   per-worker scratch (three unsigned coefficients per op) fill about half of L2. Workers take
+   tiles from a shared counter and, for each tile:
+
+   1. Parse + evaluate the tile against a symbolic inherited stack (the segment summary of
+      13.baseball_parallel_segment_summary_full_stack_eval.c): survivor i = c + a * x1 + b * x2.
+   2. Reduce it immediately, while the scratch is still in L2: sumC, sumA, sumB over all
+      survivors, and a copy of the top TAIL_KEEP survivors.
+
+   The scratch is reused by the next tile, so no records array is ever materialized. A tile
+   summary is about 420 bytes regardless of the tile length.
+
+   Combining the Summaries
+   -----------------------
+   The prefix pass of file 13 runs over the tile summaries in order (stack depth, concrete
+   x1/x2, bounded replay for shallow stacks). A tile's contribution is then
+
+       sumC + sumA * x1 + sumB * x2 - (survivors popped by later tiles)
+
+   Later tiles can only pop survivors from the top, which are in the tail copy. Only if a later
+   tile pops deeper than TAIL_KEEP into a tile (long runs of "C") is that tile re-evaluated from
+   its ops to recover the full survivor list; the ops are read again, but no records array is.
+
+   Memory Traffic (estimated, per pass)
+   -----------------------------------
+   - Two-pass (file 4):  ops pointers + records written (plus write-allocate read) + records read.
+   - Fused tiles:         ops pointers + tile summaries.
+   For "10", "D" every op leaves a record, so the records cost 12 bytes per op against 8 for
+   the op pointer: the fused pipeline moves well under half the bytes (8 MB instead of 20 MB
+   for the 1M-op input). The 1M-op input fits in a large L3; the 16M-op run
+   (BIG_OPERATIONS) does not.
+
+   Input Explained
+   ---------------
+   - The seven test cases from 2.baseball_game_direct_update_sum_store_converted_values.c.
+   - "10", "D" repeated 500,000 times (expected 15,000,000), as generated by file 4.
+   - "10", "D" repeated 8,000,000 times (expected 240,000,000).
+   - Random operations (numbers, "C", "D", "+") cross-checked against the two-pass evaluator.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Tile: [n] ops ([n] KB of L2 per worker)
+   1M ops:  Two-pass: [time_ms] ms, Result: 15000000
+   1M ops:  Fused tiles: [time_ms] ms, Result: 15000000
+   1M ops:  Estimated traffic: two-pass [n] MB, fused [n] MB
+   16M ops: ...
+   Random ops cross-check: OK
+
+   gcc -pthread -O3 29.baseball_cache_blocked_fused_parse_eval_reduce_pipeline.c -o baseball_fused_tiles
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), malloc(), free()
+#include <string.h>       // strcmp(), memcpy()
+#include <ctype.h>        // isdigit()
+#include <pthread.h>      // pthreads for the tile workers
+#include <stdatomic.h>    // Shared tile counter
+#include <unistd.h>       // sysconf()
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define BIG_OPERATIONS 16000000   // Larger than L3: ops 128 MB, records 64 MB
+#define NUM_THREADS 4
+#define NUM_TWO_PASS_THREADS 2    // As in file 4
+#define TAIL_KEEP 32              // Top survivors copied out of every tile
+#define MIN_TILE_OPS 1024
+#define MAX_TILE_OPS 65536
+#define BYTES_PER_TILE_OP (sizeof(char *) + 3 * sizeof(unsigned))
+
+// Summary of one tile. Only these (not the survivors) outlive the tile's scratch.
+typedef struct {
+    int start, end;       // Operations [start, end)
+
+    // Filled in by the workers (parse + evaluate + reduce)
+    int pops;             // Inherited records removed by this tile
+    int need;             // Minimum inherited depth for which the summary is exact
+    int count;            // Survivors at the end of the tile
+    unsigned sumC, sumA, sumB;
+    int tailCount;        // min(count, TAIL_KEEP)
+    unsigned tailC[TAIL_KEEP], tailA[TAIL_KEEP], tailB[TAIL_KEEP];  // Survivors count - tailCount ..
+
+    // Full survivor list, only after a replay or a deep pop (NULL otherwise)
+    unsigned *fullC, *fullA, *fullB;
+
+    // Filled in by the prefix pass
+    int base;             // Stack position of the first survivor
+    unsigned x1, x2;      // Inherited top and second-from-top after the pops
+    int keep;             // Survivors not removed by later tiles
+} TileSummary;
+
+typedef struct {
+    char **ops;
+    TileSummary *tiles;
+    int numTiles, tileOps;
+    atomic_int nextTile;
+} TilePipeline;
+
+typedef struct {
+    int *records;
+    int start, end;
+    int result;
+} ThreadData;
+
+int tileOpsForL2(void) {
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    long ops = (l2 > 0 ? l2 / 2 : 256L << 10) / (long)BYTES_PER_TILE_OP;
+    if (ops < MIN_TILE_OPS) ops = MIN_TILE_OPS;
+    if (ops > MAX_TILE_OPS) ops = MAX_TILE_OPS;
+    return (int)ops;
+}
+
+// Symbolic evaluation of ops [start, end) into c/a/b (file 13's summarizeChunk).
+void summarizeTile(char **ops, TileSummary *s, unsigned *c, unsigned *a, unsigned *b) {
+    int n = 0, pops = 0, need = 0;
+
+    for (int i = s->start; i < s->end; i++) {
+        const char *op = ops[i];
+
+        if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) {
+            c[n] = (unsigned)atoi(op); a[n] = 0; b[n] = 0;
+            n++;
+        } else if (strcmp(op, "C") == 0) {
+            if (n > 0) {
+                n--;
+            } else {
+                pops++;
+                if (pops > need) need = pops;
+            }
+        } else if (strcmp(op, "D") == 0) {
+            if (n > 0) {
+                c[n] = 2u * c[n - 1]; a[n] = 2u * a[n - 1]; b[n] = 2u * b[n - 1];
+            } else {
+                if (pops + 1 > need) need = pops + 1;
+                c[n] = 0; a[n] = 2; b[n] = 0;
+            }
+            n++;
+        } else if (strcmp(op, "+") == 0) {
+            if (n > 1) {
+                c[n] = c[n - 1] + c[n - 2]; a[n] = a[n - 1] + a[n - 2]; b[n] = b[n - 1] + b[n - 2];
+            } else if (n == 1) {
+                if (pops + 1 > need) need = pops + 1;
+                c[n] = c[0]; a[n] = a[0] + 1; b[n] = b[0];
+            } else {
+                if (pops + 2 > need) need = pops + 2;
+                c[n] = 0; a[n] = 1; b[n] = 1;
+            }
+            n++;
+        }
+    }
+
+    s->pops = pops;
+    s->need = need;
+    s->count = n;
+}
+
+// Reduces the survivors while they are still in L2 and keeps the top TAIL_KEEP.
+void reduceTile(TileSummary *s, const unsigned *c, const unsigned *a, const unsigned *b) {
+    unsigned sumC = 0, sumA = 0, sumB = 0;
+    for (int i = 0; i < s->count; i++) {
+        sumC += c[i];
+        sumA += a[i];
+        sumB += b[i];
+    }
+    s->sumC = sumC;
+    s->sumA = sumA;
+    s->sumB = sumB;
+
+    int first = s->count > TAIL_KEEP ? s->count - TAIL_KEEP : 0;
+    s->tailCount = s->count - first;
+    memcpy(s->tailC, c + first, s->tailCount * sizeof(unsigned));
+    memcpy(s->tailA, a + first, s->tailCount * sizeof(unsigned));
+    memcpy(s->tailB, b + first, s->tailCount * sizeof(unsigned));
+}
+
+// Worker: parse, evaluate and reduce one tile at a time with L2-resident scratch.
+void *tileWorker(void *arg) {
+    TilePipeline *p = (TilePipeline *)arg;
+    unsigned *c = malloc(p->tileOps * sizeof(unsigned));
+    unsigned *a = malloc(p->tileOps * sizeof(unsigned));
+    unsigned *b = malloc(p->tileOps * sizeof(unsigned));
+
+    int t;
+    while ((t = atomic_fetch_add_explicit(&p->nextTile, 1, memory_order_relaxed)) < p->numTiles) {
+        summarizeTile(p->ops, &p->tiles[t], c, a, b);
+        reduceTile(&p->tiles[t], c, a, b);
+    }
+
+    free(c); free(a); free(b);
+    return NULL;
+}
+
+// Re-evaluates a tile to recover its full survivor list (deep pops only).
+void materializeTile(char **ops, TileSummary *s) {
+    int len = s->end - s->start > 0 ? s->end - s->start : 1;
+    s->fullC = malloc(len * sizeof(unsigned));
+    s->fullA = malloc(len * sizeof(unsigned));
+    s->fullB = malloc(len * sizeof(unsigned));
+    summarizeTile(ops, s, s->fullC, s->fullA, s->fullB);
+}
+
+// Coefficients of survivor i of tile s: from the tail copy when possible.
+void survivorAt(char **ops, TileSummary *s, int i, unsigned *c, unsigned *a, unsigned *b) {
+    int first = s->count - s->tailCount;
+    if (!s->fullC && i >= first) {
+        *c = s->tailC[i - first]; *a = s->tailA[i - first]; *b = s->tailB[i - first];
+        return;
+    }
+    if (!s->fullC) materializeTile(ops, s);
+    *c = s->fullC[i]; *a = s->fullA[i]; *b = s->fullB[i];
+}
+
+// Concrete value of stack position q, resolved from the tiles before `upto`.
+unsigned valueAt(char **ops, TileSummary *s, int upto, int q) {
+    for (int j = upto - 1; j >= 0; j--) {
+        if (q >= s[j].base && q < s[j].base + s[j].count) {
+            unsigned c, a, b;
+            survivorAt(ops, &s[j], q - s[j].base, &c, &a, &b);
+            return c + a * s[j].x1 + b * s[j].x2;
+        }
+    }
+    return 0; // Unreachable for q below the current depth
+}
+
+// Replays tile k concretely on the real inherited stack when that stack is shallower than
+// the summary requires (file 13's replayChunk). The tile then owns the whole stack.
+void replayTile(char **ops, TileSummary *s, int k, int depth) {
+    TileSummary *t = &s[k];
+    int capacity = depth + (t->end - t->start) + 1;
+    unsigned *stack = malloc(capacity * sizeof(unsigned));
+    int index = 0;
+
+    for (int q = 0; q < depth; q++) stack[index++] = valueAt(ops, s, k, q);
+
+    for (int i = t->start; i < t->end; i++) {
+        const char *op = ops[i];
+        if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) {
+            stack[index++] = (unsigned)atoi(op);
+        } else if (strcmp(op, "C") == 0) {
+            if (index > 0) index--;
+        } else if (strcmp(op, "D") == 0) {
+            if (index > 0) { stack[index] = 2u * stack[index - 1]; index++; }
+        } else if (strcmp(op, "+") == 0) {
+            if (index > 1) { stack[index] = stack[index - 1] + stack[index - 2]; index++; }
+        }
+    }
+
+    free(t->fullC); free(t->fullA); free(t->fullB);
+    t->fullC = stack;
+    t->fullA = calloc(index > 0 ? index : 1, sizeof(unsigned));
+    t->fullB = calloc(index > 0 ? index : 1, sizeof(unsigned));
+    t->pops = depth;
+    t->need = 0;
+    t->count = index;
+    t->x1 = t->x2 = 0;
+    reduceTile(t, t->fullC, t->fullA, t->fullB);
+}
+
+// Fused pipeline: tiles are parsed, evaluated and reduced by the workers; only the
+// summaries are combined here.
+int calPointsFused(char *ops[], int size, int tileOps) {
+    TilePipeline p;
+    p.ops = ops;
+    p.tileOps = tileOps;
+    p.numTiles = (size + tileOps - 1) / tileOps;
+    p.tiles = calloc(p.numTiles > 0 ? p.numTiles : 1, sizeof(TileSummary));
+    atomic_init(&p.nextTile, 0);
+    for (int t = 0; t < p.numTiles; t++) {
+        p.tiles[t].start = t * tileOps;
+        p.tiles[t].end = (t == p.numTiles - 1) ? size : (t + 1) * tileOps;
+    }
+
+    pthread_t threads[NUM_THREADS];
+    int workers = p.numTiles < NUM_THREADS ? p.numTiles : NUM_THREADS;
+    for (int i = 0; i < workers; i++) {
+        pthread_create(&threads[i], NULL, tileWorker, &p);
+    }
+    for (int i = 0; i < workers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Prefix pass: stack depth before every tile and its concrete x1/x2
+    TileSummary *s = p.tiles;
+    int depth = 0;
+    for (int k = 0; k < p.numTiles; k++) {
+        if (depth < s[k].need) {
+            replayTile(ops, s, k, depth);
+        } else {
+            int top = depth - s[k].pops;
+            s[k].x1 = (top >= 1) ? valueAt(ops, s, k, top - 1) : 0;
+            s[k].x2 = (top >= 2) ? valueAt(ops, s, k, top - 2) : 0;
+        }
+        s[k].base = depth - s[k].pops;
+        depth = s[k].base + s[k].count;
+    }
+
+    int limit = depth;
+    for (int k = p.numTiles - 1; k >= 0; k--) {
+        int keep = limit - s[k].base;
+        if (keep < 0) keep = 0;
+        if (keep > s[k].count) keep = s[k].count;
+        s[k].keep = keep;
+        if (s[k].base < limit) limit = s[k].base;
+    }
+
+    // Whole-tile sums minus the survivors popped by later tiles
+    unsigned totalSum = 0;
+    for (int k = 0; k < p.numTiles; k++) {
+        unsigned sum = s[k].sumC + s[k].sumA * s[k].x1 + s[k].sumB * s[k].x2;
+        for (int i = s[k].keep; i < s[k].count; i++) {
+            unsigned c, a, b;
+            survivorAt(ops, &s[k], i, &c, &a, &b);
+            sum -= c + a * s[k].x1 + b * s[k].x2;
+        }
+        totalSum += sum;
+        free(s[k].fullC); free(s[k].fullA); free(s[k].fullB);
+    }
+
+    free(p.tiles);
+    return (int)totalSum;
+}
+
+void *parallelSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    unsigned sum = 0;
+    for (int i = data->start; i < data->end; i++) sum += (unsigned)data->records[i];
+    data->result = (int)sum;
+    return NULL;
+}
+
+// Two-pass baseline (file 4): materialize every record, then sum them with two threads.
+int calPointsTwoPass(char *ops[], int size, int *records) {
+    int index = 0;
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            index++;
+        }
+    }
+
+    pthread_t threads[NUM_TWO_PASS_THREADS];
+    ThreadData data[NUM_TWO_PASS_THREADS];
+    int mid = index / NUM_TWO_PASS_THREADS;
+    for (int i = 0; i < NUM_TWO_PASS_THREADS; i++) {
+        data[i] = (ThreadData){records, i * mid, (i == NUM_TWO_PASS_THREADS - 1) ? index : (i + 1) * mid, 0};
+        pthread_create(&threads[i], NULL, parallelSum, &data[i]);
+    }
+    unsigned totalSum = 0;
+    for (int i = 0; i < NUM_TWO_PASS_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        totalSum += (unsigned)data[i].result;
+    }
+    return (int)totalSum;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Times both pipelines on the file-4 pattern with `pairs` "10", "D" pairs. Returns 0 on a match.
+int benchmark(const char *label, int pairs, int tileOps) {
+    int size = pairs * 2;
+    char **ops = malloc((size_t)size * sizeof(char *));
+    int *records = malloc((size_t)size * sizeof(int));
+    if (!ops || !records) {
+        fprintf(stderr, "Could not allocate %d operations\n", size);
+        free(ops); free(records);
+        return 1;
+    }
+    for (int i = 0; i < pairs; i++) {
+        ops[i * 2] = "10";
+        ops[i * 2 + 1] = "D";
+    }
+    memset(records, 0, (size_t)size * sizeof(int));  // Fault in before timing
+
+    double start = nowMs();
+    int result1 = calPointsTwoPass(ops, size, records);
+    double end = nowMs();
+    printf("%s Two-pass: %.3f ms, Result: %d\n", label, end - start, result1);
+
+    start = nowMs();
+    int result2 = calPointsFused(ops, size, tileOps);
+    end = nowMs();
+    printf("%s Fused tiles: %.3f ms, Result: %d\n", label, end - start, result2);
+
+    // Every op of this input leaves one record
+    double opsBytes = (double)size * sizeof(char *);
+    double recordBytes = (double)size * sizeof(int);
+    double summaryBytes = (double)((size + tileOps - 1) / tileOps) * sizeof(TileSummary);
+    printf("%s Estimated traffic: two-pass %.1f MB, fused %.1f MB\n", label,
+           (opsBytes + 3 * recordBytes) / 1e6, (opsBytes + summaryBytes) / 1e6);
+
+    free(ops);
+    free(records);
+    return result1 != result2 || result1 != pairs * 30;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    static int records[MAX_OPERATIONS];
+    int tileOps = tileOpsForL2();
+
+    char *testCases[][8] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int sizes[] = {5, 8, 1, 1, 2, 5, 6};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("Test %lu: %d\n", i + 1, calPointsFused(testCases[i], sizes[i], 2));
+    }
+
+    printf("Tile: %d ops (%lu KB of L2 per worker)\n", tileOps,
+           (unsigned long)(tileOps * BYTES_PER_TILE_OP) >> 10);
+    int failed = benchmark("1M ops: ", MAX_OPERATIONS / 2, tileOps);
+    failed |= benchmark("16M ops:", BIG_OPERATIONS / 2, tileOps);
+
+    // Random ops: pops across tile boundaries, deep pops past the tail copy, shallow replays.
+    // Small tiles put many boundaries into every round.
+    static char *pool[] = {"C", "D", "+", "1", "-3", "7", "12", "-40", "100"};
+    srand(42);
+    for (int round = 0; round < 20 && !failed; round++) {
+        int cWeight = round % 10;
+        for (int i = 0; i < MAX_OPERATIONS; i++) {
+            int r = rand() % (9 + cWeight);
+            largeOps[i] = (r >= 9) ? "C" : pool[r];
+        }
+        int expected = calPointsTwoPass(largeOps, MAX_OPERATIONS, records);
+        int tile = (round % 2) ? tileOps : 64 + round;
+        if (calPointsFused(largeOps, MAX_OPERATIONS, tile) != expected) {
+            fprintf(stderr, "Random ops cross-check failed in round %d!\n", round);
+            failed = 1;
+        }
+    }
+    if (!failed) printf("Random ops cross-check: OK\n");
+
+    if (failed) {
+        fprintf(stderr, "Mismatch between fused and two-pass results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
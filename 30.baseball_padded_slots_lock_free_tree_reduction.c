@@ -0,0 +1,455 @@
+/*
+ * Lock-Free, False-Sharing-Free Reduction of Partial Results (Padded Slots + Atomic Tree)
+
+   Why?
+
+   Every threaded variant hands partial sums back through `ThreadData data[NUM_THREADS]`. The
+   structs are packed (pointer + three ints = 24 bytes), so two or three workers write their
+   `result` into the same 64-byte cache line, and each write takes the line away from the
+   others (false sharing). 12.baseball_parallel_smid_avx_sse_multithreaded_for_numa_node_cpuaffinity_memory_usage_sync_lock.c
+   also took a global `sum_mutex` to write a `partial_sum` that no other thread writes, so
+   the mutex line moved between all workers as well (file 12 now pads its ThreadData and
+   drops the mutex). The main thread then reads every slot in a serial loop, which is
+   O(workers) after the last worker finished.
+
+   Reduction Layer
+   ---------------
+   - ReductionSlot: one worker's partial result per cache line (aligned and padded to
+     CACHE_LINE), so a worker can keep updating it without touching anyone else's line.
+   - Reducer: the slots plus a binary combining tree of TreeNodes. Every level halves the
+     count (the last node of an odd level has one child).
+   - reducerPublish(r, worker): climbs from the worker's slot. At every node the worker
+     deposits its value in its half of the node and does one atomic_fetch_add on the node's
+     arrival counter. The first child to arrive stops there; the last one adds both halves,
+     resets the counter for the next round and continues. Whoever completes the root stores
+     the total and sets `done`.
+
+   No thread ever waits or takes a lock, each node line is shared by exactly two workers, and
+   the combine finishes O(log2 workers) steps after the last worker, in that worker's thread.
+   The acq_rel fetch_add orders the deposit before the arrival, so the combiner always sees
+   both halves. Up to MAX_WORKERS (256) workers are supported.
+
+   Benchmark
+   ---------
+   Persistent workers sum their share of the file-4 records every round (start/finish barriers)
+   and publish it in one of three ways:
+
+   - packed + mutex:  file 12 before its fix (lock sum_mutex, write the packed slot, unlock;
+                      main sums).
+   - packed:          files 3-11 (write the packed slot; main sums).
+   - padded tree:     reducerPublish (the total is ready when the last worker returns).
+
+   Coherence traffic is counted in a separate, instrumented run: every access to a slot, tree
+   node or mutex records the accessing thread and datum per cache line. An access to a line
+   last used by a different thread is one line transfer, split into
+   - contention: the other thread used a different datum on the line (false sharing) or the
+     line holds a lock. This is the traffic the padded tree removes.
+   - hand-off:   the datum itself moves on (a partial result picked up by whoever adds it).
+     The tree pays up to two per node and round (the second child takes the node line, and
+     the next round's first child takes it back), so it moves more lines than the packed
+     gather. But they are spread over all workers with at most 2 * log2(workers) on the
+     critical path, while the packed slots are gathered by one serial loop on the main
+     thread after the last worker.
+   The timed run is not instrumented. A hot-update test also runs NUM_THREADS workers that
+   keep their running sum in their slot (the `data->result += ...` pattern), packed and padded.
+
+   Input Explained
+   ---------------
+   - "10", "D" repeated 500,000 times (expected 15,000,000), summed with 4 to 256 workers.
+
+   Expected Output
+   ---------------
+   Slot sizes: packed 24 bytes, padded 64 bytes
+   Hot slot updates (4 workers): packed [time_ms] ms, padded [time_ms] ms, Result: 15000000
+     4 workers, packed + mutex: [us] us/round, line transfers per round: [n] contention, [n] hand-off, Result: 15000000
+     4 workers, packed        : ...
+     4 workers, padded tree   : [us] us/round, line transfers per round:    0 contention, [n] hand-off, Result: 15000000
+    ... 16, 64, 128 and 256 workers
+
+   gcc -pthread -O3 30.baseball_padded_slots_lock_free_tree_reduction.c -o baseball_tree_reduce
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), aligned_alloc(), free()
+#include <string.h>       // strcmp(), memset()
+#include <ctype.h>        // isdigit()
+#include <stdint.h>       // uintptr_t
+#include <pthread.h>      // pthreads, barriers, sum_mutex
+#include <stdatomic.h>    // Arrival counters, line tracker
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define NUM_THREADS 4             // Workers in the hot-update test
+#define CACHE_LINE 64
+#define MAX_WORKERS 256
+#define MAX_LEVELS 10             // ceil(log2(MAX_WORKERS)) + 1
+#define ROUNDS 100                // Timed rounds per method and worker count
+#define COUNTED_ROUNDS 10         // Instrumented rounds (line transfers are per round)
+#define TRACK_LINES 65536         // Cache lines tracked (address hash)
+
+typedef enum {
+    PUBLISH_PACKED_MUTEX,         // File 12
+    PUBLISH_PACKED,               // Files 3-11
+    PUBLISH_TREE                  // Padded slots + atomic combining tree
+} PublishMethod;
+
+// Packed per-thread data as in the existing files
+typedef struct {
+    int *records;
+    int start, end;
+    int result;
+} ThreadData;
+
+// One worker's partial result per cache line
+typedef struct {
+    long long value;
+} __attribute__((aligned(CACHE_LINE))) ReductionSlot;
+
+// Combining-tree node: both children deposit here, so a node is one line shared by two workers
+typedef struct {
+    long long value[2];           // Deposited by the left and right child
+    atomic_int arrivals;          // Children that have deposited this round
+} __attribute__((aligned(CACHE_LINE))) TreeNode;
+
+typedef struct {
+    int numWorkers, numLevels;
+    int levelStart[MAX_LEVELS];   // First node of every level in `nodes` (level 0: the slots)
+    int levelCount[MAX_LEVELS];
+    ReductionSlot *slots;         // One per worker
+    TreeNode *nodes;
+    long long total;              // Written by whoever completes the root
+    atomic_int done;
+} Reducer;
+
+typedef struct {
+    int *records;
+    int size;
+    int numWorkers;
+    PublishMethod method;
+    int rounds;
+    pthread_barrier_t start, finish;
+    pthread_mutex_t sum_mutex;
+    ThreadData *packed;
+    Reducer reducer;
+} ReductionBench;
+
+typedef struct {
+    ReductionBench *bench;
+    int worker;
+} WorkerArg;
+
+typedef struct {
+    double usPerRound;
+    long contention;              // Line transfers per round: false sharing and locks
+    long handoff;                 // Line transfers per round: partial results moving on
+} MethodStats;
+
+// Line tracker for the instrumented run: last thread (id + 1) and datum per cache line.
+// A line taken from another thread that used a different datum on it (or a lock) is
+// contention; a line taken because the datum itself is handed over is a hand-off.
+static atomic_int lineOwner[TRACK_LINES];
+static _Atomic uintptr_t lineDatum[TRACK_LINES];
+static atomic_long contentionTransfers, handoffTransfers;
+static int trackLines;
+
+static inline void touchLine(const void *datum, int who, int isLock) {
+    if (!trackLines) return;
+    int line = (int)(((uintptr_t)datum / CACHE_LINE) & (TRACK_LINES - 1));
+    int previous = atomic_exchange_explicit(&lineOwner[line], who + 1, memory_order_relaxed);
+    uintptr_t previousDatum = atomic_exchange_explicit(&lineDatum[line], (uintptr_t)datum, memory_order_relaxed);
+    if (previous != 0 && previous != who + 1) {
+        if (isLock || previousDatum != (uintptr_t)datum) {
+            atomic_fetch_add_explicit(&contentionTransfers, 1, memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(&handoffTransfers, 1, memory_order_relaxed);
+        }
+    }
+}
+
+int reducerInit(Reducer *r, int numWorkers) {
+    int total = 0, count = numWorkers, levels = 1;
+    r->levelStart[0] = 0;
+    r->levelCount[0] = numWorkers;
+    while (count > 1) {
+        count = (count + 1) / 2;
+        r->levelStart[levels] = total;
+        r->levelCount[levels] = count;
+        total += count;
+        levels++;
+    }
+    r->numWorkers = numWorkers;
+    r->numLevels = levels;
+    r->slots = aligned_alloc(CACHE_LINE, (size_t)numWorkers * sizeof(ReductionSlot));
+    r->nodes = aligned_alloc(CACHE_LINE, (size_t)(total > 0 ? total : 1) * sizeof(TreeNode));
+    if (!r->slots || !r->nodes) {
+        free(r->slots);
+        free(r->nodes);
+        return -1;
+    }
+    for (int i = 0; i < numWorkers; i++) r->slots[i].value = 0;
+    for (int i = 0; i < total; i++) {
+        r->nodes[i].value[0] = r->nodes[i].value[1] = 0;
+        atomic_init(&r->nodes[i].arrivals, 0);
+    }
+    r->total = 0;
+    atomic_init(&r->done, 0);
+    return 0;
+}
+
+void reducerFree(Reducer *r) {
+    free(r->slots);
+    free(r->nodes);
+    r->slots = NULL;
+    r->nodes = NULL;
+}
+
+// Publishes the worker's slot. Returns 1 if this call completed the total.
+int reducerPublish(Reducer *r, int worker) {
+    long long value = r->slots[worker].value;
+    int index = worker;
+
+    for (int level = 1; level < r->numLevels; level++) {
+        int parent = index / 2;
+        int children = (2 * parent + 1 < r->levelCount[level - 1]) ? 2 : 1;
+        TreeNode *node = &r->nodes[r->levelStart[level] + parent];
+
+        touchLine(node, worker, 0);
+        node->value[index & 1] = value;
+        if (atomic_fetch_add_explicit(&node->arrivals, 1, memory_order_acq_rel) != children - 1) {
+            return 0;  // The sibling is still working; it will carry our value up
+        }
+        atomic_store_explicit(&node->arrivals, 0, memory_order_relaxed);
+        if (children == 2) value = node->value[0] + node->value[1];
+        index = parent;
+    }
+
+    r->total = value;
+    atomic_store_explicit(&r->done, 1, memory_order_release);
+    return 1;
+}
+
+// Worker: per round, sum the own share of the records and publish it.
+void *reductionWorker(void *arg) {
+    WorkerArg *w = (WorkerArg *)arg;
+    ReductionBench *b = w->bench;
+    int chunk = b->size / b->numWorkers;
+    int start = w->worker * chunk;
+    int end = (w->worker == b->numWorkers - 1) ? b->size : start + chunk;
+
+    for (int round = 0; round < b->rounds; round++) {
+        pthread_barrier_wait(&b->start);
+
+        unsigned sum = 0;
+        for (int i = start; i < end; i++) sum += (unsigned)b->records[i];
+
+        ThreadData *slot = &b->packed[w->worker];
+        switch (b->method) {
+        case PUBLISH_PACKED_MUTEX:
+            touchLine(&b->sum_mutex, w->worker, 1);
+            pthread_mutex_lock(&b->sum_mutex);
+            touchLine(&slot->result, w->worker, 0);
+            slot->result = (int)sum;
+            pthread_mutex_unlock(&b->sum_mutex);
+            break;
+        case PUBLISH_PACKED:
+            touchLine(&slot->result, w->worker, 0);
+            slot->result = (int)sum;
+            break;
+        case PUBLISH_TREE:
+            b->reducer.slots[w->worker].value = (int)sum;
+            reducerPublish(&b->reducer, w->worker);
+            break;
+        }
+
+        pthread_barrier_wait(&b->finish);
+    }
+    return NULL;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Runs `rounds` reductions with one method. Returns the last total (or -1 if a round
+// differed) and stores the wall time per round.
+int runReduction(int *records, int size, int numWorkers, PublishMethod method, int rounds,
+                 double *usPerRound) {
+    ReductionBench b;
+    pthread_t threads[MAX_WORKERS];
+    WorkerArg args[MAX_WORKERS];
+    ThreadData packed[MAX_WORKERS];
+
+    b.records = records;
+    b.size = size;
+    b.numWorkers = numWorkers;
+    b.method = method;
+    b.rounds = rounds;
+    b.packed = packed;
+    memset(packed, 0, sizeof(packed));
+    pthread_barrier_init(&b.start, NULL, numWorkers + 1);
+    pthread_barrier_init(&b.finish, NULL, numWorkers + 1);
+    pthread_mutex_init(&b.sum_mutex, NULL);
+    if (reducerInit(&b.reducer, numWorkers) != 0) return -1;
+
+    for (int i = 0; i < numWorkers; i++) {
+        args[i] = (WorkerArg){&b, i};
+        pthread_create(&threads[i], NULL, reductionWorker, &args[i]);
+    }
+
+    int result = 0, consistent = 1;
+    double elapsed = 0;
+    for (int round = 0; round < rounds; round++) {
+        double begin = nowMs();
+        pthread_barrier_wait(&b.start);
+        pthread_barrier_wait(&b.finish);
+
+        unsigned total = 0;
+        if (method == PUBLISH_TREE) {
+            total = (unsigned)b.reducer.total;  // Completed by the last worker
+            atomic_store_explicit(&b.reducer.done, 0, memory_order_relaxed);
+        } else {
+            for (int i = 0; i < numWorkers; i++) {
+                touchLine(&packed[i].result, numWorkers, 0);
+                total += (unsigned)packed[i].result;
+            }
+        }
+        elapsed += nowMs() - begin;
+
+        if (round > 0 && (int)total != result) consistent = 0;
+        result = (int)total;
+    }
+
+    for (int i = 0; i < numWorkers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    reducerFree(&b.reducer);
+    pthread_mutex_destroy(&b.sum_mutex);
+    pthread_barrier_destroy(&b.start);
+    pthread_barrier_destroy(&b.finish);
+
+    *usPerRound = elapsed * 1000.0 / rounds;
+    return consistent ? result : -1;
+}
+
+// Times one method, then counts its line transfers per round in an instrumented run.
+int measureMethod(int *records, int size, int numWorkers, PublishMethod method, MethodStats *stats) {
+    double ignored;
+    trackLines = 0;
+    int result = runReduction(records, size, numWorkers, method, ROUNDS, &stats->usPerRound);
+
+    for (int i = 0; i < TRACK_LINES; i++) {
+        atomic_store(&lineOwner[i], 0);
+        atomic_store(&lineDatum[i], 0);
+    }
+    atomic_store(&contentionTransfers, 0);
+    atomic_store(&handoffTransfers, 0);
+    trackLines = 1;
+    int counted = runReduction(records, size, numWorkers, method, COUNTED_ROUNDS, &ignored);
+    trackLines = 0;
+
+    stats->contention = atomic_load(&contentionTransfers) / COUNTED_ROUNDS;
+    stats->handoff = atomic_load(&handoffTransfers) / COUNTED_ROUNDS;
+    return (result == counted) ? result : -1;
+}
+
+// Padded slot for the hot-update test
+typedef struct {
+    int result;
+} __attribute__((aligned(CACHE_LINE))) PaddedResult;
+
+typedef struct {
+    int *records;
+    int start, end;
+    volatile int *out;            // Where the running sum is kept
+} HotArg;
+
+// Keeps the running sum in the slot itself, as `data->result += records[i]` would.
+void *hotUpdate(void *arg) {
+    HotArg *h = (HotArg *)arg;
+    *h->out = 0;
+    for (int i = h->start; i < h->end; i++) {
+        *h->out += h->records[i];
+    }
+    return NULL;
+}
+
+// Runs NUM_THREADS hot-update workers writing into out[0..], `stride` bytes apart.
+int runHotUpdates(int *records, int size, char *base, size_t stride, double *ms) {
+    pthread_t threads[NUM_THREADS];
+    HotArg args[NUM_THREADS];
+    int chunk = size / NUM_THREADS;
+
+    double begin = nowMs();
+    for (int i = 0; i < NUM_THREADS; i++) {
+        args[i] = (HotArg){records, i * chunk, (i == NUM_THREADS - 1) ? size : (i + 1) * chunk,
+                           (volatile int *)(base + i * stride)};
+        pthread_create(&threads[i], NULL, hotUpdate, &args[i]);
+    }
+    int total = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        total += *args[i].out;
+    }
+    *ms = nowMs() - begin;
+    return total;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    static int records[MAX_OPERATIONS];
+    int failed = 0;
+
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+
+    int index = 0;
+    for (int i = 0; i < MAX_OPERATIONS; i++) {
+        if (isdigit(largeOps[i][0]) || (largeOps[i][0] == '-' && isdigit(largeOps[i][1]))) {
+            records[index++] = atoi(largeOps[i]);
+        } else if (strcmp(largeOps[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(largeOps[i], "D") == 0 && index > 0) {
+            records[index] = 2 * records[index - 1];
+            index++;
+        } else if (strcmp(largeOps[i], "+") == 0 && index > 1) {
+            records[index] = records[index - 1] + records[index - 2];
+            index++;
+        }
+    }
+
+    printf("Slot sizes: packed %zu bytes, padded %zu bytes\n", sizeof(ThreadData), sizeof(ReductionSlot));
+
+    // Hot updates: packed slots share lines, padded slots do not
+    static ThreadData packedSlots[NUM_THREADS];
+    static PaddedResult paddedSlots[NUM_THREADS];
+    double packedMs, paddedMs;
+    int hotPacked = runHotUpdates(records, index, (char *)&packedSlots[0].result, sizeof(ThreadData), &packedMs);
+    int hotPadded = runHotUpdates(records, index, (char *)&paddedSlots[0].result, sizeof(PaddedResult), &paddedMs);
+    printf("Hot slot updates (%d workers): packed %.3f ms, padded %.3f ms, Result: %d\n",
+           NUM_THREADS, packedMs, paddedMs, hotPadded);
+    failed |= (hotPacked != 15000000 || hotPadded != 15000000);
+
+    int workerCounts[] = {4, 16, 64, 128, 256};
+    const char *methodNames[] = {"packed + mutex", "packed", "padded tree"};
+    for (size_t k = 0; k < sizeof(workerCounts) / sizeof(workerCounts[0]); k++) {
+        for (int m = PUBLISH_PACKED_MUTEX; m <= PUBLISH_TREE; m++) {
+            MethodStats stats;
+            int result = measureMethod(records, index, workerCounts[k], (PublishMethod)m, &stats);
+            printf("%3d workers, %-14s: %8.1f us/round, line transfers per round: %4ld contention, "
+                   "%4ld hand-off, Result: %d\n", workerCounts[k], methodNames[m], stats.usPerRound,
+                   stats.contention, stats.handoff, result);
+            failed |= (result != 15000000);
+        }
+    }
+
+    if (failed) {
+        fprintf(stderr, "Mismatch between reduction results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,479 @@
+/*
+ * Adaptive Auto-Tuner for Thread Count, Grain Size and the Serial/Parallel Crossover
+
+   Why Tune?
+
+   Every threaded variant hard-codes NUM_THREADS (2 or 4) and a crossover such as `index < 500`
+   or SIMD_THRESHOLD 500, whatever the machine. On a 64-core host two threads leave most of the
+   memory bandwidth unused. On any host, creating threads to sum 500 records costs far more
+   than summing them: one pthread_create/join is tens of microseconds, while a core sums
+   several thousand cached records per microsecond.
+
+   Calibration
+   -----------
+   At startup the tuner loads a cached profile, or measures the host and writes one:
+
+   - cacheGBs:        single-thread sum rate on an L2-resident buffer (records still hot
+                      from the parse).
+   - per probe t = 1, 2, 4, ... up to the online CPUs:
+       dispatchUs[t]: pthread_create + join of t threads with an empty body;
+       dramGBs[t]:    aggregate sum bandwidth of t threads over a buffer twice the L3 size
+                      (per-core bandwidth is dramGBs[1]; the curve shows where it saturates).
+
+   The profile is a small text file, SCOREBENCH_TUNE_PROFILE or ./scorebench_tune.profile.
+   It is ignored (and rewritten) if its version or CPU count does not match the host, or if a
+   probe is out of range (thread counts outside 1..min(cpus, MAX_TUNED_THREADS) or not
+   ascending, rates or dispatch times not positive).
+   Run with "calibrate" to force a new measurement.
+
+   Choosing a Plan
+   ---------------
+   For n records choosePlan() predicts, for every probed t,
+
+       time(t) = dispatchUs[t] (0 for t = 1, which runs inline) + 4n bytes / rate(t)
+       rate(t) = max(t * cacheGBs, dramGBs[t]) if the records fit in L3, else dramGBs[t]
+
+   and takes the fastest. The grain is n / (t * CHUNKS_PER_THREAD), rounded up to whole cache
+   lines and at least MIN_GRAIN, so the workers' chunks come from a shared counter and a slow
+   worker does not hold up the others. The crossover is the smallest n for which the plan
+   uses more than one thread (found by bisection on the model).
+
+   Input Explained
+   ---------------
+   - "10", "D" pairs at sizes from 1,000 to 16,000,000 operations (the 1,000,000 case is the
+     input of 4.baseball_parallel_bench_large_test_cases.c, expected 15,000,000). Each size is
+     summed with file 4's fixed policy (2 threads above 500 records) and with the tuned plan.
+   - The tuned parallel path is also forced with 2, 4 and 8 threads and grains from 16 to
+     2^18 records on random records, whatever this host picked.
+
+   Expected Output
+   ---------------
+   Profile: loaded ./scorebench_tune.profile (or: calibrated, saved ...)
+     cache [GB/s] GB/s; 1 threads: dispatch [us] us, DRAM [GB/s] GB/s; 2 threads: ...
+   Serial/parallel crossover: [n] records (or: never, on 1 CPU)
+         1000 ops: plan 1 threads, grain [n]; fixed [us] us, tuned [us] us, Result: 15000
+   ...
+      1000000 ops: plan [t] threads, grain [n]; fixed [us] us, tuned [us] us, Result: 15000000
+   Forced parallel plans: OK
+   Corrupt profiles rejected: OK
+
+   gcc -pthread -O3 31.baseball_adaptive_autotuner_threads_grain_crossover.c -o baseball_autotune
+   ./baseball_autotune calibrate
+*/
+
+#include <stdio.h>        // printf(), fopen()
+#include <stdlib.h>       // atoi(), getenv(), malloc()
+#include <string.h>       // strcmp(), memset()
+#include <ctype.h>        // isdigit()
+#include <pthread.h>      // pthreads
+#include <stdatomic.h>    // Shared chunk counter
+#include <unistd.h>       // sysconf()
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 16000000
+#define FIXED_THREADS 2             // File 4's policy
+#define FIXED_THRESHOLD 500
+#define MAX_PROBES 10               // Thread counts 1, 2, 4, ..., 512
+#define MAX_TUNED_THREADS 512
+#define CHUNKS_PER_THREAD 4
+#define MIN_GRAIN 4096              // Records; smaller chunks cost more in the counter than they save
+#define CACHE_LINE_INTS 16
+#define DISPATCH_RUNS 200
+#define PROFILE_VERSION 1
+#define DEFAULT_PROFILE "scorebench_tune.profile"
+
+typedef struct {
+    int cpus;                       // Online CPUs when measured
+    long l3Bytes;
+    double cacheGBs;                // One thread, L2-resident records
+    int numProbes;
+    int threads[MAX_PROBES];
+    double dispatchUs[MAX_PROBES];
+    double dramGBs[MAX_PROBES];
+} TuneProfile;
+
+typedef struct {
+    int threads;                    // 1 = serial, no threads created
+    int grain;                      // Records per chunk taken from the shared counter
+} TunedPlan;
+
+typedef struct {
+    const int *records;
+    int size, grain;
+    atomic_int *nextChunk;
+    unsigned result;
+    char pad[64];                   // Keeps neighbouring results off one cache line
+} TunedWorker;
+
+typedef struct {
+    int *records;
+    int start, end;
+    int result;
+} ThreadData;
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Keeps the compiler from hoisting a pure sum out of a measurement loop
+static inline void clobberMemory(void) {
+    __asm__ volatile("" : : : "memory");
+}
+
+unsigned sumRange(const int *records, int start, int end) {
+    unsigned sum = 0;
+    for (int i = start; i < end; i++) sum += (unsigned)records[i];
+    return sum;
+}
+
+void *emptyWorker(void *arg) {
+    return arg;
+}
+
+void *sliceWorker(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    data->result = (int)sumRange(data->records, data->start, data->end);
+    return NULL;
+}
+
+// Microseconds to create and join `threads` threads that do nothing.
+double measureDispatch(int threads) {
+    pthread_t ids[MAX_TUNED_THREADS];
+    double start = nowMs();
+    for (int run = 0; run < DISPATCH_RUNS; run++) {
+        for (int i = 0; i < threads; i++) pthread_create(&ids[i], NULL, emptyWorker, NULL);
+        for (int i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+    }
+    return (nowMs() - start) * 1000.0 / DISPATCH_RUNS;
+}
+
+// GB/s of `threads` threads summing equal slices of records[0, count), best of `passes`.
+double measureBandwidth(int *records, int count, int threads, int passes) {
+    pthread_t ids[MAX_TUNED_THREADS];
+    ThreadData data[MAX_TUNED_THREADS];
+    int slice = count / threads;
+    double best = 0;
+
+    for (int pass = 0; pass < passes; pass++) {
+        double start = nowMs();
+        for (int i = 0; i < threads; i++) {
+            data[i] = (ThreadData){records, i * slice, (i == threads - 1) ? count : (i + 1) * slice, 0};
+            pthread_create(&ids[i], NULL, sliceWorker, &data[i]);
+        }
+        for (int i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+        double gbs = (double)count * sizeof(int) / ((nowMs() - start) * 1e6);
+        if (gbs > best) best = gbs;
+    }
+    return best;
+}
+
+int calibrate(TuneProfile *p) {
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE), l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    p->cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    p->l3Bytes = l3 > 0 ? l3 : 32L << 20;
+
+    // Cache rate: one thread, half of L2, many passes
+    int cachedCount = (int)((l2 > 0 ? l2 / 2 : 256L << 10) / sizeof(int));
+    int *cached = malloc(cachedCount * sizeof(int));
+    if (!cached) return -1;
+    for (int i = 0; i < cachedCount; i++) cached[i] = i & 31;
+    int runs = (int)((1L << 30) / ((long)cachedCount * sizeof(int)));
+    volatile unsigned sink = 0;
+    double start = nowMs();
+    for (int r = 0; r < runs; r++) {
+        clobberMemory();
+        sink += sumRange(cached, 0, cachedCount);
+    }
+    p->cacheGBs = (double)cachedCount * sizeof(int) * runs / ((nowMs() - start) * 1e6);
+    (void)sink;
+    free(cached);
+
+    // DRAM curve: twice L3, clamped to [64 MB, 512 MB]
+    long dramBytes = 2 * p->l3Bytes;
+    if (dramBytes < (64L << 20)) dramBytes = 64L << 20;
+    if (dramBytes > (512L << 20)) dramBytes = 512L << 20;
+    int dramCount = (int)(dramBytes / sizeof(int));
+    int *dram = malloc((size_t)dramCount * sizeof(int));
+    if (!dram) return -1;
+    for (int i = 0; i < dramCount; i++) dram[i] = i & 31;
+
+    p->numProbes = 0;
+    for (int t = 1; t <= p->cpus && t <= MAX_TUNED_THREADS && p->numProbes < MAX_PROBES; t *= 2) {
+        p->threads[p->numProbes] = t;
+        p->dispatchUs[p->numProbes] = measureDispatch(t);
+        p->dramGBs[p->numProbes] = measureBandwidth(dram, dramCount, t, 3);
+        p->numProbes++;
+    }
+    free(dram);
+    return 0;
+}
+
+const char *profilePath(void) {
+    const char *path = getenv("SCOREBENCH_TUNE_PROFILE");
+    return (path && path[0]) ? path : DEFAULT_PROFILE;
+}
+
+int saveProfile(const TuneProfile *p, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "scorebench-tune %d\ncpus %d\nl3 %ld\ncache_gbs %.4f\nprobes %d\n",
+            PROFILE_VERSION, p->cpus, p->l3Bytes, p->cacheGBs, p->numProbes);
+    for (int k = 0; k < p->numProbes; k++) {
+        fprintf(f, "probe %d %.4f %.4f\n", p->threads[k], p->dispatchUs[k], p->dramGBs[k]);
+    }
+    return fclose(f);
+}
+
+// A profile is only used if every probe can be run and modelled: 1 <= threads <=
+// min(cpus, MAX_TUNED_THREADS) in ascending order (sumTuned has MAX_TUNED_THREADS slots)
+// and positive rates and dispatch times (predictUs divides by the rates).
+static int profileValid(const TuneProfile *p) {
+    int maxThreads = p->cpus < MAX_TUNED_THREADS ? p->cpus : MAX_TUNED_THREADS;
+    if (!(p->cacheGBs > 0) || p->l3Bytes <= 0) return 0;
+    for (int k = 0; k < p->numProbes; k++) {
+        if (p->threads[k] < 1 || p->threads[k] > maxThreads) return 0;
+        if (k > 0 && p->threads[k] <= p->threads[k - 1]) return 0;
+        if (!(p->dispatchUs[k] > 0) || !(p->dramGBs[k] > 0)) return 0;
+    }
+    return 1;
+}
+
+// Returns 0 if a valid profile for this host was read.
+int loadProfile(TuneProfile *p, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int version = 0, ok = 1;
+    ok &= fscanf(f, "scorebench-tune %d cpus %d l3 %ld cache_gbs %lf probes %d",
+                 &version, &p->cpus, &p->l3Bytes, &p->cacheGBs, &p->numProbes) == 5;
+    ok &= version == PROFILE_VERSION && p->numProbes >= 1 && p->numProbes <= MAX_PROBES;
+    for (int k = 0; ok && k < p->numProbes; k++) {
+        ok &= fscanf(f, " probe %d %lf %lf", &p->threads[k], &p->dispatchUs[k], &p->dramGBs[k]) == 3;
+    }
+    fclose(f);
+    if (!ok || p->cpus != (int)sysconf(_SC_NPROCESSORS_ONLN)) return -1;  // Stale or another host
+    return profileValid(p) ? 0 : -1;                                        // Corrupt or hand-edited
+}
+
+// Predicted microseconds to sum n records with probe k.
+double predictUs(const TuneProfile *p, int k, long n) {
+    double bytes = (double)n * sizeof(int);
+    double gbs = p->dramGBs[k];
+    if (bytes <= p->l3Bytes) {
+        double cached = p->cacheGBs * p->threads[k];
+        gbs = cached > gbs ? cached : gbs;
+    }
+    double dispatch = p->threads[k] == 1 ? 0 : p->dispatchUs[k];
+    return dispatch + bytes / (gbs * 1e3);
+}
+
+TunedPlan choosePlan(const TuneProfile *p, long n) {
+    int best = 0;
+    for (int k = 1; k < p->numProbes; k++) {
+        if (predictUs(p, k, n) < predictUs(p, best, n)) best = k;
+    }
+
+    TunedPlan plan = {p->threads[best], 0};
+    long grain = n / ((long)plan.threads * CHUNKS_PER_THREAD);
+    grain = (grain + CACHE_LINE_INTS - 1) / CACHE_LINE_INTS * CACHE_LINE_INTS;
+    if (grain < MIN_GRAIN) grain = MIN_GRAIN;
+    plan.grain = (int)grain;
+    if (plan.threads > 1 && n <= plan.grain) plan.threads = 1;  // A single chunk
+    if (plan.threads == 1) plan.grain = (int)n;
+    return plan;
+}
+
+// Smallest n for which the plan is parallel, or -1 if it never is.
+long findCrossover(const TuneProfile *p) {
+    long high = 1L << 30;
+    if (choosePlan(p, high).threads == 1) return -1;
+    long low = 1;
+    while (low < high) {
+        long mid = low + (high - low) / 2;
+        if (choosePlan(p, mid).threads > 1) high = mid; else low = mid + 1;
+    }
+    return low;
+}
+
+void *tunedWorker(void *arg) {
+    TunedWorker *w = (TunedWorker *)arg;
+    unsigned sum = 0;
+    int chunk;
+    while ((chunk = atomic_fetch_add_explicit(w->nextChunk, 1, memory_order_relaxed)) * (long)w->grain < w->size) {
+        int start = chunk * w->grain;
+        int end = start + w->grain < w->size ? start + w->grain : w->size;
+        sum += sumRange(w->records, start, end);
+    }
+    w->result = sum;
+    return NULL;
+}
+
+// Sums records[0, size) according to the plan.
+int sumTuned(const int *records, int size, TunedPlan plan) {
+    if (plan.threads <= 1) return (int)sumRange(records, 0, size);
+
+    pthread_t ids[MAX_TUNED_THREADS];
+    static TunedWorker workers[MAX_TUNED_THREADS];
+    atomic_int nextChunk;
+    atomic_init(&nextChunk, 0);
+
+    for (int i = 0; i < plan.threads; i++) {
+        workers[i].records = records;
+        workers[i].size = size;
+        workers[i].grain = plan.grain;
+        workers[i].nextChunk = &nextChunk;
+        pthread_create(&ids[i], NULL, tunedWorker, &workers[i]);
+    }
+    unsigned total = 0;
+    for (int i = 0; i < plan.threads; i++) {
+        pthread_join(ids[i], NULL);
+        total += workers[i].result;
+    }
+    return (int)total;
+}
+
+// File 4's summation policy: FIXED_THREADS threads above FIXED_THRESHOLD records.
+int sumFixed(int *records, int size) {
+    if (size < FIXED_THRESHOLD) return (int)sumRange(records, 0, size);
+
+    pthread_t ids[FIXED_THREADS];
+    ThreadData data[FIXED_THREADS];
+    int mid = size / FIXED_THREADS;
+    for (int i = 0; i < FIXED_THREADS; i++) {
+        data[i] = (ThreadData){records, i * mid, (i == FIXED_THREADS - 1) ? size : (i + 1) * mid, 0};
+        pthread_create(&ids[i], NULL, sliceWorker, &data[i]);
+    }
+    unsigned total = 0;
+    for (int i = 0; i < FIXED_THREADS; i++) {
+        pthread_join(ids[i], NULL);
+        total += (unsigned)data[i].result;
+    }
+    return (int)total;
+}
+
+// Parse step shared by both policies (file 4 rules, wrap-safe)
+int parseOps(char *ops[], int size, int *records) {
+    int index = 0;
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            index++;
+        }
+    }
+    return index;
+}
+
+int main(int argc, char *argv[]) {
+    TuneProfile profile;
+    const char *path = profilePath();
+    int force = argc > 1 && strcmp(argv[1], "calibrate") == 0;
+
+    if (!force && loadProfile(&profile, path) == 0) {
+        printf("Profile: loaded %s\n", path);
+    } else {
+        if (calibrate(&profile) != 0) {
+            fprintf(stderr, "Calibration failed\n");
+            return EXIT_FAILURE;
+        }
+        int saved = saveProfile(&profile, path) == 0;
+        printf("Profile: calibrated, %s %s\n", saved ? "saved to" : "could not save", path);
+    }
+
+    printf("  cache %.2f GB/s", profile.cacheGBs);
+    for (int k = 0; k < profile.numProbes; k++) {
+        printf("; %d threads: dispatch %.1f us, DRAM %.2f GB/s",
+               profile.threads[k], profile.dispatchUs[k], profile.dramGBs[k]);
+    }
+    printf("\n");
+    long crossover = findCrossover(&profile);
+    if (crossover < 0) {
+        printf("Serial/parallel crossover: never (%d CPU%s)\n", profile.cpus, profile.cpus == 1 ? "" : "s");
+    } else {
+        printf("Serial/parallel crossover: %ld records\n", crossover);
+    }
+
+    char **ops = malloc((size_t)MAX_OPERATIONS * sizeof(char *));
+    int *records = malloc((size_t)MAX_OPERATIONS * sizeof(int));
+    if (!ops || !records) {
+        fprintf(stderr, "Could not allocate the benchmark buffers\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < MAX_OPERATIONS / 2; i++) {
+        ops[i * 2] = "10";
+        ops[i * 2 + 1] = "D";
+    }
+
+    int failed = 0;
+    int sizes[] = {1000, 10000, 100000, 1000000, MAX_OPERATIONS};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int index = parseOps(ops, sizes[s], records);
+        TunedPlan plan = choosePlan(&profile, index);
+        int runs = 20000000 / sizes[s] > 0 ? 20000000 / sizes[s] : 1;
+        int fixed = 0, tuned = 0;
+
+        double start = nowMs();
+        for (int r = 0; r < runs; r++) {
+            clobberMemory();
+            fixed = sumFixed(records, index);
+        }
+        double fixedUs = (nowMs() - start) * 1000.0 / runs;
+
+        start = nowMs();
+        for (int r = 0; r < runs; r++) {
+            clobberMemory();
+            tuned = sumTuned(records, index, plan);
+        }
+        double tunedUs = (nowMs() - start) * 1000.0 / runs;
+
+        printf("%9d ops: plan %d threads, grain %d; fixed %.1f us, tuned %.1f us, Result: %d\n",
+               sizes[s], plan.threads, plan.grain, fixedUs, tunedUs, tuned);
+        failed |= (fixed != tuned || tuned != sizes[s] / 2 * 30);
+    }
+
+    // The tuned parallel path with forced plans, whatever this host picked
+    srand(7);
+    for (int i = 0; i < 1000000; i++) records[i] = rand() % 2001 - 1000;
+    int reference = (int)sumRange(records, 0, 1000000);
+    for (int threads = 2; threads <= 8; threads *= 2) {
+        for (int grain = 16; grain <= 1 << 18; grain *= 8) {
+            if (sumTuned(records, 1000000, (TunedPlan){threads, grain}) != reference) failed = 1;
+        }
+    }
+    printf("Forced parallel plans: %s\n", failed ? "FAILED" : "OK");
+
+    // Hand-edited profiles must be recalibrated, not used: too many threads, a zero DRAM
+    // rate, and probes out of order
+    const char *badPath = "scorebench_tune.bad.profile";
+    TuneProfile bad[3] = {profile, profile, profile};
+    bad[0].threads[bad[0].numProbes - 1] = 4096;
+    bad[1].dramGBs[0] = 0;
+    bad[2].numProbes = 2;
+    bad[2].threads[0] = bad[2].threads[1] = 1;
+    bad[2].dispatchUs[1] = bad[2].dispatchUs[0];
+    bad[2].dramGBs[1] = bad[2].dramGBs[0];
+    int rejected = 1;
+    for (int b = 0; b < 3; b++) {
+        TuneProfile loaded;
+        if (saveProfile(&bad[b], badPath) != 0 || loadProfile(&loaded, badPath) == 0) rejected = 0;
+    }
+    remove(badPath);
+    printf("Corrupt profiles rejected: %s\n", rejected ? "OK" : "FAILED");
+    failed |= !rejected;
+
+    free(ops);
+    free(records);
+    if (failed) {
+        fprintf(stderr, "Mismatch between tuned and fixed results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
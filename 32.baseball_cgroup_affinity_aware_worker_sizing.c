@@ -0,0 +1,410 @@
+/*
+ * cgroup- and Affinity-Aware Worker Sizing for Containerized Deployments
+
+   Why?
+
+   The threaded variants size themselves with a constant (NUM_THREADS 2 or 4) or with the
+   number of CPUs in the machine, and 11.baseball_optimizing_multithreaded_simd_for_numa_all_bench.c
+   pinned itself with setCPUAffinity(0, 4): CPUs 0-4, even when the container may only run on
+   CPUs 32-47. A container sees every CPU of the host in sysconf(), but it may run only on its
+   cpuset. It may also get only part of those CPUs' time: under a CFS quota (cpu.max
+   "200000 100000" = 2 CPUs' worth per 100 ms), 16 busy threads use up the quota in 12.5 ms and
+   are then throttled for the rest of the period. That is a latency cliff, not a slowdown.
+
+   CPU Budget
+   ----------
+   readCpuBudget() combines three limits:
+
+   1. sched_getaffinity(0):        the CPUs this process may run on (taskset, numactl, a
+                                   previous sched_setaffinity).
+   2. cpuset.cpus.effective:       the cgroup v2 cpuset, intersected with (1).
+   3. cpu.max:                     the cgroup v2 CFS quota, "quota period" or "max period".
+                                   The tightest limit of the cgroup and all its ancestors
+                                   counts. On a cgroup v1 host cpu.cfs_quota_us and
+                                   cpu.cfs_period_us are read instead.
+
+   workers = min(CPUs in the set, floor(quota / period)), at least 1. It is rounded down, so
+   the workers never ask for more CPU time than the quota grants. Worker w is pinned to the
+   w-th CPU of the set, not to CPU w.
+
+   The cgroup is found from /proc/self/cgroup and the cgroup2 mount in /proc/self/mountinfo.
+   SCOREBENCH_CGROUP_DIR=<dir> reads cpu.max and cpuset.cpus.effective from <dir> instead,
+   to try out limits without a container.
+
+   Input Explained
+   ---------------
+   - Parser checks: CPU lists ("32-47", "0,2-3,8") and cpu.max strings ("max 100000",
+     "250000 100000", "50000 100000") against known budgets.
+   - "10", "D" repeated 500,000 times (expected 15,000,000), summed by the sized and pinned
+     workers.
+
+   Expected Output
+   ---------------
+   Budget parser checks: OK
+   Affinity: [n] CPUs ([list])
+   cgroup v2 cpuset.cpus.effective: [list] (or: not limited)
+   CPU quota: [x] CPUs ([source]) (or: unlimited)
+   Workers: [n] on CPUs [list]
+   Sized calPoints: [time_ms] ms, Result: 15000000
+
+   gcc -pthread -O3 32.baseball_cgroup_affinity_aware_worker_sizing.c -o baseball_cpu_budget
+   SCOREBENCH_CGROUP_DIR=/tmp/fake_cgroup ./baseball_cpu_budget
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // printf(), fopen()
+#include <stdlib.h>       // atoi(), getenv(), strtol()
+#include <string.h>       // strcmp(), strncmp()
+#include <ctype.h>        // isdigit()
+#include <pthread.h>      // pthreads, pthread_setaffinity_np()
+#include <sched.h>        // sched_getaffinity(), cpu_set_t
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define MAX_WORKERS CPU_SETSIZE
+#define PATH_BYTES 4096
+
+typedef struct {
+    cpu_set_t cpus;           // CPUs the workers may use (affinity & cpuset)
+    int affinityCpus;         // CPUs in sched_getaffinity()
+    int cpusetLimited;        // cpuset.cpus.effective was found and applied
+    double quotaCpus;         // quota / period, or -1 if unlimited
+    const char *quotaSource;  // Where the quota came from
+    int workers;
+} CpuBudget;
+
+typedef struct {
+    int *records;
+    int start, end;
+    int result;
+    int cpu;                  // CPU this worker is pinned to
+} ThreadData;
+
+// Parses a kernel CPU list ("0-3,8,10-11") into set. Returns the number of CPUs, or -1.
+int parseCpuList(const char *text, cpu_set_t *set) {
+    CPU_ZERO(set);
+    const char *p = text;
+    while (*p && *p != '\n') {
+        char *end;
+        long first = strtol(p, &end, 10), last = first;
+        if (end == p || first < 0) return -1;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first) return -1;
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, set);
+        if (*p == ',') p++;
+        else if (*p && *p != '\n') return -1;
+    }
+    return CPU_COUNT(set);
+}
+
+void formatCpuList(const cpu_set_t *set, char *out, size_t size) {
+    size_t used = 0;
+    out[0] = '\0';
+    for (int cpu = 0; cpu < CPU_SETSIZE && used < size; cpu++) {
+        if (!CPU_ISSET(cpu, set)) continue;
+        int last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, set)) last++;
+        used += snprintf(out + used, size - used, used ? ",%d" : "%d", cpu);
+        if (last > cpu && used < size) used += snprintf(out + used, size - used, "-%d", last);
+        cpu = last;
+    }
+}
+
+// Parses a cpu.max line. Returns quota / period in CPUs, or -1 for "max".
+double parseCpuMax(const char *text) {
+    char quota[32];
+    long period;
+    if (sscanf(text, "%31s %ld", quota, &period) != 2 || period <= 0) return -1;
+    if (strcmp(quota, "max") == 0) return -1;
+    long q = strtol(quota, NULL, 10);
+    return q > 0 ? (double)q / period : -1;
+}
+
+// Reads the first line of dir/name into buf. Returns 0 on success.
+int readCgroupFile(const char *dir, const char *name, char *buf, size_t size) {
+    char path[PATH_BYTES];
+    if (snprintf(path, sizeof(path), "%s/%s", dir, name) >= (int)sizeof(path)) return -1;
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fgets(buf, (int)size, f) != NULL;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+// Mount point of the cgroup2 hierarchy (from /proc/self/mountinfo). Returns 0 if found.
+int cgroup2Mount(char *out, size_t size) {
+    FILE *f = fopen("/proc/self/mountinfo", "r");
+    if (!f) return -1;
+    char line[PATH_BYTES];
+    int found = -1;
+    while (fgets(line, sizeof(line), f)) {
+        char *sep = strstr(line, " - ");
+        char mountPoint[PATH_BYTES], fsType[64];
+        if (sep && sscanf(sep + 3, "%63s", fsType) == 1 && strcmp(fsType, "cgroup2") == 0 &&
+            sscanf(line, "%*s %*s %*s %*s %4095s", mountPoint) == 1) {
+            snprintf(out, size, "%s", mountPoint);
+            found = 0;
+            break;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+// This process's cgroup path in one hierarchy: controller "" selects the v2 line
+// ("0::/path"), otherwise a v1 controller ("cpu" matches "2:cpu,cpuacct:/path").
+// Returns 0 if found.
+int ownCgroupPath(const char *controller, char *out, size_t size) {
+    FILE *f = fopen("/proc/self/cgroup", "r");
+    if (!f) return -1;
+    char line[PATH_BYTES];
+    int found = -1;
+    while (found != 0 && fgets(line, sizeof(line), f)) {
+        char *controllers = strchr(line, ':');
+        char *path = controllers ? strchr(controllers + 1, ':') : NULL;
+        if (!path) continue;
+        *controllers++ = '\0';
+        *path++ = '\0';
+        path[strcspn(path, "\n")] = '\0';
+
+        int match = 0;
+        if (controller[0] == '\0') {
+            match = strcmp(line, "0") == 0 && controllers[0] == '\0';
+        } else {
+            for (char *name = strtok(controllers, ","); name && !match; name = strtok(NULL, ",")) {
+                match = strcmp(name, controller) == 0;
+            }
+        }
+        if (match) {
+            snprintf(out, size, "%s", path);
+            found = 0;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+// Tightest cpu.max from dir up to (and including) root. Returns -1 if unlimited.
+double tightestCpuMax(const char *root, const char *dir) {
+    char path[PATH_BYTES], line[128];
+    double tightest = -1;
+    snprintf(path, sizeof(path), "%s", dir);
+    size_t rootLength = strlen(root);
+
+    while (1) {
+        if (readCgroupFile(path, "cpu.max", line, sizeof(line)) == 0) {
+            double cpus = parseCpuMax(line);
+            if (cpus > 0 && (tightest < 0 || cpus < tightest)) tightest = cpus;
+        }
+        char *slash = strrchr(path, '/');
+        if (!slash || strlen(path) <= rootLength) break;
+        *slash = '\0';
+    }
+    return tightest;
+}
+
+// Workers for a CPU set and a quota in CPUs (-1 if unlimited): one per CPU of the set, but
+// no more than whole CPUs of quota, and always at least one (a 0.5-CPU quota still runs).
+int workersFor(const cpu_set_t *cpus, double quotaCpus) {
+    int workers = CPU_COUNT(cpus);
+    if (quotaCpus > 0 && (int)quotaCpus < workers) workers = (int)quotaCpus;
+    return workers < 1 ? 1 : workers;
+}
+
+// Derives the worker count and CPU set from affinity, cpuset and quota.
+void readCpuBudget(CpuBudget *b) {
+    char dir[PATH_BYTES], root[PATH_BYTES], path[PATH_BYTES], line[PATH_BYTES];
+
+    CPU_ZERO(&b->cpus);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &b->cpus) != 0) CPU_SET(0, &b->cpus);
+    b->affinityCpus = CPU_COUNT(&b->cpus);
+    b->cpusetLimited = 0;
+    b->quotaCpus = -1;
+    b->quotaSource = "none";
+
+    const char *override = getenv("SCOREBENCH_CGROUP_DIR");
+    int haveDir = 0;
+    if (override && override[0]) {
+        snprintf(root, sizeof(root), "%s", override);
+        snprintf(dir, sizeof(dir), "%s", override);
+        haveDir = 1;
+    } else if (cgroup2Mount(root, sizeof(root)) == 0 && ownCgroupPath("", path, sizeof(path)) == 0) {
+        haveDir = snprintf(dir, sizeof(dir), "%s%s", root, strcmp(path, "/") == 0 ? "" : path) < (int)sizeof(dir);
+    }
+
+    if (haveDir) {
+        cpu_set_t cpuset;
+        if (readCgroupFile(dir, "cpuset.cpus.effective", line, sizeof(line)) == 0 &&
+            parseCpuList(line, &cpuset) > 0) {
+            cpu_set_t both;
+            CPU_AND(&both, &b->cpus, &cpuset);
+            if (CPU_COUNT(&both) > 0) {
+                b->cpus = both;
+                b->cpusetLimited = 1;
+            }
+        }
+        b->quotaCpus = tightestCpuMax(root, dir);
+        if (b->quotaCpus > 0) b->quotaSource = "cgroup v2 cpu.max";
+    }
+
+    // cgroup v1 CFS quota
+    if (b->quotaCpus < 0 && !(override && override[0]) && ownCgroupPath("cpu", path, sizeof(path)) == 0) {
+        const char *mounts[] = {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct"};
+        for (size_t m = 0; m < sizeof(mounts) / sizeof(mounts[0]) && b->quotaCpus < 0; m++) {
+            char quota[64], period[64];
+            if (snprintf(dir, sizeof(dir), "%s%s", mounts[m], strcmp(path, "/") == 0 ? "" : path) >= (int)sizeof(dir)) {
+                continue;
+            }
+            if (readCgroupFile(dir, "cpu.cfs_quota_us", quota, sizeof(quota)) == 0 &&
+                readCgroupFile(dir, "cpu.cfs_period_us", period, sizeof(period)) == 0) {
+                long q = atol(quota), p = atol(period);
+                if (q > 0 && p > 0) {
+                    b->quotaCpus = (double)q / p;
+                    b->quotaSource = "cgroup v1 cpu.cfs_quota_us";
+                }
+            }
+        }
+    }
+
+    b->workers = workersFor(&b->cpus, b->quotaCpus);
+}
+
+// The n-th CPU of the budget's set (wrapping around).
+int budgetCpu(const CpuBudget *b, int n) {
+    int count = CPU_COUNT(&b->cpus);
+    n %= count;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &b->cpus) && n-- == 0) return cpu;
+    }
+    return 0;
+}
+
+void *pinnedSum(void *arg) {
+    ThreadData *data = (ThreadData *)arg;
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(data->cpu, &one);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &one);
+
+    unsigned sum = 0;
+    for (int i = data->start; i < data->end; i++) sum += (unsigned)data->records[i];
+    data->result = (int)sum;
+    return NULL;
+}
+
+// Evaluates the ops and sums the records with the budget's workers, pinned to its CPUs.
+int calPoints(char *ops[], int size, const CpuBudget *budget) {
+    static int records[MAX_OPERATIONS];
+    int index = 0;
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            index--;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            index++;
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            index++;
+        }
+    }
+
+    static pthread_t threads[MAX_WORKERS];
+    static ThreadData data[MAX_WORKERS];
+    int workers = budget->workers;
+    int chunk = index / workers;
+    for (int i = 0; i < workers; i++) {
+        data[i] = (ThreadData){records, i * chunk, (i == workers - 1) ? index : (i + 1) * chunk, 0,
+                               budgetCpu(budget, i)};
+        pthread_create(&threads[i], NULL, pinnedSum, &data[i]);
+    }
+    unsigned totalSum = 0;
+    for (int i = 0; i < workers; i++) {
+        pthread_join(threads[i], NULL);
+        totalSum += (unsigned)data[i].result;
+    }
+    return (int)totalSum;
+}
+
+// Known answers for the parsers and the sizing rule.
+int checkParsers(void) {
+    cpu_set_t set;
+    char text[128];
+    int failed = 0;
+
+    failed |= parseCpuList("32-47\n", &set) != 16 || !CPU_ISSET(32, &set) || !CPU_ISSET(47, &set) || CPU_ISSET(48, &set);
+    formatCpuList(&set, text, sizeof(text));
+    failed |= strcmp(text, "32-47") != 0;
+    failed |= parseCpuList("0,2-3,8", &set) != 4;
+    formatCpuList(&set, text, sizeof(text));
+    failed |= strcmp(text, "0,2-3,8") != 0;
+    failed |= parseCpuList("3-1", &set) != -1;
+
+    failed |= parseCpuMax("max 100000\n") != -1;
+    failed |= parseCpuMax("250000 100000\n") != 2.5;
+    failed |= parseCpuMax("50000 100000\n") != 0.5;
+
+    // 16 CPUs in the set: 2.5 CPUs of quota give 2 workers (never 3), 0.5 CPUs give 1,
+    // an unlimited quota gives one per CPU and a quota above the set does not add any
+    CpuBudget b;
+    parseCpuList("32-47", &b.cpus);
+    failed |= workersFor(&b.cpus, 2.5) != 2;
+    failed |= workersFor(&b.cpus, 0.5) != 1;
+    failed |= workersFor(&b.cpus, -1) != 16;
+    failed |= workersFor(&b.cpus, 64) != 16;
+    failed |= budgetCpu(&b, 0) != 32 || budgetCpu(&b, 1) != 33 || budgetCpu(&b, 16) != 32;
+    return failed;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    static char *largeOps[MAX_OPERATIONS];
+    char list[1024];
+
+    int failed = checkParsers();
+    printf("Budget parser checks: %s\n", failed ? "FAILED" : "OK");
+
+    CpuBudget budget;
+    readCpuBudget(&budget);
+
+    cpu_set_t affinity;
+    sched_getaffinity(0, sizeof(cpu_set_t), &affinity);
+    formatCpuList(&affinity, list, sizeof(list));
+    printf("Affinity: %d CPUs (%s)\n", budget.affinityCpus, list);
+    formatCpuList(&budget.cpus, list, sizeof(list));
+    printf("cgroup v2 cpuset.cpus.effective: %s\n", budget.cpusetLimited ? list : "not limited");
+    if (budget.quotaCpus > 0) {
+        printf("CPU quota: %.2f CPUs (%s)\n", budget.quotaCpus, budget.quotaSource);
+    } else {
+        printf("CPU quota: unlimited\n");
+    }
+    printf("Workers: %d on CPUs", budget.workers);
+    for (int i = 0; i < budget.workers; i++) printf("%s%d", i ? "," : " ", budgetCpu(&budget, i));
+    printf("\n");
+
+    for (int i = 0; i < 500000; i++) {
+        largeOps[i * 2] = "10";
+        largeOps[i * 2 + 1] = "D";
+    }
+    double start = nowMs();
+    int result = calPoints(largeOps, MAX_OPERATIONS, &budget);
+    printf("Sized calPoints: %.3f ms, Result: %d\n", nowMs() - start, result);
+    failed |= (result != 15000000);
+
+    if (failed) {
+        fprintf(stderr, "Mismatch between sized and reference results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
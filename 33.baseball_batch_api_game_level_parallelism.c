@@ -0,0 +1,317 @@
+/*
+ * Batch API: Scoring Millions of Independent Games in One Call (Game-Level Parallelism)
+
+   Why a Batch Entry Point?
+
+   2.baseball_game_direct_update_sum_store_converted_values.c loops over its testCases and
+   calls calPoints once per game. Every parallel variant since then splits ONE long game
+   across threads. The real workload is the opposite: millions of games of a few ops each.
+   Splitting a 5-op game is pointless, and a thread per game costs tens of microseconds to
+   score a game that takes tens of nanoseconds.
+
+   GameBatch
+   ---------
+   All games live back to back in one shared op buffer. offsets[] has numGames + 1 entries,
+   and game g is ops[offsets[g], offsets[g + 1]):
+
+       ops:      5 2 C D + | 5 -2 4 C D 9 + + | 1 | ...
+       offsets:  0           5                  13  14 ...
+
+   scoreBatch(batch, totals, numWorkers) writes the score of game g into totals[g].
+
+   - The unit of work is a whole game. Workers claim GAMES_PER_CLAIM games at a time from a
+     shared atomic counter, so one claim costs well under a nanosecond per game, and a run of
+     long games does not leave the other workers idle.
+   - Each worker keeps one records scratch for all its games and grows it only when it meets
+     a longer game. scoreGame() is the running-sum loop of file 2 on that scratch.
+   - Batches below BATCH_PARALLEL_THRESHOLD games (or numWorkers == 1) run on the calling
+     thread and create no threads at all. Otherwise exactly numWorkers threads are started;
+     there is no compile-time cap, so a 64-core host can ask for 64.
+   - Games share nothing and every total has its own output slot, so no locking is needed.
+     Neighbouring workers only meet at the edges of their claims.
+
+   Input Explained
+   ---------------
+   - The seven test cases from file 2, as one batch.
+   - NUM_BATCH_GAMES random games of 1 to 8 ops, scored by the file-2 loop (one calPoints
+     per game), by one thread per game (on a sample of DISPATCH_SAMPLE games), and by
+     scoreBatch with 1, NUM_WORKERS and MANY_WORKERS workers. All totals must agree.
+   - A batch of three games where the middle one is the 1M-op "10","D" game (15000000).
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Per-game calPoints loop:   [ns] ns/game
+   Thread per game (sample):  [ns] ns/game
+   scoreBatch, 1 worker:      [ns] ns/game
+   scoreBatch, 4 workers:     [ns] ns/game
+   scoreBatch, 64 workers:    [ns] ns/game
+   Long game in a batch: 15000000
+   Batch totals: OK ([n] games, checksum [n])
+
+   gcc -pthread -O3 33.baseball_batch_api_game_level_parallelism.c -o baseball_batch
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), malloc(), realloc(), rand()
+#include <string.h>       // strcmp()
+#include <ctype.h>        // isdigit()
+#include <pthread.h>      // pthreads
+#include <stdatomic.h>    // Shared claim counter
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000          // File 2's per-game records limit
+#define NUM_WORKERS 4
+#define MANY_WORKERS 64              // More workers than NUM_WORKERS, as on a large host
+#define NUM_BATCH_GAMES 2000000
+#define MAX_GAME_OPS 8
+#define GAMES_PER_CLAIM 1024         // Games taken from the shared counter at a time
+#define BATCH_PARALLEL_THRESHOLD 4096
+#define DISPATCH_SAMPLE 2000         // Games scored with one thread each
+#define INITIAL_SCRATCH 64
+
+typedef struct {
+    char **ops;            // Shared op buffer holding every game back to back
+    const int *offsets;    // Game g is ops[offsets[g], offsets[g + 1]); numGames + 1 entries
+    int numGames;
+} GameBatch;
+
+typedef struct {
+    const GameBatch *batch;
+    int *totals;
+    atomic_int *nextGame;
+    int failed;            // Scratch allocation failed
+} BatchWorker;
+
+// File 2: one game with a running sum, on caller-provided records (>= end - begin entries).
+static inline int scoreGame(char **ops, int begin, int end, int *records) {
+    int index = 0;
+    unsigned sum = 0;
+
+    for (int i = begin; i < end; i++) {
+        const char *op = ops[i];
+        if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) {
+            records[index] = atoi(op);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(op, "C") == 0 && index > 0) {
+            sum -= (unsigned)records[--index];
+        } else if (strcmp(op, "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(op, "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            sum += (unsigned)records[index++];
+        }
+    }
+    return (int)sum;
+}
+
+// Scores games [first, last) of the batch, growing the scratch for long games.
+static int scoreRange(const GameBatch *batch, int *totals, int first, int last,
+                      int **scratch, int *capacity) {
+    for (int g = first; g < last; g++) {
+        int begin = batch->offsets[g], end = batch->offsets[g + 1];
+        if (end - begin > *capacity) {
+            int grown = *capacity;
+            while (grown < end - begin) grown *= 2;
+            int *bigger = realloc(*scratch, grown * sizeof(int));
+            if (!bigger) return -1;
+            *scratch = bigger;
+            *capacity = grown;
+        }
+        totals[g] = scoreGame(batch->ops, begin, end, *scratch);
+    }
+    return 0;
+}
+
+void *batchWorker(void *arg) {
+    BatchWorker *w = (BatchWorker *)arg;
+    int capacity = INITIAL_SCRATCH;
+    int *scratch = malloc(capacity * sizeof(int));
+    int first;
+
+    w->failed = (scratch == NULL);
+    while (!w->failed &&
+           (first = atomic_fetch_add_explicit(w->nextGame, GAMES_PER_CLAIM, memory_order_relaxed)) < w->batch->numGames) {
+        int last = first + GAMES_PER_CLAIM < w->batch->numGames ? first + GAMES_PER_CLAIM : w->batch->numGames;
+        w->failed = scoreRange(w->batch, w->totals, first, last, &scratch, &capacity) != 0;
+    }
+    free(scratch);
+    return NULL;
+}
+
+// Scores every game of the batch into totals[0, numGames). Returns 0, or -1 if out of memory.
+int scoreBatch(const GameBatch *batch, int *totals, int numWorkers) {
+    if (numWorkers <= 1 || batch->numGames < BATCH_PARALLEL_THRESHOLD) {
+        int capacity = INITIAL_SCRATCH;
+        int *scratch = malloc(capacity * sizeof(int));
+        int status = scratch ? scoreRange(batch, totals, 0, batch->numGames, &scratch, &capacity) : -1;
+        free(scratch);
+        return status;
+    }
+
+    pthread_t *threads = malloc(numWorkers * sizeof(pthread_t));
+    BatchWorker *workers = malloc(numWorkers * sizeof(BatchWorker));
+    if (!threads || !workers) {
+        free(threads);
+        free(workers);
+        return -1;
+    }
+    atomic_int nextGame;
+    atomic_init(&nextGame, 0);
+
+    // Games are claimed from the shared counter, so the workers that did start finish the
+    // batch even if the system refuses to create all of them
+    int started = 0;
+    for (int i = 0; i < numWorkers; i++) {
+        workers[i] = (BatchWorker){batch, totals, &nextGame, 0};
+        if (pthread_create(&threads[i], NULL, batchWorker, &workers[i]) != 0) break;
+        started++;
+    }
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    if (started == 0) {
+        batchWorker(&workers[0]);   // No thread could be created: score on the caller
+        started = 1;
+    }
+
+    int status = 0;
+    for (int i = 0; i < started; i++) {
+        if (workers[i].failed) status = -1;
+    }
+    free(threads);
+    free(workers);
+    return status;
+}
+
+// File 2's calPoints, one call per game.
+int calPoints(char *ops[], int size) {
+    int records[MAX_OPERATIONS];
+    return scoreGame(ops, 0, size, records);
+}
+
+typedef struct {
+    char **ops;
+    int size;
+    int result;
+} GameThread;
+
+void *gameThread(void *arg) {
+    GameThread *t = (GameThread *)arg;
+    t->result = calPoints(t->ops, t->size);
+    return NULL;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    // The file-2 test cases as one batch
+    char *testOps[] = {
+        "5", "2", "C", "D", "+",
+        "5", "-2", "4", "C", "D", "9", "+", "+",
+        "1",
+        "0",
+        "10", "C",
+        "-10", "D", "D", "C", "+",
+        "5", "10", "+", "D", "+", "C"
+    };
+    int testOffsets[] = {0, 5, 13, 14, 15, 17, 22, 28};
+    int testTotals[7];
+    GameBatch tests = {testOps, testOffsets, 7};
+    scoreBatch(&tests, testTotals, NUM_WORKERS);
+    for (int g = 0; g < tests.numGames; g++) {
+        printf("Test %d: %d\n", g + 1, testTotals[g]);
+    }
+
+    // Millions of short games in one shared buffer
+    static char *pool[] = {"5", "2", "C", "D", "+", "-2", "4", "9", "10", "-10", "0", "1"};
+    int poolSize = sizeof(pool) / sizeof(pool[0]);
+    char **ops = malloc((size_t)NUM_BATCH_GAMES * MAX_GAME_OPS * sizeof(char *));
+    int *offsets = malloc((NUM_BATCH_GAMES + 1) * sizeof(int));
+    int *expected = malloc(NUM_BATCH_GAMES * sizeof(int));
+    int *totals = malloc(NUM_BATCH_GAMES * sizeof(int));
+    if (!ops || !offsets || !expected || !totals) {
+        fprintf(stderr, "Could not allocate the batch\n");
+        return EXIT_FAILURE;
+    }
+
+    srand(42);
+    int used = 0;
+    for (int g = 0; g < NUM_BATCH_GAMES; g++) {
+        offsets[g] = used;
+        int length = 1 + rand() % MAX_GAME_OPS;
+        for (int k = 0; k < length; k++) ops[used++] = pool[rand() % poolSize];
+    }
+    offsets[NUM_BATCH_GAMES] = used;
+    GameBatch batch = {ops, offsets, NUM_BATCH_GAMES};
+
+    // File 2: one calPoints call per game
+    double start = nowMs();
+    for (int g = 0; g < NUM_BATCH_GAMES; g++) {
+        expected[g] = calPoints(&ops[offsets[g]], offsets[g + 1] - offsets[g]);
+    }
+    printf("Per-game calPoints loop:   %.1f ns/game\n", (nowMs() - start) * 1e6 / NUM_BATCH_GAMES);
+
+    // One thread per game, on a sample
+    int failed = 0;
+    start = nowMs();
+    for (int g = 0; g < DISPATCH_SAMPLE; g++) {
+        pthread_t thread;
+        GameThread t = {&ops[offsets[g]], offsets[g + 1] - offsets[g], 0};
+        pthread_create(&thread, NULL, gameThread, &t);
+        pthread_join(thread, NULL);
+        failed |= (t.result != expected[g]);
+    }
+    printf("Thread per game (sample):  %.1f ns/game\n", (nowMs() - start) * 1e6 / DISPATCH_SAMPLE);
+
+    int workerCounts[] = {1, NUM_WORKERS, MANY_WORKERS};
+    for (int k = 0; k < 3; k++) {
+        for (int g = 0; g < NUM_BATCH_GAMES; g++) totals[g] = 0x7fffffff;
+        start = nowMs();
+        failed |= scoreBatch(&batch, totals, workerCounts[k]) != 0;
+        double elapsed = nowMs() - start;
+        char label[32];
+        snprintf(label, sizeof(label), "%d worker%s:", workerCounts[k], workerCounts[k] == 1 ? "" : "s");
+        printf("scoreBatch, %-15s %.1f ns/game\n", label, elapsed * 1e6 / NUM_BATCH_GAMES);
+        for (int g = 0; g < NUM_BATCH_GAMES; g++) failed |= (totals[g] != expected[g]);
+    }
+
+    // One long game in the middle of the batch forces the worker's scratch to grow
+    int longOps = 1000000;
+    char **mixedOps = malloc((longOps + 2) * sizeof(char *));
+    if (!mixedOps) {
+        fprintf(stderr, "Could not allocate the long game\n");
+        return EXIT_FAILURE;
+    }
+    mixedOps[0] = "7";
+    for (int i = 0; i < longOps; i += 2) {
+        mixedOps[1 + i] = "10";
+        mixedOps[2 + i] = "D";
+    }
+    mixedOps[longOps + 1] = "D";
+    int mixedOffsets[] = {0, 1, longOps + 1, longOps + 2};
+    int mixedTotals[3];
+    GameBatch mixed = {mixedOps, mixedOffsets, 3};
+    failed |= scoreBatch(&mixed, mixedTotals, NUM_WORKERS) != 0;
+    failed |= mixedTotals[0] != 7 || mixedTotals[1] != 15000000 || mixedTotals[2] != 0;
+    printf("Long game in a batch: %d\n", mixedTotals[1]);
+    free(mixedOps);
+
+    unsigned checksum = 0;
+    for (int g = 0; g < NUM_BATCH_GAMES; g++) checksum = checksum * 31u + (unsigned)totals[g];
+    printf("Batch totals: %s (%d games, checksum %u)\n", failed ? "FAILED" : "OK", NUM_BATCH_GAMES, checksum);
+
+    free(ops);
+    free(offsets);
+    free(expected);
+    free(totals);
+    if (failed) {
+        fprintf(stderr, "Mismatch between batch and per-game results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
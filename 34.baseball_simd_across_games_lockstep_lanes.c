@@ -0,0 +1,565 @@
+/*
+ * SIMD Across Games: One Vector Lane per Game in a Structure-of-Arrays Layout
+
+   Why Vectorize Across Games?
+
+   Every SIMD file so far vectorizes INSIDE one game: the final sum over records. A game of
+   2.baseball_game_direct_update_sum_store_converted_values.c has 1 to 8 ops, so its records
+   array fits in a single register and there is nothing to vectorize. The per-op work is the
+   C/D/+ state machine, and that is a chain of data-dependent branches.
+
+   A batch of short games has plenty of independent work, though. This file runs the state
+   machine for 8 games at once (AVX2) or 16 games at once (AVX-512), one game per lane:
+
+   1. decodeBatch() turns the op strings into one opcode byte and one value per op, stored
+      game by game (the offsets layout of file 33).
+   2. transposeGames() sorts the games by length (a counting sort), cuts them into groups of
+      `lanes` games and writes each group in structure-of-arrays form:
+
+          row r of a group:  codes[r * lanes + lane], values[r * lanes + lane]
+
+      Short lanes are padded with OP_SKIP. Sorting by length keeps almost every lane busy
+      until the last row, so a group of 8 costs about as many steps as its longest game.
+   3. The lane kernels keep, per lane, a stack depth, a running sum and a records window
+      (records[d] is one vector holding depth d of every lane). Each row is one step for all
+      lanes:
+      - top and second are picked from the window with compare masks on the depth;
+      - the value to push is a number, 2 * top or top + second, chosen with blends;
+      - push = number, or D with depth > 0, or + with depth > 1; pop = C with depth > 0;
+      - the pushed value is blended into records[depth] of the pushing lanes only, and the
+        sum and depth are updated with the masks (no branches at all).
+      The ops of different lanes are free to differ; the masks take care of it. A group of
+      n rows never gets deeper than n, so the kernel is inlined once per window size
+      1..RECORDS_WINDOW and short groups pay only for the depths they can reach.
+   4. Games longer than RECORDS_WINDOW ops could outgrow the window. They skip the lanes and
+      are scored by the scalar loop instead.
+
+   The kernels are compiled with __attribute__((target(...))), as in file 26, and are used
+   only if __builtin_cpu_supports() reports that the CPU and OS can run them. Integer adds
+   wrap in every kernel, like the unsigned running sum of file 2.
+
+   Input Explained
+   ---------------
+   - The seven test cases from file 2 plus the 1M-op "10","D" game (longer than the window,
+     so it takes the scalar path), scored by every kernel.
+   - NUM_BATCH_GAMES random games of 1 to 8 ops. Every kernel is timed per game on the decoded
+     ops, and the transpose is timed separately. All totals must match file 2's calPoints.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60, Long game: 15000000
+   File-2 calPoints per game: [ns] ns/game
+   scalar   lanes  1: transpose [ns] ns/game, evaluate [ns] ns/game
+   avx2     lanes  8: transpose [ns] ns/game, evaluate [ns] ns/game ([x]x scalar)
+   avx512   lanes 16: transpose [ns] ns/game, evaluate [ns] ns/game ([x]x scalar)
+   Lane totals: OK ([n] games)
+
+   gcc -O3 34.baseball_simd_across_games_lockstep_lanes.c -o baseball_lanes
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), malloc(), aligned_alloc(), rand()
+#include <string.h>       // strcmp(), memset()
+#include <ctype.h>        // isdigit()
+#include <immintrin.h>    // AVX2 / AVX-512 intrinsics (per-function targets)
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000          // File 2's per-game records limit
+#define NUM_BATCH_GAMES 2000000
+#define MAX_GAME_OPS 8
+#define RECORDS_WINDOW 8             // Records kept per lane; longer games are scored scalar
+#define LONG_GAME_OPS 1000000
+
+enum { OP_NUM, OP_C, OP_D, OP_PLUS, OP_SKIP };   // OP_SKIP: unknown tokens and lane padding
+
+typedef struct {
+    unsigned char *codes;  // One opcode per op, game after game
+    int *values;           // Number of an OP_NUM op, 0 otherwise
+    const int *offsets;    // Game g is [offsets[g], offsets[g + 1]); numGames + 1 entries
+    int numGames;
+} DecodedBatch;
+
+typedef struct {
+    int lanes;             // 8 (AVX2) or 16 (AVX-512)
+    int numGroups;
+    int *groupStart;       // Group g is rows [groupStart[g], groupStart[g + 1])
+    int *gameOf;           // gameOf[g * lanes + lane]: game in that lane, -1 if empty
+    unsigned char *codes;  // codes[row * lanes + lane]
+    int *values;           // values[row * lanes + lane], 64-byte aligned
+    int *longGames;        // Games longer than RECORDS_WINDOW, scored scalar
+    int numLong;
+} LaneBatch;
+
+typedef void (*LaneKernel)(const LaneBatch *lb, int *totals);
+
+typedef struct {
+    const char *name;
+    int lanes;
+    LaneKernel fn;
+    int supported;
+} LaneKernelEntry;
+
+static inline int decodeOp(const char *op, int *value) {
+    *value = 0;
+    if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) {
+        *value = atoi(op);
+        return OP_NUM;
+    }
+    if (strcmp(op, "C") == 0) return OP_C;
+    if (strcmp(op, "D") == 0) return OP_D;
+    if (strcmp(op, "+") == 0) return OP_PLUS;
+    return OP_SKIP;
+}
+
+// Decodes every op of the games once; codes/values must hold offsets[numGames] entries.
+void decodeBatch(char **ops, const int *offsets, int numGames, DecodedBatch *out) {
+    for (int i = 0; i < offsets[numGames]; i++) {
+        out->codes[i] = (unsigned char)decodeOp(ops[i], &out->values[i]);
+    }
+    out->offsets = offsets;
+    out->numGames = numGames;
+}
+
+// File 2's running-sum loop on decoded ops; records must hold end - begin entries.
+static int scoreDecoded(const unsigned char *codes, const int *values, int begin, int end, int *records) {
+    int index = 0;
+    unsigned sum = 0;
+
+    for (int i = begin; i < end; i++) {
+        switch (codes[i]) {
+        case OP_NUM:
+            records[index] = values[i];
+            sum += (unsigned)records[index++];
+            break;
+        case OP_C:
+            if (index > 0) sum -= (unsigned)records[--index];
+            break;
+        case OP_D:
+            if (index > 0) {
+                records[index] = (int)(2u * (unsigned)records[index - 1]);
+                sum += (unsigned)records[index++];
+            }
+            break;
+        case OP_PLUS:
+            if (index > 1) {
+                records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+                sum += (unsigned)records[index++];
+            }
+            break;
+        }
+    }
+    return (int)sum;
+}
+
+void freeLaneBatch(LaneBatch *lb) {
+    free(lb->groupStart);
+    free(lb->gameOf);
+    free(lb->codes);
+    free(lb->values);
+    free(lb->longGames);
+    memset(lb, 0, sizeof(*lb));
+}
+
+// Sorts the games by length and writes them as groups of `lanes` games in SoA form.
+int transposeGames(const DecodedBatch *db, int lanes, LaneBatch *lb) {
+    int bucketStart[RECORDS_WINDOW + 2] = {0};
+    int numShort = 0, numLong = 0;
+
+    memset(lb, 0, sizeof(*lb));
+    lb->lanes = lanes;
+    for (int g = 0; g < db->numGames; g++) {
+        int length = db->offsets[g + 1] - db->offsets[g];
+        if (length > RECORDS_WINDOW) numLong++;
+        else bucketStart[length + 1]++;
+    }
+    for (int k = 1; k <= RECORDS_WINDOW + 1; k++) bucketStart[k] += bucketStart[k - 1];
+    numShort = bucketStart[RECORDS_WINDOW + 1];
+
+    int *order = malloc((numShort + 1) * sizeof(int));
+    lb->longGames = malloc((numLong + 1) * sizeof(int));
+    if (!order || !lb->longGames) {
+        free(order);
+        freeLaneBatch(lb);
+        return -1;
+    }
+    for (int g = 0; g < db->numGames; g++) {
+        int length = db->offsets[g + 1] - db->offsets[g];
+        if (length > RECORDS_WINDOW) lb->longGames[lb->numLong++] = g;
+        else order[bucketStart[length]++] = g;
+    }
+
+    // Sorted ascending, so the last game of a group is its longest
+    lb->numGroups = (numShort + lanes - 1) / lanes;
+    lb->groupStart = malloc((lb->numGroups + 1) * sizeof(int));
+    lb->gameOf = malloc(((size_t)lb->numGroups * lanes + 1) * sizeof(int));
+    if (!lb->groupStart || !lb->gameOf) {
+        free(order);
+        freeLaneBatch(lb);
+        return -1;
+    }
+    int rows = 0;
+    for (int g = 0; g < lb->numGroups; g++) {
+        int last = order[(g + 1) * lanes < numShort ? (g + 1) * lanes - 1 : numShort - 1];
+        lb->groupStart[g] = rows;
+        rows += db->offsets[last + 1] - db->offsets[last];
+    }
+    lb->groupStart[lb->numGroups] = rows;
+
+    size_t cells = (size_t)rows * lanes;
+    size_t valueBytes = (cells * sizeof(int) + 63) / 64 * 64 + 64;
+    lb->codes = malloc(cells + 1);
+    lb->values = aligned_alloc(64, valueBytes);
+    if (!lb->codes || !lb->values) {
+        free(order);
+        freeLaneBatch(lb);
+        return -1;
+    }
+    memset(lb->codes, OP_SKIP, cells);
+    memset(lb->values, 0, valueBytes);
+
+    for (int g = 0; g < lb->numGroups; g++) {
+        for (int lane = 0; lane < lanes; lane++) {
+            int slot = g * lanes + lane;
+            int game = slot < numShort ? order[slot] : -1;
+            lb->gameOf[slot] = game;
+            if (game < 0) continue;
+            for (int i = db->offsets[game], row = lb->groupStart[g]; i < db->offsets[game + 1]; i++, row++) {
+                lb->codes[(size_t)row * lanes + lane] = db->codes[i];
+                lb->values[(size_t)row * lanes + lane] = db->values[i];
+            }
+        }
+    }
+    free(order);
+    return 0;
+}
+
+// Lane count 1: the scalar loop over each group's games, for comparison and fallback.
+static void scoreLanesScalar(const LaneBatch *lb, int *totals) {
+    int records[RECORDS_WINDOW];
+
+    for (int g = 0; g < lb->numGroups; g++) {
+        int rows = lb->groupStart[g + 1] - lb->groupStart[g];
+        int game = lb->gameOf[g];
+        int row = lb->groupStart[g];
+        totals[game] = scoreDecoded(lb->codes, lb->values, row, row + rows, records);
+    }
+}
+
+// One group of 8 games; window is its row count, a constant after inlining.
+static inline __attribute__((always_inline, target("avx2")))
+void scoreGroupAvx2(const LaneBatch *lb, int g, int window, int *totals) {
+    const __m256i opC = _mm256_set1_epi32(OP_C), opD = _mm256_set1_epi32(OP_D);
+    const __m256i opNum = _mm256_set1_epi32(OP_NUM), opPlus = _mm256_set1_epi32(OP_PLUS);
+    const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi32(1);
+    __m256i records[RECORDS_WINDOW];
+    __m256i depth = zero, sum = zero;
+    for (int d = 0; d < window; d++) records[d] = zero;
+
+    for (int row = lb->groupStart[g]; row < lb->groupStart[g + 1]; row++) {
+        __m256i code = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&lb->codes[row * 8]));
+        __m256i value = _mm256_load_si256((const __m256i *)&lb->values[row * 8]);
+
+        // top = records[depth - 1], second = records[depth - 2], per lane
+        __m256i top = zero, second = zero;
+        __m256i atDepth[RECORDS_WINDOW + 1];
+        for (int d = 0; d <= window; d++) atDepth[d] = _mm256_cmpeq_epi32(depth, _mm256_set1_epi32(d));
+        for (int d = 0; d < window; d++) {
+            top = _mm256_blendv_epi8(top, records[d], atDepth[d + 1]);
+            if (d + 2 <= window) second = _mm256_blendv_epi8(second, records[d], atDepth[d + 2]);
+        }
+
+        __m256i isD = _mm256_cmpeq_epi32(code, opD), isPlus = _mm256_cmpeq_epi32(code, opPlus);
+        __m256i has1 = _mm256_cmpgt_epi32(depth, zero), has2 = _mm256_cmpgt_epi32(depth, one);
+        __m256i push = _mm256_or_si256(_mm256_cmpeq_epi32(code, opNum),
+                       _mm256_or_si256(_mm256_and_si256(isD, has1), _mm256_and_si256(isPlus, has2)));
+        __m256i pop = _mm256_and_si256(_mm256_cmpeq_epi32(code, opC), has1);
+
+        __m256i pushed = _mm256_blendv_epi8(value, _mm256_add_epi32(top, top), isD);
+        pushed = _mm256_blendv_epi8(pushed, _mm256_add_epi32(top, second), isPlus);
+        for (int d = 0; d < window; d++) {
+            records[d] = _mm256_blendv_epi8(records[d], pushed, _mm256_and_si256(push, atDepth[d]));
+        }
+
+        sum = _mm256_add_epi32(sum, _mm256_and_si256(push, pushed));
+        sum = _mm256_sub_epi32(sum, _mm256_and_si256(pop, top));
+        depth = _mm256_add_epi32(_mm256_sub_epi32(depth, push), pop);   // masks are 0 or -1
+    }
+
+    int laneSums[8];
+    _mm256_storeu_si256((__m256i *)laneSums, sum);
+    for (int lane = 0; lane < 8; lane++) {
+        int game = lb->gameOf[g * 8 + lane];
+        if (game >= 0) totals[game] = laneSums[lane];
+    }
+}
+
+__attribute__((target("avx2")))
+static void scoreLanesAvx2(const LaneBatch *lb, int *totals) {
+    for (int g = 0; g < lb->numGroups; g++) {
+        switch (lb->groupStart[g + 1] - lb->groupStart[g]) {
+        case 0: case 1: scoreGroupAvx2(lb, g, 1, totals); break;
+        case 2: scoreGroupAvx2(lb, g, 2, totals); break;
+        case 3: scoreGroupAvx2(lb, g, 3, totals); break;
+        case 4: scoreGroupAvx2(lb, g, 4, totals); break;
+        case 5: scoreGroupAvx2(lb, g, 5, totals); break;
+        case 6: scoreGroupAvx2(lb, g, 6, totals); break;
+        case 7: scoreGroupAvx2(lb, g, 7, totals); break;
+        default: scoreGroupAvx2(lb, g, RECORDS_WINDOW, totals); break;
+        }
+    }
+}
+
+static inline __attribute__((always_inline, target("avx512f")))
+void scoreGroupAvx512(const LaneBatch *lb, int g, int window, int *totals) {
+    const __m512i opC = _mm512_set1_epi32(OP_C), opD = _mm512_set1_epi32(OP_D);
+    const __m512i opNum = _mm512_set1_epi32(OP_NUM), opPlus = _mm512_set1_epi32(OP_PLUS);
+    const __m512i zero = _mm512_setzero_si512(), one = _mm512_set1_epi32(1);
+    __m512i records[RECORDS_WINDOW];
+    __m512i depth = zero, sum = zero;
+    for (int d = 0; d < window; d++) records[d] = zero;
+
+    for (int row = lb->groupStart[g]; row < lb->groupStart[g + 1]; row++) {
+        __m512i code = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)&lb->codes[row * 16]));
+        __m512i value = _mm512_load_si512((const void *)&lb->values[row * 16]);
+
+        __m512i top = zero, second = zero;
+        __mmask16 atDepth[RECORDS_WINDOW + 1];
+        for (int d = 0; d <= window; d++) atDepth[d] = _mm512_cmpeq_epi32_mask(depth, _mm512_set1_epi32(d));
+        for (int d = 0; d < window; d++) {
+            top = _mm512_mask_blend_epi32(atDepth[d + 1], top, records[d]);
+            if (d + 2 <= window) second = _mm512_mask_blend_epi32(atDepth[d + 2], second, records[d]);
+        }
+
+        __mmask16 isD = _mm512_cmpeq_epi32_mask(code, opD), isPlus = _mm512_cmpeq_epi32_mask(code, opPlus);
+        __mmask16 has1 = _mm512_cmpgt_epi32_mask(depth, zero), has2 = _mm512_cmpgt_epi32_mask(depth, one);
+        __mmask16 push = _mm512_cmpeq_epi32_mask(code, opNum) | (isD & has1) | (isPlus & has2);
+        __mmask16 pop = _mm512_cmpeq_epi32_mask(code, opC) & has1;
+
+        __m512i pushed = _mm512_mask_blend_epi32(isD, value, _mm512_add_epi32(top, top));
+        pushed = _mm512_mask_blend_epi32(isPlus, pushed, _mm512_add_epi32(top, second));
+        for (int d = 0; d < window; d++) {
+            records[d] = _mm512_mask_blend_epi32(push & atDepth[d], records[d], pushed);
+        }
+
+        sum = _mm512_mask_add_epi32(sum, push, sum, pushed);
+        sum = _mm512_mask_sub_epi32(sum, pop, sum, top);
+        depth = _mm512_mask_add_epi32(depth, push, depth, one);
+        depth = _mm512_mask_sub_epi32(depth, pop, depth, one);
+    }
+
+    int laneSums[16];
+    _mm512_storeu_si512((void *)laneSums, sum);
+    for (int lane = 0; lane < 16; lane++) {
+        int game = lb->gameOf[g * 16 + lane];
+        if (game >= 0) totals[game] = laneSums[lane];
+    }
+}
+
+__attribute__((target("avx512f")))
+static void scoreLanesAvx512(const LaneBatch *lb, int *totals) {
+    for (int g = 0; g < lb->numGroups; g++) {
+        switch (lb->groupStart[g + 1] - lb->groupStart[g]) {
+        case 0: case 1: scoreGroupAvx512(lb, g, 1, totals); break;
+        case 2: scoreGroupAvx512(lb, g, 2, totals); break;
+        case 3: scoreGroupAvx512(lb, g, 3, totals); break;
+        case 4: scoreGroupAvx512(lb, g, 4, totals); break;
+        case 5: scoreGroupAvx512(lb, g, 5, totals); break;
+        case 6: scoreGroupAvx512(lb, g, 6, totals); break;
+        case 7: scoreGroupAvx512(lb, g, 7, totals); break;
+        default: scoreGroupAvx512(lb, g, RECORDS_WINDOW, totals); break;
+        }
+    }
+}
+
+static LaneKernelEntry laneKernels[] = {
+    {"scalar", 1,  scoreLanesScalar, 1},
+    {"avx2",   8,  scoreLanesAvx2,   0},
+    {"avx512", 16, scoreLanesAvx512, 0},
+};
+#define NUM_LANE_KERNELS ((int)(sizeof(laneKernels) / sizeof(laneKernels[0])))
+
+void detectLaneKernels(void) {
+    __builtin_cpu_init();
+    laneKernels[1].supported = __builtin_cpu_supports("avx2");
+    laneKernels[2].supported = __builtin_cpu_supports("avx512f");
+}
+
+// Scores the short games in lanes and the long ones with the scalar loop.
+int scoreWithLanes(const DecodedBatch *db, const LaneKernelEntry *k, int *totals) {
+    LaneBatch lb;
+    if (transposeGames(db, k->lanes, &lb) != 0) return -1;
+
+    k->fn(&lb, totals);
+    int *records = malloc(MAX_OPERATIONS * sizeof(int));
+    int capacity = MAX_OPERATIONS;
+    for (int i = 0; i < lb.numLong; i++) {
+        int g = lb.longGames[i];
+        int begin = db->offsets[g], end = db->offsets[g + 1];
+        if (records && end - begin > capacity) {
+            free(records);
+            capacity = end - begin;
+            records = malloc(capacity * sizeof(int));
+        }
+        if (!records) {
+            freeLaneBatch(&lb);
+            return -1;
+        }
+        totals[g] = scoreDecoded(db->codes, db->values, begin, end, records);
+    }
+    free(records);
+    freeLaneBatch(&lb);
+    return 0;
+}
+
+// File 2's calPoints, one call per game.
+int calPoints(char *ops[], int size) {
+    int records[MAX_OPERATIONS];
+    int index = 0;
+    unsigned sum = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index] = atoi(ops[i]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            sum -= (unsigned)records[--index];
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            sum += (unsigned)records[index++];
+        }
+    }
+    return (int)sum;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    int failed = 0;
+    detectLaneKernels();
+
+    // The file-2 test cases plus one long game, as one batch
+    static char *testOps[28 + LONG_GAME_OPS];
+    char *shortOps[] = {
+        "5", "2", "C", "D", "+",
+        "5", "-2", "4", "C", "D", "9", "+", "+",
+        "1",
+        "0",
+        "10", "C",
+        "-10", "D", "D", "C", "+",
+        "5", "10", "+", "D", "+", "C"
+    };
+    for (int i = 0; i < 28; i++) testOps[i] = shortOps[i];
+    for (int i = 0; i < LONG_GAME_OPS; i += 2) {
+        testOps[28 + i] = "10";
+        testOps[29 + i] = "D";
+    }
+    int testOffsets[] = {0, 5, 13, 14, 15, 17, 22, 28, 28 + LONG_GAME_OPS};
+    int testExpected[] = {30, 27, 1, 0, 0, -60, 60, 15000000};
+    unsigned char *testCodes = malloc(28 + LONG_GAME_OPS);
+    int *testValues = malloc((28 + LONG_GAME_OPS) * sizeof(int));
+    if (!testCodes || !testValues) {
+        fprintf(stderr, "Could not allocate the test batch\n");
+        return EXIT_FAILURE;
+    }
+    DecodedBatch tests = {testCodes, testValues, NULL, 0};
+    decodeBatch(testOps, testOffsets, 8, &tests);
+
+    for (int k = 0; k < NUM_LANE_KERNELS; k++) {
+        int testTotals[8];
+        if (!laneKernels[k].supported) continue;
+        failed |= scoreWithLanes(&tests, &laneKernels[k], testTotals) != 0;
+        for (int g = 0; g < 8; g++) failed |= testTotals[g] != testExpected[g];
+        if (k == 0) {
+            for (int g = 0; g < 7; g++) printf("Test %d: %d\n", g + 1, testTotals[g]);
+            printf("Long game: %d\n", testTotals[7]);
+        }
+    }
+    free(testCodes);
+    free(testValues);
+
+    // Millions of short games
+    static char *pool[] = {"5", "2", "C", "D", "+", "-2", "4", "9", "10", "-10", "0", "1"};
+    int poolSize = sizeof(pool) / sizeof(pool[0]);
+    char **ops = malloc((size_t)NUM_BATCH_GAMES * MAX_GAME_OPS * sizeof(char *));
+    int *offsets = malloc((NUM_BATCH_GAMES + 1) * sizeof(int));
+    int *expected = malloc(NUM_BATCH_GAMES * sizeof(int));
+    int *totals = malloc(NUM_BATCH_GAMES * sizeof(int));
+    unsigned char *codes = malloc((size_t)NUM_BATCH_GAMES * MAX_GAME_OPS);
+    int *values = malloc((size_t)NUM_BATCH_GAMES * MAX_GAME_OPS * sizeof(int));
+    if (!ops || !offsets || !expected || !totals || !codes || !values) {
+        fprintf(stderr, "Could not allocate the batch\n");
+        return EXIT_FAILURE;
+    }
+
+    srand(42);
+    int used = 0;
+    for (int g = 0; g < NUM_BATCH_GAMES; g++) {
+        offsets[g] = used;
+        int length = 1 + rand() % MAX_GAME_OPS;
+        for (int k = 0; k < length; k++) ops[used++] = pool[rand() % poolSize];
+    }
+    offsets[NUM_BATCH_GAMES] = used;
+
+    double start = nowMs();
+    for (int g = 0; g < NUM_BATCH_GAMES; g++) {
+        expected[g] = calPoints(&ops[offsets[g]], offsets[g + 1] - offsets[g]);
+    }
+    printf("File-2 calPoints per game: %.1f ns/game\n", (nowMs() - start) * 1e6 / NUM_BATCH_GAMES);
+
+    DecodedBatch batch = {codes, values, NULL, 0};
+    decodeBatch(ops, offsets, NUM_BATCH_GAMES, &batch);
+
+    double scalarNs = 0;
+    for (int k = 0; k < NUM_LANE_KERNELS; k++) {
+        const LaneKernelEntry *kernel = &laneKernels[k];
+        if (!kernel->supported) {
+            printf("%-8s lanes %2d: not supported by this CPU\n", kernel->name, kernel->lanes);
+            continue;
+        }
+
+        LaneBatch lb;
+        start = nowMs();
+        if (transposeGames(&batch, kernel->lanes, &lb) != 0) {
+            fprintf(stderr, "Could not allocate the lane batch\n");
+            return EXIT_FAILURE;
+        }
+        double transposeNs = (nowMs() - start) * 1e6 / NUM_BATCH_GAMES;
+
+        for (int g = 0; g < NUM_BATCH_GAMES; g++) totals[g] = 0x7fffffff;
+        start = nowMs();
+        kernel->fn(&lb, totals);
+        double evaluateNs = (nowMs() - start) * 1e6 / NUM_BATCH_GAMES;
+        freeLaneBatch(&lb);
+
+        for (int g = 0; g < NUM_BATCH_GAMES; g++) failed |= totals[g] != expected[g];
+        if (k == 0) {
+            scalarNs = evaluateNs;
+            printf("%-8s lanes %2d: transpose %.1f ns/game, evaluate %.1f ns/game\n",
+                   kernel->name, kernel->lanes, transposeNs, evaluateNs);
+        } else {
+            printf("%-8s lanes %2d: transpose %.1f ns/game, evaluate %.1f ns/game (%.1fx scalar)\n",
+                   kernel->name, kernel->lanes, transposeNs, evaluateNs, scalarNs / evaluateNs);
+        }
+    }
+    printf("Lane totals: %s (%d games)\n", failed ? "FAILED" : "OK", NUM_BATCH_GAMES);
+
+    free(ops);
+    free(offsets);
+    free(expected);
+    free(totals);
+    free(codes);
+    free(values);
+    if (failed) {
+        fprintf(stderr, "Mismatch between lane and per-game results!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
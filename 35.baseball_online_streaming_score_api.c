@@ -0,0 +1,279 @@
+/*
+ * Online Scoring API: O(1) score_push() and a Running Total Readable at Any Time
+
+   Why a Streaming API?
+
+   2.baseball_game_direct_update_sum_store_converted_values.c already keeps a running `sum`
+   next to `records`, but only inside one calPoints call over a finished ops array. The live
+   feed scores a game while it is being played and asks for the current total thousands of
+   times per second. Re-running calPoints on the ops so far costs O(n) per question.
+
+   API
+   ---
+       ScoreStream *s = score_open();
+       score_push(s, "5");        // after every op that arrives
+       score_total(s);            // current total, any time, from any thread
+       score_close(s);
+
+   - score_push() does the work of ONE iteration of file 2's loop, so every op, including
+     C, D and +, is O(1):
+       number / D / +  write one record and add it to the total;
+       C               removes the top record and subtracts it from the total.
+     Invalid ops and C/D/+ on too few records are ignored, as in files 1 and 2.
+   - score_total() is a single load. It never walks the records.
+   - Records live in chunks of STREAM_CHUNK ints, as in the arena of file 18. A push never
+     copies earlier records, so there is no realloc pause in the middle of a game. Only the
+     small chunk table (one pointer per chunk) ever grows. Popped chunks are kept, so C/push
+     sequences around a chunk boundary do not allocate.
+   - One thread pushes per stream. The total is published with a release store and read with
+     an acquire load, so any number of reader threads can call score_total() while the feed
+     thread is pushing. They see the total after some complete op, never a torn value.
+   - The total wraps like file 2's unsigned running sum.
+
+   The names follow the snake_case the feed service already calls (score_open, score_push,
+   score_total, score_close).
+
+   Input Explained
+   ---------------
+   - The seven test cases from file 2, each pushed into its own stream.
+   - "10", "D" repeated 500,000 times, pushed one op at a time with score_total() after every
+     push, compared with re-running calPoints on the prefix every QUERY_EVERY ops.
+   - A random stream of RANDOM_OPS ops (many C's, so it shrinks and grows across chunk
+     boundaries), checked against calPoints on the prefix every CHECK_EVERY ops.
+   - A reader thread that keeps calling score_total() while the main thread pushes.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Streaming: [ns] ns/push (with score_total after each), Result: 15000000
+   Recompute prefix every 10000 ops: [time_ms] ms, Result: 15000000
+   Random stream: OK ([n] checkpoints)
+   Concurrent reader: [n] reads, last total 15000000
+
+   gcc -pthread -O3 35.baseball_online_streaming_score_api.c -o baseball_stream
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), malloc(), realloc(), free(), rand()
+#include <string.h>       // strcmp()
+#include <ctype.h>        // isdigit()
+#include <pthread.h>      // Concurrent reader
+#include <stdatomic.h>    // Published total
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define STREAM_CHUNK_SHIFT 12
+#define STREAM_CHUNK (1 << STREAM_CHUNK_SHIFT)   // Records per chunk (16 KB)
+#define STREAM_CHUNK_MASK (STREAM_CHUNK - 1)
+#define QUERY_EVERY 10000                         // Prefix recomputation interval in the baseline
+#define RANDOM_OPS 200000
+#define CHECK_EVERY 997
+
+typedef struct {
+    int **chunks;              // Records: position i is chunks[i >> SHIFT][i & MASK]
+    int numChunks;             // Chunks allocated (kept after pops)
+    int tableSize;             // Capacity of the chunk table
+    int index;                 // Records in use
+    unsigned sum;              // Running total, owned by the pushing thread
+    atomic_uint published;     // Copy of sum for score_total()
+} ScoreStream;
+
+ScoreStream *score_open(void) {
+    ScoreStream *s = calloc(1, sizeof(ScoreStream));
+    if (!s) return NULL;
+    atomic_init(&s->published, 0);
+    return s;
+}
+
+void score_close(ScoreStream *s) {
+    if (!s) return;
+    for (int c = 0; c < s->numChunks; c++) free(s->chunks[c]);
+    free(s->chunks);
+    free(s);
+}
+
+static inline int *streamSlot(ScoreStream *s, int i) {
+    return &s->chunks[i >> STREAM_CHUNK_SHIFT][i & STREAM_CHUNK_MASK];
+}
+
+// Makes sure position s->index exists. Allocates only when a never-used chunk is entered.
+static int streamReserve(ScoreStream *s) {
+    if ((s->index >> STREAM_CHUNK_SHIFT) < s->numChunks) return 0;
+
+    if (s->numChunks == s->tableSize) {
+        int size = s->tableSize ? s->tableSize * 2 : 16;
+        int **table = realloc(s->chunks, size * sizeof(int *));
+        if (!table) return -1;
+        s->chunks = table;
+        s->tableSize = size;
+    }
+    s->chunks[s->numChunks] = malloc(STREAM_CHUNK * sizeof(int));
+    if (!s->chunks[s->numChunks]) return -1;
+    s->numChunks++;
+    return 0;
+}
+
+static inline int streamRecord(ScoreStream *s, int value) {
+    if (streamReserve(s) != 0) return -1;
+    *streamSlot(s, s->index++) = value;
+    s->sum += (unsigned)value;
+    return 0;
+}
+
+// Applies one op. Returns 0, or -1 if a new chunk could not be allocated.
+int score_push(ScoreStream *s, const char *op) {
+    int status = 0;
+
+    if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) {
+        status = streamRecord(s, atoi(op));
+    } else if (strcmp(op, "C") == 0 && s->index > 0) {
+        s->sum -= (unsigned)*streamSlot(s, --s->index);
+    } else if (strcmp(op, "D") == 0 && s->index > 0) {
+        status = streamRecord(s, (int)(2u * (unsigned)*streamSlot(s, s->index - 1)));
+    } else if (strcmp(op, "+") == 0 && s->index > 1) {
+        status = streamRecord(s, (int)((unsigned)*streamSlot(s, s->index - 1) +
+                                       (unsigned)*streamSlot(s, s->index - 2)));
+    }
+    atomic_store_explicit(&s->published, s->sum, memory_order_release);
+    return status;
+}
+
+int score_total(const ScoreStream *s) {
+    return (int)atomic_load_explicit(&((ScoreStream *)s)->published, memory_order_acquire);
+}
+
+// File 2's calPoints, the batch reference.
+int calPoints(char *ops[], int size) {
+    static int records[MAX_OPERATIONS];
+    int index = 0;
+    unsigned sum = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index] = atoi(ops[i]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            sum -= (unsigned)records[--index];
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            sum += (unsigned)records[index++];
+        }
+    }
+    return (int)sum;
+}
+
+typedef struct {
+    ScoreStream *stream;
+    atomic_int stop;
+    long long reads;
+    int last;
+} TotalReader;
+
+void *readTotals(void *arg) {
+    TotalReader *r = (TotalReader *)arg;
+    while (!atomic_load_explicit(&r->stop, memory_order_acquire)) {
+        r->last = score_total(r->stream);
+        r->reads++;
+    }
+    r->last = score_total(r->stream);
+    return NULL;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    int failed = 0;
+
+    // Test cases
+    char *testCases[][10] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int testSizes[] = {5, 8, 1, 1, 2, 5, 6};
+    for (int t = 0; t < 7; t++) {
+        ScoreStream *s = score_open();
+        if (!s) return EXIT_FAILURE;
+        for (int i = 0; i < testSizes[t]; i++) failed |= score_push(s, testCases[t][i]) != 0;
+        printf("Test %d: %d\n", t + 1, score_total(s));
+        failed |= score_total(s) != calPoints(testCases[t], testSizes[t]);
+        score_close(s);
+    }
+
+    // Large input, one op at a time
+    static char *ops[MAX_OPERATIONS];
+    for (int i = 0; i < MAX_OPERATIONS; i += 2) {
+        ops[i] = "10";
+        ops[i + 1] = "D";
+    }
+
+    ScoreStream *s = score_open();
+    if (!s) return EXIT_FAILURE;
+    volatile int observed = 0;
+    double start = nowMs();
+    for (int i = 0; i < MAX_OPERATIONS; i++) {
+        failed |= score_push(s, ops[i]) != 0;
+        observed = score_total(s);
+    }
+    double elapsed = nowMs() - start;
+    printf("Streaming: %.1f ns/push (with score_total after each), Result: %d\n",
+           elapsed * 1e6 / MAX_OPERATIONS, observed);
+    failed |= observed != 15000000;
+    score_close(s);
+
+    // The batch alternative: rerun calPoints on the prefix whenever the total is asked for
+    start = nowMs();
+    for (int i = QUERY_EVERY; i <= MAX_OPERATIONS; i += QUERY_EVERY) observed = calPoints(ops, i);
+    printf("Recompute prefix every %d ops: %.3f ms, Result: %d\n", QUERY_EVERY, nowMs() - start, observed);
+
+    // Random stream with many pops, checked against the batch evaluator
+    static char *pool[] = {"5", "-2", "C", "C", "D", "+", "10", "-7", "C", "x"};
+    static char *randomOps[RANDOM_OPS];
+    int checkpoints = 0;
+    srand(7);
+    s = score_open();
+    if (!s) return EXIT_FAILURE;
+    for (int i = 0; i < RANDOM_OPS; i++) {
+        // Long runs of pushes, then long runs of pops, to cross chunk boundaries both ways
+        int phase = (i / 20000) & 1;
+        randomOps[i] = phase && rand() % 3 ? "C" : pool[rand() % 10];
+        failed |= score_push(s, randomOps[i]) != 0;
+        if (i % CHECK_EVERY == 0 || i == RANDOM_OPS - 1) {
+            failed |= score_total(s) != calPoints(randomOps, i + 1);
+            checkpoints++;
+        }
+    }
+    printf("Random stream: %s (%d checkpoints)\n", failed ? "FAILED" : "OK", checkpoints);
+    score_close(s);
+
+    // A reader thread polling the total while the feed pushes
+    TotalReader reader = {score_open(), 0, 0, 0};
+    if (!reader.stream) return EXIT_FAILURE;
+    atomic_init(&reader.stop, 0);
+    pthread_t thread;
+    pthread_create(&thread, NULL, readTotals, &reader);
+    for (int i = 0; i < MAX_OPERATIONS; i++) failed |= score_push(reader.stream, ops[i]) != 0;
+    atomic_store_explicit(&reader.stop, 1, memory_order_release);
+    pthread_join(thread, NULL);
+    printf("Concurrent reader: %lld reads, last total %d\n", reader.reads, reader.last);
+    failed |= reader.last != 15000000;
+    score_close(reader.stream);
+
+    if (failed) {
+        fprintf(stderr, "Streaming totals do not match calPoints!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
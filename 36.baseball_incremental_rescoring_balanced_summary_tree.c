@@ -0,0 +1,812 @@
+/*
+ * Incremental Re-Scoring After Edits: a Balanced Tree of Composable Segment Summaries
+
+   Why Not Just Rerun calPoints?
+
+   Corrections arrive late: an op in the middle of a finished game is changed, inserted or
+   deleted, and today the whole game is scored again from op 0. For a 1M-op game that is a
+   full pass per correction, although one op changed.
+
+   Segment Summaries, With the Guards
+   ----------------------------------
+   13.baseball_parallel_segment_summary_full_stack_eval.c summarizes a chunk of ops against
+   a symbolic inherited stack: it pops `pops` inherited records and leaves records that are
+   linear in the two inherited records on top after the pops (c + a * x1 + b * x2). That
+   summary is exact only while the inherited stack is at least `need` records deep; below
+   that, the guards of 1.baseball_game.c (C and D on an empty stack, + on fewer than two
+   records) turn ops into no-ops, and file 13 falls back to replaying the chunk.
+
+   A tree cannot replay, so every node here describes its segment for EVERY inherited depth
+   d, with three regimes:
+
+   - OPEN   (d >= need): the summary of file 13, in x1 and x2.
+   - EMPTY  (d <= zeroReach): the stack runs empty somewhere in the segment (or is empty on
+            entry). From then on every such d evaluates exactly like d = 0, so the result is
+            one concrete list that does not depend on the inherited records at all.
+   - BAND   (zeroReach < d < need): the stack never empties, so the first guard to fire is a
+            "+" on a single record. That record can only be the bottom inherited record y, and
+            every d in the band leaves the same list [y, ...] with records linear in y.
+
+   Both EMPTY and BAND follow from one fact: the depth after every op is a non-decreasing
+   function of the depth before it. Two inputs whose stacks reach the same small state at
+   the same op evaluate identically from there on.
+
+   The Tree
+   --------
+   The leaves of an AVL tree are chunks of up to LEAF_OPS (64) consecutive ops, ordered by
+   position. A leaf summarizes its chunk the way file 13 summarizes a chunk, plus the EMPTY
+   and BAND regimes: it keeps only the ops and, per regime, the count and sum of its list.
+   Any single record is found again by replaying the chunk. An internal node stores its
+   three regimes as the composition of its children's. For each regime it keeps which
+   regime each child is in, how many records of the left child's list survive the right
+   child's pops (`keep`), the right child's inputs as forms in the node's own inputs, and the
+   sum of the list. The value or prefix sum of any record of a node's list is found by one
+   walk down the tree and one leaf replay, so composing a node costs O(log n + LEAF_OPS).
+
+   An edit rebuilds one leaf chunk and then the O(log(n / LEAF_OPS)) nodes on its path (plus
+   AVL rotations). A full leaf splits in two on insert, and two leaves that fit in half a
+   leaf merge on delete. The total is read from the root in O(1): the root always starts on
+   an empty stack.
+
+   Memory: each leaf holds 5 bytes per op (code and value) plus one node, and there is one
+   internal node per leaf. At 1M ops this is about 12 bytes per op, 3x the 4 MB records
+   array. One leaf per op would cost about 450 bytes per op.
+
+   All record arithmetic is unsigned, so it wraps exactly like the int records of file 1.
+
+   Input Explained
+   ---------------
+   - The seven test cases from 2.baseball_game_direct_update_sum_store_converted_values.c.
+   - RANDOM_GAMES random games of up to MAX_RANDOM_OPS ops (several leaves), full of guard
+     cases (C and D on empty stacks, + on one record), each edited RANDOM_EDITS times by
+     random replaces, inserts and deletes. After every edit the tree total is checked
+     against the file-1 evaluator.
+   - "10", "D" repeated 500,000 times, then NUM_EDITS random edits timed per edit and
+     compared with one full calPoints pass. The final game is read back from the tree and
+     checked against calPoints.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Random edits: OK ([n] edits checked against file 1)
+   Build 1000000 ops: [time_ms] ms, Result: 15000000
+   Tree memory: [n] bytes ([n] bytes/op, records: 4000000 bytes)
+   Tree edits: [us] us/edit over [n] edits
+   Full calPoints rerun: [us] us/edit
+   Edited game cross-check: OK (Result: [n])
+
+   gcc -O3 36.baseball_incremental_rescoring_balanced_summary_tree.c -o baseball_edit_tree
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), malloc(), free(), rand()
+#include <string.h>       // strcmp(), memmove()
+#include <ctype.h>        // isdigit()
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define RANDOM_GAMES 200
+#define RANDOM_EDITS 500
+#define MAX_RANDOM_OPS 400
+#define NUM_EDITS 100000
+#define LEAF_OPS 64                  // Ops per leaf chunk; a full leaf splits in two on insert
+#define LIST_SLOTS (2 * LEAF_OPS + 2)   // Longest list a leaf replay can hold (BAND: need - 1 + ops)
+
+enum { OP_NUM, OP_C, OP_D, OP_PLUS, OP_SKIP };
+enum { REGIME_OPEN, REGIME_BAND, REGIME_EMPTY, NUM_REGIMES };
+
+// c + a * u + b * v, where u, v are the regime's inputs (x1, x2 for OPEN, y for BAND)
+typedef struct {
+    unsigned c, a, b;
+} Form;
+
+typedef struct {
+    int count;              // Records in the list (BAND: including the bottom record y)
+    int keep;               // Leading records of the left child's list that survive
+    unsigned char left;     // Regime the left child is in
+    unsigned char right;    // Regime the right child is in
+    Form in1, in2;          // Inputs of the right child's regime, in this node's inputs
+    Form keptSum;           // Sum of the kept left records
+    Form sum;               // Sum of the whole list
+} Regime;
+
+// The ops of one leaf chunk
+typedef struct {
+    unsigned char codes[LEAF_OPS];
+    int values[LEAF_OPS];
+} LeafOps;
+
+typedef struct EditNode {
+    struct EditNode *left, *right;   // NULL for a leaf, which holds a chunk of ops
+    int size;               // Ops in the subtree (1 to LEAF_OPS in a leaf)
+    int height;             // 0 for a leaf
+    LeafOps *ops;           // Leaf ops, NULL for an internal node
+    int pops;               // OPEN: inherited records removed
+    int need;               // OPEN is exact for inherited depth >= need
+    int zeroReach;          // Largest inherited depth that empties the stack
+    Regime regime[NUM_REGIMES];
+} EditNode;
+
+typedef struct {
+    EditNode *root;
+} ScoreTree;
+
+static const Form formZero = {0, 0, 0};
+static const Form formU = {0, 1, 0};
+static const Form formV = {0, 0, 1};
+
+static inline Form formScale(Form p, unsigned k) {
+    return (Form){k * p.c, k * p.a, k * p.b};
+}
+
+static inline Form formAdd(Form p, Form q) {
+    return (Form){p.c + q.c, p.a + q.a, p.b + q.b};
+}
+
+// p with its inputs replaced by in1 and in2
+static inline Form formApply(Form p, Form in1, Form in2) {
+    return (Form){p.c + p.a * in1.c + p.b * in2.c,
+                  p.a * in1.a + p.b * in2.a,
+                  p.a * in1.b + p.b * in2.b};
+}
+
+static inline int decodeOp(const char *op, int *value) {
+    *value = 0;
+    if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) {
+        *value = atoi(op);
+        return OP_NUM;
+    }
+    if (strcmp(op, "C") == 0) return OP_C;
+    if (strcmp(op, "D") == 0) return OP_D;
+    if (strcmp(op, "+") == 0) return OP_PLUS;
+    return OP_SKIP;
+}
+
+static inline int regimeFor(const EditNode *n, int depth) {
+    if (depth >= n->need) return REGIME_OPEN;
+    if (depth <= n->zeroReach) return REGIME_EMPTY;
+    return REGIME_BAND;
+}
+
+// Depth after one op, with the guards of file 1.
+static inline int stepDepth(int code, int depth) {
+    switch (code) {
+    case OP_NUM:  return depth + 1;
+    case OP_C:    return depth > 0 ? depth - 1 : 0;
+    case OP_D:    return depth > 0 ? depth + 1 : 0;
+    case OP_PLUS: return depth > 1 ? depth + 1 : depth;
+    default:      return depth;
+    }
+}
+
+// Whether a leaf entered with `depth` inherited records empties the stack.
+static int leafEmpties(const EditNode *n, int depth) {
+    for (int i = 0; depth > 0 && i < n->size; i++) depth = stepDepth(n->ops->codes[i], depth);
+    return depth == 0;
+}
+
+// Replays a leaf in one regime and writes its list (bottom first). Returns the length.
+// OPEN follows file 13: while records of the chunk are on the stack nothing inherited is
+// popped, so every record is linear in the two inherited records on top after the pops.
+// EMPTY starts from an empty stack. BAND starts from need - 1 inherited records, of which
+// only the bottom one (y) can survive, so the others are left as zero.
+static int replayLeaf(const EditNode *n, int regime, Form *list) {
+    const LeafOps *ops = n->ops;
+    int count = 0;
+
+    if (regime == REGIME_OPEN) {
+        for (int i = 0; i < n->size; i++) {
+            switch (ops->codes[i]) {
+            case OP_NUM:
+                list[count++] = (Form){(unsigned)ops->values[i], 0, 0};
+                break;
+            case OP_C:
+                if (count > 0) count--;        // Else an inherited record goes
+                break;
+            case OP_D:
+                list[count] = formScale(count > 0 ? list[count - 1] : formU, 2);
+                count++;
+                break;
+            case OP_PLUS: {
+                Form top = count > 0 ? list[count - 1] : formU;
+                Form second = count > 1 ? list[count - 2] : count == 1 ? formU : formV;
+                list[count++] = formAdd(top, second);
+                break;
+            }
+            }
+        }
+        return count;
+    }
+
+    if (regime == REGIME_BAND) {
+        for (; count < n->need - 1; count++) list[count] = count == 0 ? formU : formZero;
+    }
+    for (int i = 0; i < n->size; i++) {
+        switch (ops->codes[i]) {
+        case OP_NUM:
+            list[count++] = (Form){(unsigned)ops->values[i], 0, 0};
+            break;
+        case OP_C:
+            if (count > 0) count--;
+            break;
+        case OP_D:
+            if (count > 0) {
+                list[count] = formScale(list[count - 1], 2);
+                count++;
+            }
+            break;
+        case OP_PLUS:
+            if (count > 1) {
+                list[count] = formAdd(list[count - 1], list[count - 2]);
+                count++;
+            }
+            break;
+        }
+    }
+    return count;
+}
+
+// Sets the regimes of a leaf from its ops.
+static void computeLeaf(EditNode *n) {
+    const LeafOps *ops = n->ops;
+    int local = 0, pops = 0, need = 0;
+
+    // Inherited records popped and read by the chunk
+    for (int i = 0; i < n->size; i++) {
+        switch (ops->codes[i]) {
+        case OP_NUM:
+            local++;
+            break;
+        case OP_C:
+            if (local > 0) local--;
+            else if (++pops > need) need = pops;
+            break;
+        case OP_D:
+            if (local == 0 && pops + 1 > need) need = pops + 1;
+            local++;
+            break;
+        case OP_PLUS:
+            if (local < 2 && pops + 2 - local > need) need = pops + 2 - local;
+            local++;
+            break;
+        }
+    }
+    n->pops = pops;
+    n->need = need;
+
+    // Largest inherited depth that empties the stack. The depth after every op is monotone
+    // in the depth before it, and k ops cannot empty more than k records.
+    int low = 0, high = n->size;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (leafEmpties(n, mid)) low = mid; else high = mid - 1;
+    }
+    n->zeroReach = low;
+
+    Form list[LIST_SLOTS];
+    memset(n->regime, 0, sizeof(n->regime));
+    for (int regime = 0; regime < NUM_REGIMES; regime++) {
+        if (regime == REGIME_BAND && n->zeroReach >= n->need - 1) continue;   // No band
+        Regime *r = &n->regime[regime];
+        r->count = replayLeaf(n, regime, list);
+        for (int j = 0; j < r->count; j++) r->sum = formAdd(r->sum, list[j]);
+    }
+}
+
+// Record j (from the bottom) of a node's list in the given regime.
+static Form elementAt(const EditNode *n, int regime, int j) {
+    if (!n->left) {
+        Form list[LIST_SLOTS];
+        replayLeaf(n, regime, list);
+        return list[j];
+    }
+    const Regime *r = &n->regime[regime];
+    if (j < r->keep) return elementAt(n->left, r->left, j);
+    return formApply(elementAt(n->right, r->right, j - r->keep), r->in1, r->in2);
+}
+
+// Sum of the first j records of a node's list in the given regime.
+static Form prefixSum(const EditNode *n, int regime, int j) {
+    if (!n->left) {
+        Form list[LIST_SLOTS], sum = formZero;
+        if (j == n->regime[regime].count) return n->regime[regime].sum;
+        replayLeaf(n, regime, list);
+        for (int k = 0; k < j; k++) sum = formAdd(sum, list[k]);
+        return sum;
+    }
+    const Regime *r = &n->regime[regime];
+    if (j <= r->keep) return prefixSum(n->left, r->left, j);
+    return formAdd(r->keptSum, formApply(prefixSum(n->right, r->right, j - r->keep), r->in1, r->in2));
+}
+
+// Composes one regime of n from its children; `depth` is a representative inherited depth
+// for BAND and EMPTY (OPEN is symbolic).
+static void composeRegime(EditNode *n, int regime, int depth) {
+    const EditNode *L = n->left, *R = n->right;
+    Regime *r = &n->regime[regime];
+    int regL = regime == REGIME_OPEN ? REGIME_OPEN : regimeFor(L, depth);
+    int kL = L->regime[regL].count;
+    int outL = regL == REGIME_OPEN ? depth - L->pops + kL : kL;
+    int regR = regime == REGIME_OPEN ? REGIME_OPEN : regimeFor(R, outL);
+    Form in1 = formZero, in2 = formZero;
+    int keep = 0;
+
+    if (regR == REGIME_OPEN) {
+        // x1, x2 of the right child: the left list after its pops, then (in an open node)
+        // the node's own inputs below it
+        Form below1 = regime == REGIME_OPEN ? formU : formZero;
+        Form below2 = regime == REGIME_OPEN ? formV : formZero;
+        keep = kL - R->pops > 0 ? kL - R->pops : 0;
+        in1 = keep >= 1 ? elementAt(L, regL, keep - 1) : below1;
+        in2 = keep >= 2 ? elementAt(L, regL, keep - 2) : keep == 1 ? below1 : below2;
+    } else if (regR == REGIME_BAND) {
+        // Everything above the bottom record goes. The bottom is y while inherited records
+        // remain under an open left child, else the first record of the left list.
+        in1 = regL == REGIME_OPEN && regime == REGIME_BAND ? formU : elementAt(L, regL, 0);
+    }
+
+    r->left = (unsigned char)regL;
+    r->right = (unsigned char)regR;
+    r->keep = keep;
+    r->in1 = in1;
+    r->in2 = in2;
+    r->count = keep + R->regime[regR].count;
+    r->keptSum = prefixSum(L, regL, keep);
+    r->sum = formAdd(r->keptSum, formApply(R->regime[regR].sum, in1, in2));
+}
+
+// Recomputes an internal node from its children.
+static void pull(EditNode *n) {
+    const EditNode *L = n->left, *R = n->right;
+    int kL = L->regime[REGIME_OPEN].count;
+
+    n->size = L->size + R->size;
+    n->height = 1 + (L->height > R->height ? L->height : R->height);
+    n->pops = L->pops + (R->pops > kL ? R->pops - kL : 0);
+    n->need = L->pops + R->need - kL > L->need ? L->pops + R->need - kL : L->need;
+
+    // The stack empties in n if it empties in L, or L leaves at most R->zeroReach records
+    int reach = L->zeroReach;
+    int openReach = R->zeroReach + L->pops - kL;               // L open: out = d - pops + kL
+    if (openReach >= L->need && openReach > reach) reach = openReach;
+    int leftBand = L->zeroReach < L->need - 1;                  // d in (zeroReach, need)
+    if (leftBand && L->regime[REGIME_BAND].count <= R->zeroReach && L->need - 1 > reach) reach = L->need - 1;
+    n->zeroReach = reach;
+
+    composeRegime(n, REGIME_OPEN, 0);
+    composeRegime(n, REGIME_EMPTY, 0);
+    int emptyTop = n->zeroReach < n->need - 1 ? n->zeroReach : n->need - 1;
+    if (emptyTop < n->need - 1) {
+        composeRegime(n, REGIME_BAND, n->need - 1);
+    } else {
+        memset(&n->regime[REGIME_BAND], 0, sizeof(Regime));
+    }
+}
+
+// A leaf with room for LEAF_OPS ops and no ops yet.
+static EditNode *allocLeaf(void) {
+    EditNode *n = calloc(1, sizeof(EditNode));
+    if (n) n->ops = malloc(sizeof(LeafOps));
+    if (n && !n->ops) {
+        free(n);
+        return NULL;
+    }
+    return n;
+}
+
+static void freeNode(EditNode *n) {
+    free(n->ops);
+    free(n);
+}
+
+static EditNode *newInternal(EditNode *left, EditNode *right) {
+    EditNode *n = malloc(sizeof(EditNode));
+    if (!n) return NULL;
+    n->ops = NULL;
+    n->left = left;
+    n->right = right;
+    pull(n);
+    return n;
+}
+
+static EditNode *rotateRight(EditNode *n) {
+    EditNode *l = n->left;
+    n->left = l->right;
+    pull(n);
+    l->right = n;
+    pull(l);
+    return l;
+}
+
+static EditNode *rotateLeft(EditNode *n) {
+    EditNode *r = n->right;
+    n->right = r->left;
+    pull(n);
+    r->left = n;
+    pull(r);
+    return r;
+}
+
+static EditNode *rebalance(EditNode *n) {
+    int balance = n->left->height - n->right->height;
+    if (balance > 1) {
+        if (n->left->left->height < n->left->right->height) n->left = rotateLeft(n->left);
+        return rotateRight(n);
+    }
+    if (balance < -1) {
+        if (n->right->right->height < n->right->left->height) n->right = rotateRight(n->right);
+        return rotateLeft(n);
+    }
+    pull(n);
+    return n;
+}
+
+static void freeNodes(EditNode *n) {
+    if (!n) return;
+    freeNodes(n->left);
+    freeNodes(n->right);
+    freeNode(n);
+}
+
+// Leaves are filled to LEAF_OPS, and each side gets half of them.
+static EditNode *buildRange(const int *codes, const int *values, int lo, int hi) {
+    if (hi - lo <= LEAF_OPS) {
+        EditNode *n = allocLeaf();
+        if (!n) return NULL;
+        n->size = hi - lo;
+        for (int i = lo; i < hi; i++) {
+            n->ops->codes[i - lo] = (unsigned char)codes[i];
+            n->ops->values[i - lo] = values[i];
+        }
+        computeLeaf(n);
+        return n;
+    }
+    int leaves = (hi - lo + LEAF_OPS - 1) / LEAF_OPS;
+    int mid = lo + leaves / 2 * LEAF_OPS;
+    EditNode *left = buildRange(codes, values, lo, mid);
+    EditNode *right = left ? buildRange(codes, values, mid, hi) : NULL;
+    EditNode *n = right ? newInternal(left, right) : NULL;
+    if (!n) {
+        freeNodes(left);
+        freeNodes(right);
+    }
+    return n;
+}
+
+// Puts an op at position pos of a leaf that has room for it.
+static void leafInsert(EditNode *n, int pos, int code, int value) {
+    LeafOps *ops = n->ops;
+    memmove(&ops->codes[pos + 1], &ops->codes[pos], n->size - pos);
+    memmove(&ops->values[pos + 1], &ops->values[pos], (n->size - pos) * sizeof(int));
+    ops->codes[pos] = (unsigned char)code;
+    ops->values[pos] = value;
+    n->size++;
+}
+
+// Returns the new subtree, or NULL if out of memory (the subtree is then unchanged).
+static EditNode *insertAt(EditNode *n, int pos, int code, int value) {
+    if (!n->left) {
+        if (n->size < LEAF_OPS) {
+            leafInsert(n, pos, code, value);
+            computeLeaf(n);
+            return n;
+        }
+
+        // A full leaf splits into two halves under a new internal node
+        EditNode *right = allocLeaf();
+        EditNode *parent = right ? malloc(sizeof(EditNode)) : NULL;
+        if (!parent) {
+            if (right) freeNode(right);
+            return NULL;
+        }
+        int half = LEAF_OPS / 2;
+        right->size = n->size - half;
+        memcpy(right->ops->codes, &n->ops->codes[half], right->size);
+        memcpy(right->ops->values, &n->ops->values[half], right->size * sizeof(int));
+        n->size = half;
+        if (pos <= half) leafInsert(n, pos, code, value);
+        else leafInsert(right, pos - half, code, value);
+        computeLeaf(n);
+        computeLeaf(right);
+        parent->ops = NULL;
+        parent->left = n;
+        parent->right = right;
+        pull(parent);
+        return parent;
+    }
+    if (pos <= n->left->size) {
+        EditNode *child = insertAt(n->left, pos, code, value);
+        if (!child) return NULL;
+        n->left = child;
+    } else {
+        EditNode *child = insertAt(n->right, pos - n->left->size, code, value);
+        if (!child) return NULL;
+        n->right = child;
+    }
+    return rebalance(n);
+}
+
+// Returns the new subtree, or NULL if it lost its last op.
+static EditNode *eraseAt(EditNode *n, int pos) {
+    if (!n->left) {
+        if (n->size == 1) {
+            freeNode(n);
+            return NULL;
+        }
+        LeafOps *ops = n->ops;
+        memmove(&ops->codes[pos], &ops->codes[pos + 1], n->size - pos - 1);
+        memmove(&ops->values[pos], &ops->values[pos + 1], (n->size - pos - 1) * sizeof(int));
+        n->size--;
+        computeLeaf(n);
+        return n;
+    }
+    if (pos < n->left->size) {
+        n->left = eraseAt(n->left, pos);
+        if (!n->left) {
+            EditNode *right = n->right;
+            free(n);
+            return right;
+        }
+    } else {
+        n->right = eraseAt(n->right, pos - n->left->size);
+        if (!n->right) {
+            EditNode *left = n->left;
+            free(n);
+            return left;
+        }
+    }
+
+    // Two leaves that fit in half a leaf merge, so deletes do not leave many tiny leaves
+    EditNode *L = n->left, *R = n->right;
+    if (!L->left && !R->left && L->size + R->size <= LEAF_OPS / 2) {
+        memcpy(&L->ops->codes[L->size], R->ops->codes, R->size);
+        memcpy(&L->ops->values[L->size], R->ops->values, R->size * sizeof(int));
+        L->size += R->size;
+        computeLeaf(L);
+        freeNode(R);
+        free(n);
+        return L;
+    }
+    return rebalance(n);
+}
+
+static void replaceAt(EditNode *n, int pos, int code, int value) {
+    if (!n->left) {
+        n->ops->codes[pos] = (unsigned char)code;
+        n->ops->values[pos] = value;
+        computeLeaf(n);
+        return;
+    }
+    if (pos < n->left->size) replaceAt(n->left, pos, code, value);
+    else replaceAt(n->right, pos - n->left->size, code, value);
+    pull(n);
+}
+
+// Bytes held by the nodes and leaf chunks of a subtree.
+static size_t nodeBytes(const EditNode *n) {
+    if (!n) return 0;
+    return sizeof(EditNode) + (n->ops ? sizeof(LeafOps) : 0) + nodeBytes(n->left) + nodeBytes(n->right);
+}
+
+// Builds the tree of a whole game. Returns 0, or -1 if out of memory.
+int scoreTreeBuild(ScoreTree *t, char *ops[], int size) {
+    t->root = NULL;
+    if (size == 0) return 0;
+
+    int *codes = malloc(size * sizeof(int));
+    int *values = malloc(size * sizeof(int));
+    if (codes && values) {
+        for (int i = 0; i < size; i++) codes[i] = decodeOp(ops[i], &values[i]);
+        t->root = buildRange(codes, values, 0, size);
+    }
+    free(codes);
+    free(values);
+    return t->root ? 0 : -1;
+}
+
+// Total of the game as it stands. The root always starts on an empty stack.
+int scoreTreeTotal(const ScoreTree *t) {
+    if (!t->root) return 0;
+    return (int)t->root->regime[regimeFor(t->root, 0)].sum.c;
+}
+
+int scoreTreeSize(const ScoreTree *t) {
+    return t->root ? t->root->size : 0;
+}
+
+size_t scoreTreeBytes(const ScoreTree *t) {
+    return nodeBytes(t->root);
+}
+
+// Replaces op pos (0 <= pos < size).
+void scoreTreeReplace(ScoreTree *t, int pos, const char *op) {
+    int value, code = decodeOp(op, &value);
+    replaceAt(t->root, pos, code, value);
+}
+
+// Inserts op before position pos (0 <= pos <= size). Returns 0, or -1 if out of memory.
+int scoreTreeInsert(ScoreTree *t, int pos, const char *op) {
+    int value, code = decodeOp(op, &value);
+    if (!t->root) {
+        EditNode *leaf = allocLeaf();
+        if (!leaf) return -1;
+        leafInsert(leaf, 0, code, value);
+        computeLeaf(leaf);
+        t->root = leaf;
+        return 0;
+    }
+    EditNode *root = insertAt(t->root, pos, code, value);
+    if (!root) return -1;
+    t->root = root;
+    return 0;
+}
+
+// Deletes op pos (0 <= pos < size).
+void scoreTreeErase(ScoreTree *t, int pos) {
+    t->root = eraseAt(t->root, pos);
+}
+
+void scoreTreeDestroy(ScoreTree *t) {
+    freeNodes(t->root);
+    t->root = NULL;
+}
+
+// Reference evaluator (same rules as 1.baseball_game.c).
+int calPoints(char *ops[], int size) {
+    static int records[MAX_OPERATIONS + NUM_EDITS];
+    int index = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index++] = atoi(ops[i]);
+        } else if (strcmp(ops[i], "C") == 0) {
+            if (index > 0) index--;
+        } else if (strcmp(ops[i], "D") == 0) {
+            if (index > 0) {
+                records[index] = (int)(2u * (unsigned)records[index - 1]);
+                index++;
+            }
+        } else if (strcmp(ops[i], "+") == 0) {
+            if (index > 1) {
+                records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+                index++;
+            }
+        }
+    }
+
+    unsigned result = 0;
+    for (int i = 0; i < index; i++) result += (unsigned)records[i];
+    return (int)result;
+}
+
+// In-order op strings of the tree (for the final cross-check).
+static char *opNames[] = {"0", "C", "D", "+", "x"};
+static char numberText[NUM_EDITS + MAX_OPERATIONS][12];
+
+static int collectOps(const EditNode *n, char **out, int at) {
+    if (!n) return at;
+    if (n->left) return collectOps(n->right, out, collectOps(n->left, out, at));
+    for (int i = 0; i < n->size; i++, at++) {
+        if (n->ops->codes[i] == OP_NUM) {
+            snprintf(numberText[at], sizeof(numberText[at]), "%d", n->ops->values[i]);
+            out[at] = numberText[at];
+        } else {
+            out[at] = opNames[n->ops->codes[i]];
+        }
+    }
+    return at;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    int failed = 0;
+    ScoreTree tree;
+
+    // Test cases
+    char *testCases[][10] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int testSizes[] = {5, 8, 1, 1, 2, 5, 6};
+    for (int t = 0; t < 7; t++) {
+        if (scoreTreeBuild(&tree, testCases[t], testSizes[t]) != 0) return EXIT_FAILURE;
+        printf("Test %d: %d\n", t + 1, scoreTreeTotal(&tree));
+        failed |= scoreTreeTotal(&tree) != calPoints(testCases[t], testSizes[t]);
+        scoreTreeDestroy(&tree);
+    }
+
+    // Random games full of guard cases, edited at random positions
+    static char *pool[] = {"5", "-3", "7", "0", "C", "C", "D", "+", "+", "x"};
+    static char *game[MAX_RANDOM_OPS + 1];
+    int checked = 0;
+    srand(11);
+    for (int g = 0; g < RANDOM_GAMES && !failed; g++) {
+        int size = rand() % MAX_RANDOM_OPS;
+        for (int i = 0; i < size; i++) game[i] = pool[rand() % 10];
+        if (scoreTreeBuild(&tree, game, size) != 0) return EXIT_FAILURE;
+
+        for (int e = 0; e < RANDOM_EDITS; e++) {
+            int kind = rand() % 3;
+            char *op = pool[rand() % 10];
+            if (kind == 0 && size > 0) {
+                int pos = rand() % size;
+                game[pos] = op;
+                scoreTreeReplace(&tree, pos, op);
+            } else if ((kind == 1 || size == 0) && size < MAX_RANDOM_OPS) {
+                int pos = rand() % (size + 1);
+                memmove(&game[pos + 1], &game[pos], (size - pos) * sizeof(char *));
+                game[pos] = op;
+                size++;
+                if (scoreTreeInsert(&tree, pos, op) != 0) return EXIT_FAILURE;
+            } else if (size > 0) {
+                int pos = rand() % size;
+                memmove(&game[pos], &game[pos + 1], (size - pos - 1) * sizeof(char *));
+                size--;
+                scoreTreeErase(&tree, pos);
+            }
+            checked++;
+            if (scoreTreeTotal(&tree) != calPoints(game, size) || scoreTreeSize(&tree) != size) {
+                fprintf(stderr, "Game %d, edit %d: tree %d, calPoints %d\n", g, e,
+                        scoreTreeTotal(&tree), calPoints(game, size));
+                failed = 1;
+                break;
+            }
+        }
+        scoreTreeDestroy(&tree);
+    }
+    printf("Random edits: %s (%d edits checked against file 1)\n", failed ? "FAILED" : "OK", checked);
+
+    // Large game
+    static char *ops[MAX_OPERATIONS + NUM_EDITS];
+    for (int i = 0; i < MAX_OPERATIONS; i += 2) {
+        ops[i] = "10";
+        ops[i + 1] = "D";
+    }
+
+    double start = nowMs();
+    if (scoreTreeBuild(&tree, ops, MAX_OPERATIONS) != 0) {
+        fprintf(stderr, "Could not build the tree\n");
+        return EXIT_FAILURE;
+    }
+    printf("Build %d ops: %.3f ms, Result: %d\n", MAX_OPERATIONS, nowMs() - start, scoreTreeTotal(&tree));
+    printf("Tree memory: %zu bytes (%.1f bytes/op, records: %zu bytes)\n", scoreTreeBytes(&tree),
+           (double)scoreTreeBytes(&tree) / MAX_OPERATIONS, MAX_OPERATIONS * sizeof(int));
+    failed |= scoreTreeTotal(&tree) != 15000000;
+
+    volatile int observed = 0;
+    start = nowMs();
+    for (int e = 0; e < NUM_EDITS; e++) {
+        int kind = rand() % 3, size = scoreTreeSize(&tree);
+        char *op = pool[rand() % 10];
+        if (kind == 0) scoreTreeReplace(&tree, rand() % size, op);
+        else if (kind == 1) failed |= scoreTreeInsert(&tree, rand() % (size + 1), op) != 0;
+        else scoreTreeErase(&tree, rand() % size);
+        observed = scoreTreeTotal(&tree);
+    }
+    printf("Tree edits: %.3f us/edit over %d edits\n", (nowMs() - start) * 1000.0 / NUM_EDITS, NUM_EDITS);
+
+    int size = collectOps(tree.root, ops, 0);
+    start = nowMs();
+    int expected = calPoints(ops, size);
+    printf("Full calPoints rerun: %.3f us/edit\n", (nowMs() - start) * 1000.0);
+    failed |= observed != expected;
+    printf("Edited game cross-check: %s (Result: %d)\n", observed == expected ? "OK" : "FAILED", observed);
+    scoreTreeDestroy(&tree);
+
+    if (failed) {
+        fprintf(stderr, "Tree totals do not match the reference evaluator!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,458 @@
+/*
+ * Time-Travel Prefix Queries: the Total After Any Op k From Sparse Checkpoints and a C Log
+
+   Why an Index?
+
+   Analysts ask for "the score after op k" for many k. Today each answer is another
+   calPoints run on the first k ops, O(k) per question. Storing the running total after every
+   op answers in O(1) but costs 4 bytes per op, as much again as `records`. This index is
+   built during the same single evaluation pass and stays far smaller.
+
+   What the Pass Keeps
+   -------------------
+   - records:      the final records, as in file 2 (the baseline memory).
+   - checkpoints:  every CHECKPOINT_OPS ops, the running sum, the stack depth and the
+                   byte offset into the C log (12 bytes per checkpoint).
+   - C log:        the value removed by every C that pops a record (the undo log: it is exactly
+                   what a C takes away from the total), as zigzag varints like the op stream
+                   of file 16. Scores are small, so most entries take one byte. Queries only
+                   read the log forward from a checkpoint, so it needs no random access.
+   - depth tree:   the lowest depth reached in each checkpoint block, in a min-tree over the
+                   blocks (about 8 bytes per block).
+
+   Answering prefixTotal(k)
+   ------------------------
+   Start at the checkpoint at or before k and replay at most CHECKPOINT_OPS ops:
+   - a number adds itself; a C subtracts its logged value (no stack needed);
+   - D and + need the top records. Records pushed inside the window are known. A record q
+     from below the window is still live, so its value is whatever eventually removes it:
+     either the first C after now that takes the stack down to q (found with the depth tree
+     plus a depth-only scan of one block, which needs no values) or, if nothing ever does,
+     records[q] at the end.
+   So a query costs O(CHECKPOINT_OPS + log n) plus one search per distinct record read from
+   below the window. The extra memory is about 0.3 bytes per op plus 1 to 5 bytes per
+   effective C: 8% of records for the "10","D" input (no C's) and about 15% for the random
+   stream below, where about a quarter of the ops are C's.
+
+   Input Explained
+   ---------------
+   - The seven test cases from 2.baseball_game_direct_update_sum_store_converted_values.c,
+     with every prefix total of test 2.
+   - "10", "D" repeated 500,000 times: build time against a plain calPoints pass, then
+     NUM_QUERIES random prefix queries against calPoints on the truncated input.
+   - RANDOM_OPS random ops with C's and guard cases. EVERY prefix total is checked against
+     the running sum of file 2 recorded after each op.
+
+   Expected Output
+   ---------------
+   Test 1: 30 ... Test 7: 60
+   Test 2 prefixes: 0 5 3 7 3 -1 8 13 27
+   calPoints pass: [time_ms] ms, index build: [time_ms] ms, Result: 15000000
+   Index memory: [n] bytes ([pct]% of records)
+   Prefix queries: [ns] ns/query, rerun calPoints: [us] us/query
+   Random stream: OK ([n] prefixes, index [pct]% of records)
+
+   gcc -O3 37.baseball_prefix_total_checkpoints_undo_log.c -o baseball_prefix
+*/
+
+#include <stdio.h>        // printf()
+#include <stdlib.h>       // atoi(), malloc(), realloc(), free(), rand()
+#include <stdint.h>       // uint8_t, uint32_t
+#include <string.h>       // strcmp()
+#include <ctype.h>        // isdigit()
+#include <limits.h>       // INT_MAX
+#include <time.h>         // clock_gettime()
+
+#define MAX_OPERATIONS 1000000
+#define CHECKPOINT_OPS 64            // Ops between checkpoints (longest replay of a query)
+#define WINDOW_SLOTS (2 * CHECKPOINT_OPS + 4)
+#define NUM_QUERIES 1000000
+#define RERUN_QUERIES 50
+#define RANDOM_OPS 1000000
+#define MAX_VARINT_BYTES 5           // zigzag(int) needs at most 32 bits
+
+enum { OP_NUM, OP_C, OP_D, OP_PLUS, OP_SKIP };
+
+typedef struct {
+    char **ops;            // The evaluated ops (borrowed)
+    int size;
+    int *records;          // Final records
+    int index;             // Final number of records
+
+    int numBlocks;         // Checkpoint b is the state before op b * CHECKPOINT_OPS
+    unsigned *cpSum;       // numBlocks + 1 entries
+    int *cpDepth;
+    int *cpLog;            // C log bytes before the checkpoint
+
+    uint8_t *cLog;         // Value removed by each effective C, in op order (zigzag varints)
+    int cLogBytes;
+
+    int treeBase;          // Leaves of the depth min-tree (power of two >= numBlocks)
+    int *minTree;          // minTree[treeBase + b]: lowest depth after any op of block b
+} PrefixIndex;
+
+static inline int opKind(const char *op) {
+    if (isdigit(op[0]) || (op[0] == '-' && isdigit(op[1]))) return OP_NUM;
+    if (strcmp(op, "C") == 0) return OP_C;
+    if (strcmp(op, "D") == 0) return OP_D;
+    if (strcmp(op, "+") == 0) return OP_PLUS;
+    return OP_SKIP;
+}
+
+static inline uint32_t zigzagEncode(int x) {
+    return ((uint32_t)x << 1) ^ (uint32_t)(x >> 31);
+}
+
+static inline int zigzagDecode(uint32_t z) {
+    return (int)((z >> 1) ^ (0u - (z & 1)));
+}
+
+// Next C log entry; advances the cursor.
+static inline int readLog(const uint8_t **cursor) {
+    const uint8_t *p = *cursor;
+    uint32_t v = *p & 0x7F;
+    for (int shift = 7; *p++ & 0x80; shift += 7) v |= (uint32_t)(*p & 0x7F) << shift;
+    *cursor = p;
+    return zigzagDecode(v);
+}
+
+// Depth after one op, with the guards of file 1.
+static inline int stepDepth(int kind, int depth) {
+    switch (kind) {
+    case OP_NUM:  return depth + 1;
+    case OP_C:    return depth > 0 ? depth - 1 : 0;
+    case OP_D:    return depth > 0 ? depth + 1 : 0;
+    case OP_PLUS: return depth > 1 ? depth + 1 : depth;
+    default:      return depth;
+    }
+}
+
+void prefixIndexDestroy(PrefixIndex *px) {
+    free(px->records);
+    free(px->cpSum);
+    free(px->cpDepth);
+    free(px->cpLog);
+    free(px->cLog);
+    free(px->minTree);
+    px->records = px->cpDepth = px->cpLog = px->minTree = NULL;
+    px->cpSum = NULL;
+    px->cLog = NULL;
+}
+
+// One evaluation pass (file 2's running-sum loop) that also records the index.
+// Returns 0, or -1 if out of memory.
+int prefixIndexBuild(PrefixIndex *px, char *ops[], int size) {
+    int blocks = (size + CHECKPOINT_OPS - 1) / CHECKPOINT_OPS;
+    int base = 1;
+    while (base < blocks) base *= 2;
+
+    px->ops = ops;
+    px->size = size;
+    px->numBlocks = blocks;
+    px->treeBase = base;
+    px->records = malloc((size + 1) * sizeof(int));
+    px->cpSum = malloc((blocks + 1) * sizeof(unsigned));
+    px->cpDepth = malloc((blocks + 1) * sizeof(int));
+    px->cpLog = malloc((blocks + 1) * sizeof(int));
+    px->minTree = malloc(2 * base * sizeof(int));
+    px->cLog = NULL;
+    px->cLogBytes = 0;
+    if (!px->records || !px->cpSum || !px->cpDepth || !px->cpLog || !px->minTree) {
+        prefixIndexDestroy(px);
+        return -1;
+    }
+
+    // The C log grows like a vector; most inputs have few C's
+    int logCapacity = 1024;
+    px->cLog = malloc(logCapacity);
+    if (!px->cLog) {
+        prefixIndexDestroy(px);
+        return -1;
+    }
+
+    int *records = px->records;
+    int index = 0;
+    unsigned sum = 0;
+    for (int k = 0; k < 2 * base; k++) px->minTree[k] = INT_MAX;
+
+    for (int i = 0; i < size; i++) {
+        if (i % CHECKPOINT_OPS == 0) {
+            int b = i / CHECKPOINT_OPS;
+            px->cpSum[b] = sum;
+            px->cpDepth[b] = index;
+            px->cpLog[b] = px->cLogBytes;
+        }
+
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index] = atoi(ops[i]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            if (px->cLogBytes + MAX_VARINT_BYTES > logCapacity) {
+                uint8_t *grown = realloc(px->cLog, 2 * logCapacity);
+                if (!grown) {
+                    prefixIndexDestroy(px);
+                    return -1;
+                }
+                px->cLog = grown;
+                logCapacity *= 2;
+            }
+            sum -= (unsigned)records[--index];
+            uint32_t v = zigzagEncode(records[index]);
+            while (v >= 0x80) {
+                px->cLog[px->cLogBytes++] = (uint8_t)(v | 0x80);
+                v >>= 7;
+            }
+            px->cLog[px->cLogBytes++] = (uint8_t)v;
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            sum += (unsigned)records[index++];
+        }
+
+        int *low = &px->minTree[base + i / CHECKPOINT_OPS];
+        if (index < *low) *low = index;
+    }
+    px->cpSum[blocks] = sum;
+    px->cpDepth[blocks] = index;
+    px->cpLog[blocks] = px->cLogBytes;
+    px->index = index;
+
+    for (int k = base - 1; k >= 1; k--) {
+        px->minTree[k] = px->minTree[2 * k] < px->minTree[2 * k + 1] ? px->minTree[2 * k] : px->minTree[2 * k + 1];
+    }
+    return 0;
+}
+
+// First block >= from whose lowest depth is <= q, or -1.
+static int firstBlockAtMost(const PrefixIndex *px, int node, int lo, int hi, int from, int q) {
+    if (hi <= from || px->minTree[node] > q) return -1;
+    if (hi - lo == 1) return lo;
+    int mid = (lo + hi) / 2;
+    int found = firstBlockAtMost(px, 2 * node, lo, mid, from, q);
+    return found >= 0 ? found : firstBlockAtMost(px, 2 * node + 1, mid, hi, from, q);
+}
+
+// Scans ops [i, end) by depth only, reading the C log from `cursor`. Stores the value of the
+// first C that takes the stack down to q and returns 1, or returns 0 if the depth stays above q.
+static int scanForDrop(const PrefixIndex *px, int i, int end, int depth, const uint8_t *cursor,
+                       int q, int *removed) {
+    for (; i < end; i++) {
+        int kind = opKind(px->ops[i]);
+        if (kind == OP_C && depth > 0) {
+            int value = readLog(&cursor);
+            if (depth - 1 <= q) {
+                *removed = value;
+                return 1;
+            }
+        }
+        depth = stepDepth(kind, depth);
+    }
+    return 0;
+}
+
+// Value of record q, live before op i (at depth `depth`, C log at `cursor`).
+static int liveRecord(const PrefixIndex *px, int i, int depth, const uint8_t *cursor, int q) {
+    int blockEnd = (i / CHECKPOINT_OPS + 1) * CHECKPOINT_OPS;
+    if (blockEnd > px->size) blockEnd = px->size;
+
+    int removed = 0;
+    if (scanForDrop(px, i, blockEnd, depth, cursor, q, &removed)) return removed;
+
+    int b = firstBlockAtMost(px, 1, 0, px->treeBase, i / CHECKPOINT_OPS + 1, q);
+    if (b < 0 || b >= px->numBlocks) return px->records[q];   // Never removed
+    int end = (b + 1) * CHECKPOINT_OPS < px->size ? (b + 1) * CHECKPOINT_OPS : px->size;
+    scanForDrop(px, b * CHECKPOINT_OPS, end, px->cpDepth[b], px->cLog + px->cpLog[b], q, &removed);
+    return removed;
+}
+
+// Total of the records after the first k ops (0 <= k <= size).
+int prefixTotal(const PrefixIndex *px, int k) {
+    int b = k / CHECKPOINT_OPS;
+    unsigned sum = px->cpSum[b];
+    int depth = px->cpDepth[b];
+    const uint8_t *cursor = px->cLog + px->cpLog[b];
+
+    // Records touched in the window: slot q - low, for q in [low, low + WINDOW_SLOTS)
+    int low = depth - CHECKPOINT_OPS - 2;
+    int value[WINDOW_SLOTS];
+    unsigned char known[WINDOW_SLOTS] = {0};
+
+    for (int i = b * CHECKPOINT_OPS; i < k; i++) {
+        const char *op = px->ops[i];
+        int kind = opKind(op);
+
+        if (kind == OP_C) {
+            if (depth > 0) {
+                sum -= (unsigned)readLog(&cursor);
+                depth--;
+            }
+            continue;
+        }
+        if ((kind == OP_D && depth < 1) || (kind == OP_PLUS && depth < 2) || kind == OP_SKIP) continue;
+
+        int pushed;
+        if (kind == OP_NUM) {
+            pushed = atoi(op);
+        } else {
+            int top[2];
+            for (int r = 0; r < (kind == OP_PLUS ? 2 : 1); r++) {
+                int q = depth - 1 - r, slot = q - low;
+                if (!known[slot]) {
+                    value[slot] = liveRecord(px, i, depth, cursor, q);
+                    known[slot] = 1;
+                }
+                top[r] = value[slot];
+            }
+            pushed = kind == OP_D ? (int)(2u * (unsigned)top[0]) : (int)((unsigned)top[0] + (unsigned)top[1]);
+        }
+        value[depth - low] = pushed;
+        known[depth - low] = 1;
+        depth++;
+        sum += (unsigned)pushed;
+    }
+    return (int)sum;
+}
+
+// Bytes of the index on top of records.
+long prefixIndexBytes(const PrefixIndex *px) {
+    return (long)(px->numBlocks + 1) * (sizeof(unsigned) + 2 * sizeof(int)) +
+           (long)px->cLogBytes + 2L * px->treeBase * sizeof(int);
+}
+
+// File 2's calPoints.
+int calPoints(char *ops[], int size) {
+    static int records[MAX_OPERATIONS];
+    int index = 0;
+    unsigned sum = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (isdigit(ops[i][0]) || (ops[i][0] == '-' && isdigit(ops[i][1]))) {
+            records[index] = atoi(ops[i]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(ops[i], "C") == 0 && index > 0) {
+            sum -= (unsigned)records[--index];
+        } else if (strcmp(ops[i], "D") == 0 && index > 0) {
+            records[index] = (int)(2u * (unsigned)records[index - 1]);
+            sum += (unsigned)records[index++];
+        } else if (strcmp(ops[i], "+") == 0 && index > 1) {
+            records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]);
+            sum += (unsigned)records[index++];
+        }
+    }
+    return (int)sum;
+}
+
+// Wall-clock time in milliseconds
+double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main() {
+    int failed = 0;
+    PrefixIndex px;
+
+    // Test cases
+    char *testCases[][10] = {
+        {"5", "2", "C", "D", "+"},
+        {"5", "-2", "4", "C", "D", "9", "+", "+"},
+        {"1"},
+        {"0"},
+        {"10", "C"},
+        {"-10", "D", "D", "C", "+"},
+        {"5", "10", "+", "D", "+", "C"}
+    };
+    int testSizes[] = {5, 8, 1, 1, 2, 5, 6};
+    for (int t = 0; t < 7; t++) {
+        if (prefixIndexBuild(&px, testCases[t], testSizes[t]) != 0) return EXIT_FAILURE;
+        printf("Test %d: %d\n", t + 1, prefixTotal(&px, testSizes[t]));
+        for (int k = 0; k <= testSizes[t]; k++) failed |= prefixTotal(&px, k) != calPoints(testCases[t], k);
+        if (t == 1) {
+            printf("Test 2 prefixes:");
+            for (int k = 0; k <= testSizes[t]; k++) printf(" %d", prefixTotal(&px, k));
+            printf("\n");
+        }
+        prefixIndexDestroy(&px);
+    }
+
+    // Large input
+    static char *ops[MAX_OPERATIONS];
+    for (int i = 0; i < MAX_OPERATIONS; i += 2) {
+        ops[i] = "10";
+        ops[i + 1] = "D";
+    }
+
+    double start = nowMs();
+    int result = calPoints(ops, MAX_OPERATIONS);
+    double passMs = nowMs() - start;
+    start = nowMs();
+    if (prefixIndexBuild(&px, ops, MAX_OPERATIONS) != 0) {
+        fprintf(stderr, "Could not build the index\n");
+        return EXIT_FAILURE;
+    }
+    printf("calPoints pass: %.3f ms, index build: %.3f ms, Result: %d\n",
+           passMs, nowMs() - start, prefixTotal(&px, MAX_OPERATIONS));
+    failed |= prefixTotal(&px, MAX_OPERATIONS) != result;
+    printf("Index memory: %ld bytes (%.1f%% of records)\n", prefixIndexBytes(&px),
+           100.0 * prefixIndexBytes(&px) / (MAX_OPERATIONS * sizeof(int)));
+
+    static int queries[NUM_QUERIES];
+    srand(5);
+    for (int q = 0; q < NUM_QUERIES; q++) queries[q] = rand() % (MAX_OPERATIONS + 1);
+    unsigned checksum = 0;
+    start = nowMs();
+    for (int q = 0; q < NUM_QUERIES; q++) checksum += (unsigned)prefixTotal(&px, queries[q]);
+    double queryNs = (nowMs() - start) * 1e6 / NUM_QUERIES;
+
+    unsigned rerunChecksum = 0, indexChecksum = 0;
+    start = nowMs();
+    for (int q = 0; q < RERUN_QUERIES; q++) rerunChecksum += (unsigned)calPoints(ops, queries[q]);
+    double rerunUs = (nowMs() - start) * 1000.0 / RERUN_QUERIES;
+    for (int q = 0; q < RERUN_QUERIES; q++) indexChecksum += (unsigned)prefixTotal(&px, queries[q]);
+    failed |= rerunChecksum != indexChecksum;
+    printf("Prefix queries: %.1f ns/query, rerun calPoints: %.1f us/query (checksum %u)\n",
+           queryNs, rerunUs, checksum);
+    prefixIndexDestroy(&px);
+
+    // Random stream: every prefix against file 2's running sum
+    static char *pool[] = {"5", "-2", "C", "D", "+", "7", "3", "+", "D", "x", "C", "12"};
+    static int running[RANDOM_OPS + 1];
+    for (int i = 0; i < RANDOM_OPS; i++) {
+        // Stretches with extra C's empty the stack now and then
+        int drain = (i / 5000) % 4 == 3;
+        ops[i] = drain && rand() % 2 ? "C" : pool[rand() % 12];
+    }
+    {
+        static int records[RANDOM_OPS];
+        int index = 0;
+        unsigned sum = 0;
+        running[0] = 0;
+        for (int i = 0; i < RANDOM_OPS; i++) {
+            int kind = opKind(ops[i]);
+            if (kind == OP_NUM) { records[index] = atoi(ops[i]); sum += (unsigned)records[index++]; }
+            else if (kind == OP_C && index > 0) sum -= (unsigned)records[--index];
+            else if (kind == OP_D && index > 0) { records[index] = (int)(2u * (unsigned)records[index - 1]); sum += (unsigned)records[index++]; }
+            else if (kind == OP_PLUS && index > 1) { records[index] = (int)((unsigned)records[index - 1] + (unsigned)records[index - 2]); sum += (unsigned)records[index++]; }
+            running[i + 1] = (int)sum;
+        }
+    }
+    if (prefixIndexBuild(&px, ops, RANDOM_OPS) != 0) {
+        fprintf(stderr, "Could not build the index\n");
+        return EXIT_FAILURE;
+    }
+    int mismatches = 0;
+    for (int k = 0; k <= RANDOM_OPS; k++) mismatches += prefixTotal(&px, k) != running[k];
+    printf("Random stream: %s (%d prefixes, index %.1f%% of records)\n", mismatches ? "FAILED" : "OK",
+           RANDOM_OPS + 1, 100.0 * prefixIndexBytes(&px) / (RANDOM_OPS * sizeof(int)));
+    failed |= mismatches != 0;
+    prefixIndexDestroy(&px);
+
+    if (failed) {
+        fprintf(stderr, "Prefix totals do not match calPoints!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <pthread.h>
 #include <immintrin.h>
 #include <sys/time.h>
@@ -21,17 +22,23 @@ typedef struct {
 void *simdSum(void *arg) {
     ThreadData *data = (ThreadData *)arg;
     __m256i sumVec = _mm256_setzero_si256();
-    int i;
+    int i = data->start;
+    int peel = 0;
 
-    for (i = data->start; i + 7 < data->end; i += 8) {
+    // Peel to a 32-byte boundary: the aligned loads below are only valid there
+    for (; i < data->end && ((uintptr_t)&data->records[i] & 31) != 0; i++) {
+        peel += data->records[i];
+    }
+
+    for (; i + 7 < data->end; i += 8) {
         __m256i values = _mm256_load_si256((__m256i*)&data->records[i]); // Aligned load
         sumVec = _mm256_add_epi32(sumVec, values);
     }
 
-    int sumArray[8];
+    int sumArray[8] __attribute__((aligned(32)));
     _mm256_store_si256((__m256i*)sumArray, sumVec);
 
-    int sum = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+    int sum = peel + sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
               sumArray[4] + sumArray[5] + sumArray[6] + sumArray[7];
 
     for (; i < data->end; i++) {